@@ -11,11 +11,20 @@
 #if PLT_WIN
 #include <intrin.h>
 #include <windows.h>
+#include <psapi.h>
+#pragma comment(lib, "psapi")
 #elif PLT_LINUX
 #include <x86intrin.h>
-#include <sys/time.h>
+#include <cpuid.h>
+#include <time.h>
+#include <sys/resource.h>
 #endif
 
+/* NOTE(abid): Calibrated TSC frequencies are kept here between runs, keyed by the boot id since
+ * the TSC (and its rate) only changes across reboots. */
+#define CPU_TIMER_FREQ_CACHE "/tmp/haversine_tsc_freq"
+#define CPU_TIMER_CALIBRATION_MS 100
+
 internal u64
 platform_get_os_timer_freq() {
 #if PLT_WIN
@@ -23,10 +32,12 @@ platform_get_os_timer_freq() {
     QueryPerformanceFrequency(&freq);
     return freq.QuadPart;
 #elif PLT_LINUX
-    return 1000000;
+    return 1000000000;
 #endif
 }
 
+/* NOTE(abid): Nanoseconds on Linux. MONOTONIC_RAW is not slewed by NTP, so it is the clock to
+ * calibrate against. */
 internal u64
 platform_get_os_timer() {
 #if PLT_WIN
@@ -34,9 +45,9 @@ platform_get_os_timer() {
     QueryPerformanceCounter(&timer);
     return timer.QuadPart;
 #elif PLT_LINUX
-    struct timeval timer;
-    gettimejofday(&timer, 0);
-    return platform_get_os_timer_freq() * (u64)timer.tv_sec + (u64)timer.tv_usec;
+    struct timespec timer;
+    clock_gettime(CLOCK_MONOTONIC_RAW, &timer);
+    return platform_get_os_timer_freq() * (u64)timer.tv_sec + (u64)timer.tv_nsec;
 #endif
 }
 
@@ -45,10 +56,128 @@ platform_get_cpu_timer() {
     return __rdtsc();
 }
 
+/* NOTE(abid): Keeps the compiler from moving memory accesses across it (the fences below only
+ * order the CPU). */
+#if PLT_WIN
+#define compiler_barrier() _ReadWriteBarrier()
+#elif PLT_LINUX
+#define compiler_barrier() __asm__ __volatile__("" ::: "memory")
+#endif
+
+/* NOTE(abid): Serialized timestamps for short intervals. The begin stamp waits for everything
+ * before it to finish and keeps later loads from starting early, the end stamp (rdtscp) waits
+ * for the measured code to finish and the fence keeps what follows out. */
+internal inline u64
+platform_get_cpu_timer_begin() {
+    compiler_barrier();
+    _mm_lfence();
+    u64 result = __rdtsc();
+    _mm_lfence();
+    compiler_barrier();
+
+    return result;
+}
+
+internal inline u64
+platform_get_cpu_timer_end() {
+    u32 aux;
+    compiler_barrier();
+    u64 result = __rdtscp(&aux);
+    _mm_lfence();
+    compiler_barrier();
+
+    return result;
+}
+
+internal void
+platform_cpuid(u32 leaf, u32 subleaf, u32 *regs) {
+#if PLT_WIN
+    __cpuidex((int *)regs, (int)leaf, (int)subleaf);
+#elif PLT_LINUX
+    __cpuid_count(leaf, subleaf, regs[0], regs[1], regs[2], regs[3]);
+#endif
+}
+
+/* NOTE(abid): The 48 character brand string, `brand` holds at least 49 bytes. */
+internal void
+platform_cpu_brand(char *brand) {
+    u32 regs[4];
+    brand[0] = 0;
+    platform_cpuid(0x80000000, 0, regs);
+    if(regs[0] < 0x80000004) return;
+
+    for(u32 leaf = 0; leaf < 3; ++leaf) platform_cpuid(0x80000002 + leaf, 0, (u32 *)brand + 4*leaf);
+    brand[48] = 0;
+}
+
+/* NOTE(abid): Data cache sizes in bytes, `sizes[0]` = L1d up to `sizes[2]` = L3, 0 for a level the
+ * CPU does not report. Intel describes them in leaf 4, AMD in 0x8000001D, same layout. */
+#define CPU_CACHE_LEVELS 3
+internal void
+platform_cache_sizes(u64 *sizes) {
+    for(u32 level = 0; level < CPU_CACHE_LEVELS; ++level) sizes[level] = 0;
+
+    u32 regs[4];
+    platform_cpuid(0, 0, regs);
+    u32 leaf = 4;
+    if(regs[0] < 4) {
+        platform_cpuid(0x80000000, 0, regs);
+        if(regs[0] < 0x8000001D) return;
+        leaf = 0x8000001D;
+    }
+
+    for(u32 subleaf = 0; subleaf < 16; ++subleaf) {
+        platform_cpuid(leaf, subleaf, regs);
+        u32 type = regs[0] & 0x1F; /* NOTE(abid): 0 = no more caches, 1 = data, 2 = instruction, 3 = unified. */
+        if(type == 0) break;
+        if(type == 2) continue;
+
+        u32 level = (regs[0] >> 5) & 0x7;
+        u64 ways = ((regs[1] >> 22) & 0x3FF) + 1;
+        u64 partitions = ((regs[1] >> 12) & 0x3FF) + 1;
+        u64 line_size = (regs[1] & 0xFFF) + 1;
+        u64 sets = (u64)regs[2] + 1;
+        if(level >= 1 && level <= CPU_CACHE_LEVELS) sizes[level - 1] = ways*partitions*line_size*sets;
+    }
+}
+
+/* NOTE(abid): Invariant TSC ticks at a constant rate through frequency and power states, without
+ * it cycles do not convert to time. */
+internal bool
+platform_cpu_timer_is_invariant() {
+    u32 regs[4];
+    platform_cpuid(0x80000000, 0, regs);
+    if(regs[0] < 0x80000007) return false;
+    platform_cpuid(0x80000007, 0, regs);
+
+    return (regs[3] >> 8) & 1;
+}
+
+/* NOTE(abid): TSC frequency straight from the CPU, 0 when it does not say. Leaf 0x15 gives the
+ * TSC/crystal ratio and (mostly) the crystal, leaf 0x16 the base frequency which the TSC runs at
+ * on parts that leave the crystal out. */
 internal u64
-platform_get_cpu_timer_freq_estimate(u64 ms_to_wait) {
-    if(ms_to_wait == 0) ms_to_wait = 100;
+platform_cpu_timer_freq_from_cpuid() {
+    u32 regs[4];
+    platform_cpuid(0, 0, regs);
+    u32 max_leaf = regs[0];
+    if(max_leaf < 0x15) return 0;
 
+    platform_cpuid(0x15, 0, regs);
+    u64 denominator = regs[0], numerator = regs[1], crystal_hz = regs[2];
+    if(denominator && numerator && crystal_hz) return crystal_hz*numerator/denominator;
+
+    if(max_leaf >= 0x16) {
+        platform_cpuid(0x16, 0, regs);
+        u64 base_mhz = regs[0] & 0xFFFF;
+        if(base_mhz) return base_mhz*1000000;
+    }
+
+    return 0;
+}
+
+internal u64
+platform_cpu_timer_calibrate(u64 ms_to_wait) {
     u64 os_freq = platform_get_os_timer_freq();
 
     u64 os_start = platform_get_os_timer();
@@ -66,10 +195,86 @@ platform_get_cpu_timer_freq_estimate(u64 ms_to_wait) {
     u64 cpu_elapsed = cpu_end - cpu_start;
 
     u64 cpu_freq = 0;
-    if(os_elapsed) cpu_freq = cpu_elapsed * os_freq / os_elapsed;
+    if(os_elapsed) cpu_freq = (u64)((f64)cpu_elapsed*(f64)os_freq/(f64)os_elapsed);
 
     return cpu_freq;
 }
 
+#if PLT_LINUX
+/* NOTE(abid): The cached frequency if it was calibrated during this boot, 0 otherwise. */
+internal u64
+platform_cpu_timer_freq_cache_load(char *boot_id) {
+    u64 result = 0;
+    FILE *file = fopen(CPU_TIMER_FREQ_CACHE, "r");
+    if(file) {
+        char cached_boot_id[64];
+        unsigned long long freq;
+        if(fscanf(file, "%63s %llu", cached_boot_id, &freq) == 2 && strcmp(cached_boot_id, boot_id) == 0) {
+            result = freq;
+        }
+        fclose(file);
+    }
+
+    return result;
+}
+
+internal bool
+platform_boot_id(char *boot_id, usize size) {
+    FILE *file = fopen("/proc/sys/kernel/random/boot_id", "r");
+    if(!file) return false;
+    bool result = fgets(boot_id, (i32)size, file) != NULL;
+    fclose(file);
+    if(result) boot_id[strcspn(boot_id, "\n")] = 0;
+
+    return result && boot_id[0];
+}
+#endif
+
+/* NOTE(abid): `ms_to_wait` = 0 takes the fastest trustworthy source: the value from earlier in
+ * this run, CPUID, the per-boot cache, and only then a calibration against the OS clock (which
+ * is cached for the next runs). A non-zero `ms_to_wait` always calibrates for that long. */
+internal u64
+platform_get_cpu_timer_freq_estimate(u64 ms_to_wait) {
+    if(ms_to_wait) return platform_cpu_timer_calibrate(ms_to_wait);
+
+    local_persist u64 cpu_freq = 0;
+    if(cpu_freq) return cpu_freq;
+
+    bool invariant = platform_cpu_timer_is_invariant();
+    if(!invariant) printf("Warning: the TSC is not invariant, cycle to time conversions are approximate.\n");
+    if(invariant) cpu_freq = platform_cpu_timer_freq_from_cpuid();
+#if PLT_LINUX
+    char boot_id[64];
+    bool cacheable = invariant && platform_boot_id(boot_id, sizeof(boot_id));
+    if(!cpu_freq && cacheable) cpu_freq = platform_cpu_timer_freq_cache_load(boot_id);
+    if(!cpu_freq) {
+        cpu_freq = platform_cpu_timer_calibrate(CPU_TIMER_CALIBRATION_MS);
+        FILE *file = cacheable ? fopen(CPU_TIMER_FREQ_CACHE, "w") : NULL;
+        if(file) {
+            fprintf(file, "%s %llu\n", boot_id, (unsigned long long)cpu_freq);
+            fclose(file);
+        }
+    }
+#else
+    if(!cpu_freq) cpu_freq = platform_cpu_timer_calibrate(CPU_TIMER_CALIBRATION_MS);
+#endif
+
+    return cpu_freq;
+}
+
+/* NOTE(abid): Page faults of the whole process so far, minor and major. */
+internal u64
+platform_page_fault_count() {
+#if PLT_WIN
+    PROCESS_MEMORY_COUNTERS counters = { .cb = sizeof(counters) };
+    GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters));
+    return counters.PageFaultCount;
+#elif PLT_LINUX
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return (u64)usage.ru_minflt + (u64)usage.ru_majflt;
+#endif
+}
+
 #define BENCH_H
 #endif
@@ -0,0 +1,323 @@
+/*  +======| File Info |===============================================================+
+    |                                                                                  |
+    |     Subdirectory:  /src                                                          |
+    |    Creation date:  10/19/2026 10:26:40 PM                                        |
+    |    Last Modified:                                                                |
+    |                                                                                  |
+    +======================================| Copyright © Sayed Abid Hashimi |==========+  */
+
+#include "block_codec.h"
+
+/* NOTE(abid): Worst case LZ output, every byte a literal plus the run length bytes. */
+inline internal usize
+block_codec_bound(usize raw_size) { return raw_size + raw_size/255 + 16; }
+
+internal u64
+block_codec_checksum(u8 *data, usize size) {
+    u64 hash = BLOCK_CODEC_CHECKSUM_SEED ^ size;
+    usize idx = 0;
+    for(; idx + sizeof(u64) <= size; idx += sizeof(u64)) {
+        u64 word;
+        memcpy(&word, data + idx, sizeof(u64));
+        hash = ((hash ^ word)*0xFF51AFD7ED558CCDULL);
+        hash ^= hash >> 32;
+    }
+    for(; idx < size; ++idx) hash = (hash ^ data[idx])*0xC4CEB9FE1A85EC53ULL;
+
+    return rand_mix64(hash);
+}
+
+/* NOTE(abid): XOR delta followed by the byte shuffle, `dest` gets the planes, the trailing
+ * raw_size % 8 bytes are copied through. */
+internal void
+block_codec_shuffle(u8 *dest, u8 *src, usize raw_size) {
+    usize word_count = raw_size / sizeof(u64);
+    u64 previous = 0;
+    for(usize idx = 0; idx < word_count; ++idx) {
+        u64 word;
+        memcpy(&word, src + idx*sizeof(u64), sizeof(u64));
+        u64 delta = word ^ previous;
+        previous = word;
+        for(u32 byte = 0; byte < sizeof(u64); ++byte) dest[byte*word_count + idx] = (u8)(delta >> (8*byte));
+    }
+    memcpy(dest + word_count*sizeof(u64), src + word_count*sizeof(u64), raw_size - word_count*sizeof(u64));
+}
+
+internal void
+block_codec_unshuffle(u8 *dest, u8 *src, usize raw_size) {
+    usize word_count = raw_size / sizeof(u64);
+    u64 previous = 0;
+    for(usize idx = 0; idx < word_count; ++idx) {
+        u64 delta = 0;
+        for(u32 byte = 0; byte < sizeof(u64); ++byte) delta |= (u64)src[byte*word_count + idx] << (8*byte);
+        previous ^= delta;
+        memcpy(dest + idx*sizeof(u64), &previous, sizeof(u64));
+    }
+    memcpy(dest + word_count*sizeof(u64), src + word_count*sizeof(u64), raw_size - word_count*sizeof(u64));
+}
+
+inline internal u8 *
+block_codec_put_length(u8 *out, usize length) {
+    for(; length >= 255; length -= 255) *out++ = 255;
+    *out++ = (u8)length;
+
+    return out;
+}
+
+/* NOTE(abid): A sequence is a token (literal length in the high nibble, match length - 4 in the
+ * low one, 15 = more length bytes follow), the literals, a little-endian u16 offset and the extra
+ * match length bytes. The last sequence ends after its literals. Returns the coded size. */
+internal usize
+block_codec_lz_encode(u8 *out, u8 *in, usize size) {
+    u32 hash_table[1 << BLOCK_CODEC_LZ_HASH_BITS];
+    memset(hash_table, 0xFF, sizeof(hash_table));
+
+    u8 *out_start = out;
+    usize literal_start = 0;
+    usize pos = 0;
+    while(pos + BLOCK_CODEC_LZ_MIN_MATCH <= size) {
+        u32 sequence;
+        memcpy(&sequence, in + pos, sizeof(u32));
+        u32 hash = (sequence*2654435761U) >> (32 - BLOCK_CODEC_LZ_HASH_BITS);
+        u32 candidate = hash_table[hash];
+        hash_table[hash] = (u32)pos;
+
+        u32 candidate_sequence;
+        if(candidate == 0xFFFFFFFF || pos - candidate > BLOCK_CODEC_LZ_MAX_OFFSET ||
+           (memcpy(&candidate_sequence, in + candidate, sizeof(u32)), candidate_sequence != sequence)) {
+            ++pos;
+            continue;
+        }
+
+        usize match_len = BLOCK_CODEC_LZ_MIN_MATCH;
+        while(pos + match_len < size && in[candidate + match_len] == in[pos + match_len]) ++match_len;
+
+        usize literal_len = pos - literal_start;
+        usize extra_match = match_len - BLOCK_CODEC_LZ_MIN_MATCH;
+        *out++ = (u8)(((literal_len < 15 ? literal_len : 15) << 4) | (extra_match < 15 ? extra_match : 15));
+        if(literal_len >= 15) out = block_codec_put_length(out, literal_len - 15);
+        memcpy(out, in + literal_start, literal_len);
+        out += literal_len;
+        u32 offset = (u32)(pos - candidate);
+        *out++ = (u8)offset;
+        *out++ = (u8)(offset >> 8);
+        if(extra_match >= 15) out = block_codec_put_length(out, extra_match - 15);
+
+        pos += match_len;
+        literal_start = pos;
+    }
+
+    usize literal_len = size - literal_start;
+    *out++ = (u8)((literal_len < 15 ? literal_len : 15) << 4);
+    if(literal_len >= 15) out = block_codec_put_length(out, literal_len - 15);
+    memcpy(out, in + literal_start, literal_len);
+    out += literal_len;
+
+    return (usize)(out - out_start);
+}
+
+inline internal bool
+block_codec_get_length(u8 **in, u8 *in_end, usize *length) {
+    u8 byte;
+    do {
+        if(*in >= in_end) return false;
+        byte = *(*in)++;
+        *length += byte;
+    } while(byte == 255);
+
+    return true;
+}
+
+/* NOTE(abid): Every length and offset is checked against both buffers, a corrupted block fails
+ * instead of writing out of bounds. Succeeds only if exactly `out_size` bytes come out. */
+internal bool
+block_codec_lz_decode(u8 *out, usize out_size, u8 *in, usize in_size) {
+    u8 *in_end = in + in_size;
+    usize pos = 0;
+    while(in < in_end) {
+        u8 token = *in++;
+        usize literal_len = token >> 4;
+        if(literal_len == 15 && !block_codec_get_length(&in, in_end, &literal_len)) return false;
+        if(literal_len > (usize)(in_end - in) || literal_len > out_size - pos) return false;
+        memcpy(out + pos, in, literal_len);
+        in += literal_len;
+        pos += literal_len;
+        if(in == in_end) break;
+
+        if(in_end - in < 2) return false;
+        usize offset = (usize)in[0] | ((usize)in[1] << 8);
+        in += 2;
+        usize match_len = token & 0xF;
+        if(match_len == 15 && !block_codec_get_length(&in, in_end, &match_len)) return false;
+        match_len += BLOCK_CODEC_LZ_MIN_MATCH;
+        if(offset == 0 || offset > pos || match_len > out_size - pos) return false;
+
+        u8 *match = out + pos - offset;
+        if(offset >= match_len) memcpy(out + pos, match, match_len);
+        else for(usize idx = 0; idx < match_len; ++idx) out[pos + idx] = match[idx];
+        pos += match_len;
+    }
+
+    return pos == out_size;
+}
+
+internal THREAD_PROC(block_codec_worker) {
+    block_codec_job *job = (block_codec_job *)param;
+    u8 *scratch = malloc(BLOCK_CODEC_BLOCK_SIZE);
+
+    while(true) {
+        u64 block = platform_atomic_add_u64(&job->next_block, 1);
+        if(block >= job->block_count) break;
+
+        u64 raw_offset = block*BLOCK_CODEC_BLOCK_SIZE;
+        usize raw_size = BLOCK_CODEC_BLOCK_SIZE;
+        if(raw_offset + raw_size > job->raw_size) raw_size = job->raw_size - raw_offset;
+        block_codec_entry *entry = job->entries + block;
+        u8 *raw = job->raw + raw_offset;
+
+        if(job->decode) {
+            bool decoded = false;
+            if(entry->offset + entry->stored_size <= job->stored_size) {
+                u8 *stored = job->stored_base + entry->offset;
+                if(entry->flags == BLOCK_CODEC_FLAG_RAW) {
+                    decoded = entry->stored_size == raw_size;
+                    if(decoded) memcpy(raw, stored, raw_size);
+                } else if(entry->flags == BLOCK_CODEC_FLAG_LZ) {
+                    decoded = block_codec_lz_decode(scratch, raw_size, stored, entry->stored_size);
+                    if(decoded) block_codec_unshuffle(raw, scratch, raw_size);
+                }
+                decoded = decoded && block_codec_checksum(raw, raw_size) == entry->checksum;
+            }
+            if(!decoded) platform_atomic_add_u64(&job->failed_blocks, 1);
+        } else {
+            u8 *stored = job->stored_blocks[block];
+            entry->checksum = block_codec_checksum(raw, raw_size);
+            block_codec_shuffle(scratch, raw, raw_size);
+            usize stored_size = block_codec_lz_encode(stored, scratch, raw_size);
+            entry->flags = BLOCK_CODEC_FLAG_LZ;
+            if(stored_size >= raw_size) {
+                memcpy(stored, raw, raw_size);
+                stored_size = raw_size;
+                entry->flags = BLOCK_CODEC_FLAG_RAW;
+            }
+            entry->stored_size = (u32)stored_size;
+        }
+    }
+
+    free(scratch);
+    return 0;
+}
+
+internal void
+block_codec_run(block_codec_job *job, u32 thread_count) {
+    if(thread_count == 0) thread_count = platform_cpu_count();
+    if(thread_count > job->block_count) thread_count = job->block_count ? (u32)job->block_count : 1;
+    job->next_block = 0;
+    job->failed_blocks = 0;
+
+    /* NOTE(abid): The calling thread is worker zero. */
+    u32 extra_threads = thread_count - 1;
+    platform_thread *threads = malloc(sizeof(platform_thread)*(extra_threads + 1));
+    for(u32 idx = 0; idx < extra_threads; ++idx) threads[idx] = platform_thread_create(block_codec_worker, job);
+    block_codec_worker(job);
+    for(u32 idx = 0; idx < extra_threads; ++idx) platform_thread_join(threads[idx]);
+
+    free(threads);
+}
+
+/* NOTE(abid): Compresses `src_filename` into `dest_filename`, blocks are coded in parallel and
+ * written in order after the header and block index. Returns the compressed file size. */
+internal u64
+block_codec_compress_file(char *src_filename, char *dest_filename, u32 thread_count) {
+    usize raw_size = 0;
+    u8 *raw = platform_file_map(src_filename, &raw_size);
+    assert(raw || raw_size == 0, "cannot read %s.", src_filename);
+
+    block_codec_job job = {0};
+    job.raw = raw;
+    job.raw_size = raw_size;
+    job.block_count = (raw_size + BLOCK_CODEC_BLOCK_SIZE - 1) / BLOCK_CODEC_BLOCK_SIZE;
+    job.entries = calloc(job.block_count + 1, sizeof(block_codec_entry));
+    job.stored_blocks = malloc((job.block_count + 1)*sizeof(u8 *));
+    for(u64 block = 0; block < job.block_count; ++block) {
+        job.stored_blocks[block] = malloc(block_codec_bound(BLOCK_CODEC_BLOCK_SIZE));
+    }
+    block_codec_run(&job, thread_count);
+
+    block_codec_header header = {
+        .magic = BLOCK_CODEC_MAGIC,
+        .version = BLOCK_CODEC_VERSION,
+        .block_size = BLOCK_CODEC_BLOCK_SIZE,
+        .raw_size = raw_size,
+        .block_count = job.block_count,
+    };
+    u64 offset = sizeof(block_codec_header) + job.block_count*sizeof(block_codec_entry);
+    for(u64 block = 0; block < job.block_count; ++block) {
+        job.entries[block].offset = offset;
+        offset += job.entries[block].stored_size;
+    }
+
+    platform_file file = platform_file_open_write(dest_filename, /*unbuffered =*/false, NULL);
+    assert(file != PLATFORM_FILE_INVALID, "cannot open %s for writing.", dest_filename);
+    bool written = platform_file_write_at(file, &header, sizeof(header), 0) &&
+                   platform_file_write_at(file, job.entries, job.block_count*sizeof(block_codec_entry),
+                                          sizeof(header));
+    for(u64 block = 0; written && block < job.block_count; ++block) {
+        written = platform_file_write_at(file, job.stored_blocks[block], job.entries[block].stored_size,
+                                         job.entries[block].offset);
+    }
+    assert(written, "cannot write %s.", dest_filename);
+    platform_file_close(file);
+
+    for(u64 block = 0; block < job.block_count; ++block) free(job.stored_blocks[block]);
+    free(job.stored_blocks);
+    free(job.entries);
+    if(raw) platform_file_unmap(raw, raw_size);
+
+    return offset;
+}
+
+/* NOTE(abid): Maps a compressed file and decodes every block in parallel straight into a page
+ * aligned buffer (release it with `platform_free(result, *size_out)`). Returns NULL, with nothing
+ * allocated, if the file is missing or any block fails to decode. */
+internal u8 *
+block_codec_decompress_file(char *filename, u32 thread_count, usize *size_out) {
+    *size_out = 0;
+    usize stored_size = 0;
+    u8 *stored = platform_file_map(filename, &stored_size);
+    if(stored == NULL) return NULL;
+
+    block_codec_header *header = (block_codec_header *)stored;
+    u64 expected_blocks = 0;
+    if(stored_size >= sizeof(block_codec_header)) {
+        expected_blocks = (header->raw_size + BLOCK_CODEC_BLOCK_SIZE - 1) / BLOCK_CODEC_BLOCK_SIZE;
+    }
+    if(stored_size < sizeof(block_codec_header) || header->magic != BLOCK_CODEC_MAGIC ||
+       header->version != BLOCK_CODEC_VERSION || header->block_size != BLOCK_CODEC_BLOCK_SIZE ||
+       header->block_count != expected_blocks ||
+       (stored_size - sizeof(block_codec_header))/sizeof(block_codec_entry) < header->block_count) {
+        printf("%s: bad header\n", filename);
+        platform_file_unmap(stored, stored_size);
+        return NULL;
+    }
+
+    block_codec_job job = {0};
+    job.decode = true;
+    job.raw_size = header->raw_size;
+    job.raw = header->raw_size ? platform_allocate(header->raw_size) : NULL;
+    job.block_count = header->block_count;
+    job.entries = (block_codec_entry *)(stored + sizeof(block_codec_header));
+    job.stored_base = stored;
+    job.stored_size = stored_size;
+    block_codec_run(&job, thread_count);
+    platform_file_unmap(stored, stored_size);
+
+    if(job.failed_blocks) {
+        printf("%s: %llu corrupted blocks\n", filename, job.failed_blocks);
+        if(job.raw) platform_free(job.raw, job.raw_size);
+        return NULL;
+    }
+
+    *size_out = job.raw_size;
+    return job.raw;
+}
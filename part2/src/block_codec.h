@@ -0,0 +1,68 @@
+/*  +======| File Info |===============================================================+
+    |                                                                                  |
+    |     Subdirectory:  /src                                                          |
+    |    Creation date:  10/19/2026 10:26:40 PM                                        |
+    |    Last Modified:                                                                |
+    |                                                                                  |
+    +======================================| Copyright © Sayed Abid Hashimi |==========+  */
+
+#if !defined(BLOCK_CODEC_H)
+
+/* NOTE(abid): Block compressed container (.hvz) for the binary files (.f64 answers, .pairs).
+ * The raw file is cut into BLOCK_CODEC_BLOCK_SIZE blocks that are coded independently, so they
+ * decode in parallel and straight into their place in the output. Per block:
+ * - XOR delta: every u64 word is XORed with the previous one, neighbouring doubles of similar
+ *   magnitude share sign/exponent/top mantissa bits, which turns those into zero bytes.
+ * - Byte shuffle: byte b of every word goes to plane b, so the (now mostly zero) high bytes sit
+ *   next to each other instead of every 8th byte.
+ * - LZ: byte oriented LZ77 (LZ4 style sequences, 16-bit offsets), no entropy stage.
+ * A block that does not get smaller is stored as is. A trailing partial word is not transformed. */
+#define BLOCK_CODEC_MAGIC 0x4B434F4C42564148ULL /* NOTE(abid): "HAVBLOCK" */
+#define BLOCK_CODEC_VERSION 1
+#define BLOCK_CODEC_CHECKSUM_SEED 0x9E3779B97F4A7C15ULL
+#define BLOCK_CODEC_BLOCK_SIZE kilobyte(256)
+
+#define BLOCK_CODEC_LZ_MIN_MATCH 4
+#define BLOCK_CODEC_LZ_MAX_OFFSET 65535
+#define BLOCK_CODEC_LZ_HASH_BITS 14
+
+/* NOTE(abid): Stored block flags. */
+#define BLOCK_CODEC_FLAG_RAW 0
+#define BLOCK_CODEC_FLAG_LZ  1
+
+typedef struct {
+    u64 magic;
+    u32 version;
+    u32 block_size;
+    u64 raw_size;
+    u64 block_count;
+} block_codec_header;
+
+/* NOTE(abid): Follows the header, one per block, offsets are from the start of the file. The
+ * checksum covers the raw block, a block is only accepted if it decodes back to it. */
+typedef struct {
+    u64 offset;
+    u32 stored_size;
+    u32 flags;
+    u64 checksum;
+} block_codec_entry;
+
+typedef struct {
+    bool decode;
+    u8 *raw;
+    u64 raw_size;
+    u64 block_count;
+    block_codec_entry *entries;
+
+    /* NOTE(abid): Encode writes block i to stored_blocks[i] (worst case sized), decode reads it
+     * from `stored_base` + entry offset. */
+    u8 **stored_blocks;
+    u8 *stored_base;
+    u64 stored_size;
+
+    volatile u64 next_block;
+    volatile u64 failed_blocks;
+} block_codec_job;
+
+#define BLOCK_CODEC_H
+#endif
@@ -0,0 +1,160 @@
+/*  +======| File Info |===============================================================+
+    |                                                                                  |
+    |     Subdirectory:  /src                                                          |
+    |    Creation date:  10/19/2026 3:03:12 PM                                         |
+    |    Last Modified:                                                                |
+    |                                                                                  |
+    +======================================| Copyright © Sayed Abid Hashimi |==========+  */
+
+#include "distance_formulas.h"
+
+/* NOTE(abid): All lane kernels take degrees and share the signature of `haversine_lane_f64`. */
+internal inline lane_f64
+equirectangular_lane_f64(lane_f64 x0, lane_f64 y0, lane_f64 x1, lane_f64 y1, lane_f64 earth_radius) {
+    lane_f64 to_radians = lane_f64_set1(DEGREES_TO_RADIANS);
+    lane_f64 dlon = lane_f64_mul(lane_f64_sub(x1, x0), to_radians);
+    lane_f64 dlat = lane_f64_mul(lane_f64_sub(y1, y0), to_radians);
+
+    /* NOTE(abid): Wrap the longitude difference into [-pi, pi] so pairs across the antimeridian
+     * do not go the long way around. */
+    lane_f64 magic = lane_f64_set1(F64_ROUND_MAGIC);
+    lane_f64 turns = lane_f64_sub(lane_f64_fmadd(dlon, lane_f64_set1(0.5*F64_INV_PI), magic), magic);
+    dlon = lane_f64_fmadd(turns, lane_f64_set1(-4.0*F64_HALF_PI), dlon);
+
+    lane_f64 mean_lat = lane_f64_mul(lane_f64_add(y0, y1), lane_f64_set1(0.5*DEGREES_TO_RADIANS));
+    lane_f64 x = lane_f64_mul(dlon, lane_f64_cos(mean_lat));
+    return lane_f64_mul(earth_radius, lane_f64_sqrt(lane_f64_fmadd(x, x, lane_f64_mul(dlat, dlat))));
+}
+
+internal inline lane_f64
+law_of_cosines_lane_f64(lane_f64 x0, lane_f64 y0, lane_f64 x1, lane_f64 y1, lane_f64 earth_radius) {
+    lane_f64 to_radians = lane_f64_set1(DEGREES_TO_RADIANS);
+    lane_f64 lat1 = lane_f64_mul(y0, to_radians);
+    lane_f64 lat2 = lane_f64_mul(y1, to_radians);
+    lane_f64 dlon = lane_f64_mul(lane_f64_sub(x1, x0), to_radians);
+
+    lane_f64 cos_c = lane_f64_fmadd(lane_f64_mul(lane_f64_cos(lat1), lane_f64_cos(lat2)), lane_f64_cos(dlon),
+                                    lane_f64_mul(lane_f64_sin(lat1), lane_f64_sin(lat2)));
+    cos_c = lane_f64_max(lane_f64_min(cos_c, lane_f64_set1(1.0)), lane_f64_set1(-1.0));
+    return lane_f64_mul(earth_radius, lane_f64_acos(cos_c));
+}
+
+/* NOTE(abid): Vincenty's inverse formula on the WGS84 ellipsoid. All lanes iterate together until
+ * every lane has converged (1e-12 rad on lambda) or we hit VINCENTY_MAX_ITERATIONS, extra rounds on
+ * a converged lane are harmless since it sits at the fixed point. Nearly antipodal pairs can fail
+ * to converge at all, those lanes fall back to haversine on the mean radius (2a + b)/3.
+ * `earth_radius` is unused, the ellipsoid defines its own size. */
+internal inline lane_f64
+vincenty_lane_f64(lane_f64 x0, lane_f64 y0, lane_f64 x1, lane_f64 y1, lane_f64 earth_radius) {
+    f64 a = WGS84_SEMI_MAJOR_KM;
+    f64 f = WGS84_FLATTENING;
+    f64 b = a*(1.0 - f);
+    lane_f64 one = lane_f64_set1(1.0);
+    lane_f64 zero = lane_f64_zero();
+    lane_f64 tiny = lane_f64_set1(1e-300);
+    lane_f64 to_radians = lane_f64_set1(DEGREES_TO_RADIANS);
+
+    /* NOTE(abid): Reduced latitudes, tan(U) = (1 - f)*tan(lat) written without the tan so the
+     * poles do not divide by zero. */
+    lane_f64 lat1 = lane_f64_mul(y0, to_radians);
+    lane_f64 lat2 = lane_f64_mul(y1, to_radians);
+    lane_f64 one_minus_f = lane_f64_set1(1.0 - f);
+    lane_f64 sin_lat1 = lane_f64_mul(one_minus_f, lane_f64_sin(lat1));
+    lane_f64 cos_lat1 = lane_f64_cos(lat1);
+    lane_f64 sin_lat2 = lane_f64_mul(one_minus_f, lane_f64_sin(lat2));
+    lane_f64 cos_lat2 = lane_f64_cos(lat2);
+    lane_f64 norm1 = lane_f64_div(one, lane_f64_sqrt(lane_f64_fmadd(sin_lat1, sin_lat1, lane_f64_mul(cos_lat1, cos_lat1))));
+    lane_f64 norm2 = lane_f64_div(one, lane_f64_sqrt(lane_f64_fmadd(sin_lat2, sin_lat2, lane_f64_mul(cos_lat2, cos_lat2))));
+    lane_f64 sin_u1 = lane_f64_mul(sin_lat1, norm1);
+    lane_f64 cos_u1 = lane_f64_mul(cos_lat1, norm1);
+    lane_f64 sin_u2 = lane_f64_mul(sin_lat2, norm2);
+    lane_f64 cos_u2 = lane_f64_mul(cos_lat2, norm2);
+    lane_f64 sin_u1_sin_u2 = lane_f64_mul(sin_u1, sin_u2);
+    lane_f64 cos_u1_cos_u2 = lane_f64_mul(cos_u1, cos_u2);
+
+    lane_f64 big_l = lane_f64_mul(lane_f64_sub(x1, x0), to_radians);
+    lane_f64 lambda = big_l;
+    lane_f64 sin_sigma = zero, cos_sigma = zero, sigma = zero, cos2_alpha = zero, cos_2sigma_m = zero;
+    lane_f64 converged = zero;
+    for(u32 iteration = 0; iteration < VINCENTY_MAX_ITERATIONS; ++iteration) {
+        lane_f64 sin_lambda = lane_f64_sin(lambda);
+        lane_f64 cos_lambda = lane_f64_cos(lambda);
+        lane_f64 t1 = lane_f64_mul(cos_u2, sin_lambda);
+        lane_f64 t2 = lane_f64_sub(lane_f64_mul(cos_u1, sin_u2), lane_f64_mul(lane_f64_mul(sin_u1, cos_u2), cos_lambda));
+        sin_sigma = lane_f64_sqrt(lane_f64_fmadd(t1, t1, lane_f64_mul(t2, t2)));
+        cos_sigma = lane_f64_fmadd(cos_u1_cos_u2, cos_lambda, sin_u1_sin_u2);
+        sigma = lane_f64_atan2(sin_sigma, cos_sigma);
+
+        /* NOTE(abid): Coincident points have sin_sigma == 0, equatorial lines cos2_alpha == 0. */
+        lane_f64 sin_alpha = lane_f64_div(lane_f64_mul(cos_u1_cos_u2, sin_lambda), lane_f64_max(sin_sigma, tiny));
+        cos2_alpha = lane_f64_fmadd(lane_f64_set1(-1.0), lane_f64_mul(sin_alpha, sin_alpha), one);
+        lane_f64 has_alpha = lane_f64_gt(cos2_alpha, tiny);
+        cos_2sigma_m = lane_f64_sub(cos_sigma, lane_f64_div(lane_f64_add(sin_u1_sin_u2, sin_u1_sin_u2),
+                                                            lane_f64_max(cos2_alpha, tiny)));
+        cos_2sigma_m = lane_f64_and(has_alpha, cos_2sigma_m);
+
+        lane_f64 big_c = lane_f64_mul(lane_f64_mul(lane_f64_set1(f/16.0), cos2_alpha),
+                                      lane_f64_fmadd(lane_f64_set1(f), lane_f64_fmadd(lane_f64_set1(-3.0), cos2_alpha, lane_f64_set1(4.0)),
+                                                     lane_f64_set1(4.0)));
+        lane_f64 inner = lane_f64_fmadd(lane_f64_mul(big_c, cos_sigma),
+                                        lane_f64_fmadd(lane_f64_set1(2.0), lane_f64_mul(cos_2sigma_m, cos_2sigma_m), lane_f64_set1(-1.0)),
+                                        cos_2sigma_m);
+        lane_f64 lambda_next = lane_f64_fmadd(lane_f64_mul(lane_f64_mul(lane_f64_sub(one, big_c), lane_f64_set1(f)), sin_alpha),
+                                              lane_f64_fmadd(lane_f64_mul(big_c, sin_sigma), inner, sigma),
+                                              big_l);
+
+        converged = lane_f64_lt(lane_f64_abs(lane_f64_sub(lambda_next, lambda)), lane_f64_set1(1e-12));
+        lambda = lambda_next;
+        if(lane_f64_movemask(converged) == (1 << LANE_F64_WIDTH) - 1) break;
+    }
+
+    lane_f64 u2 = lane_f64_mul(cos2_alpha, lane_f64_set1((a*a - b*b)/(b*b)));
+    lane_f64 big_a = lane_f64_fmadd(lane_f64_mul(u2, lane_f64_set1(1.0/16384.0)),
+                                    lane_f64_fmadd(u2, lane_f64_fmadd(u2, lane_f64_fmadd(u2, lane_f64_set1(-175.0), lane_f64_set1(320.0)),
+                                                                      lane_f64_set1(-768.0)),
+                                                   lane_f64_set1(4096.0)),
+                                    one);
+    lane_f64 big_b = lane_f64_mul(lane_f64_mul(u2, lane_f64_set1(1.0/1024.0)),
+                                  lane_f64_fmadd(u2, lane_f64_fmadd(u2, lane_f64_fmadd(u2, lane_f64_set1(-47.0), lane_f64_set1(74.0)),
+                                                                    lane_f64_set1(-128.0)),
+                                                 lane_f64_set1(256.0)));
+    lane_f64 cos_2sigma_m_sq = lane_f64_mul(cos_2sigma_m, cos_2sigma_m);
+    lane_f64 term1 = lane_f64_mul(cos_sigma, lane_f64_fmadd(lane_f64_set1(2.0), cos_2sigma_m_sq, lane_f64_set1(-1.0)));
+    lane_f64 term2 = lane_f64_mul(lane_f64_mul(lane_f64_mul(big_b, lane_f64_set1(1.0/6.0)), cos_2sigma_m),
+                                  lane_f64_mul(lane_f64_fmadd(lane_f64_set1(4.0), lane_f64_mul(sin_sigma, sin_sigma), lane_f64_set1(-3.0)),
+                                               lane_f64_fmadd(lane_f64_set1(4.0), cos_2sigma_m_sq, lane_f64_set1(-3.0))));
+    lane_f64 delta_sigma = lane_f64_mul(lane_f64_mul(big_b, sin_sigma),
+                                        lane_f64_fmadd(lane_f64_mul(big_b, lane_f64_set1(0.25)), lane_f64_sub(term1, term2),
+                                                       cos_2sigma_m));
+    lane_f64 result = lane_f64_mul(lane_f64_mul(lane_f64_set1(b), big_a), lane_f64_sub(sigma, delta_sigma));
+
+    lane_f64 fallback = haversine_lane_f64(x0, y0, x1, y1, lane_f64_set1((2.0*a + b)/3.0));
+    return lane_f64_select(converged, result, fallback);
+}
+
+/* NOTE(abid): One batch interface for every formula, returns the sum and writes per-pair distances
+ * to `out` if it is not NULL (padded count, same as the haversine kernels). */
+#define DISTANCE_BATCH_LOOP(lane_kernel)                                                      \
+    for(u64 idx = 0; idx < padded_count; idx += LANE_F64_WIDTH) {                             \
+        lane_f64 distance = lane_kernel(lane_f64_load(pairs->x0 + idx), lane_f64_load(pairs->y0 + idx), \
+                                        lane_f64_load(pairs->x1 + idx), lane_f64_load(pairs->y1 + idx), \
+                                        radius);                                              \
+        sum = lane_f64_add(sum, distance);                                                    \
+        if(out) lane_f64_store(out + idx, distance);                                          \
+    }
+
+internal f64
+distance_sum_f64(distance_formula formula, pairs_f64 *pairs, f64 earth_radius, f64 *out) {
+    u64 padded_count = pairs_padded_count(pairs->count);
+    lane_f64 radius = lane_f64_set1(earth_radius);
+    lane_f64 sum = lane_f64_zero();
+    switch(formula) {
+#define X(value) case df_ ## value: { DISTANCE_BATCH_LOOP(value ## _lane_f64) } break;
+        DISTANCE_FORMULAS
+#undef X
+        default: assert(0, "invalid code path");
+    }
+
+    return lane_f64_hsum(sum);
+}
+#undef DISTANCE_BATCH_LOOP
@@ -0,0 +1,40 @@
+/*  +======| File Info |===============================================================+
+    |                                                                                  |
+    |     Subdirectory:  /src                                                          |
+    |    Creation date:  10/19/2026 3:02:55 PM                                         |
+    |    Last Modified:                                                                |
+    |                                                                                  |
+    +======================================| Copyright © Sayed Abid Hashimi |==========+  */
+
+#if !defined(DISTANCE_FORMULAS_H)
+
+/* NOTE(abid): Distance models, cheapest to most accurate:
+ * - equirectangular: flat projection at the mean latitude, fine for short distances only.
+ * - law_of_cosines:  spherical, one acos, ill-conditioned below a few km.
+ * - haversine:       spherical, well conditioned everywhere (the reference answers).
+ * - vincenty:        WGS84 ellipsoid, iterative, ignores the sphere radius. */
+#define DISTANCE_FORMULAS \
+    X(equirectangular)    \
+    X(law_of_cosines)     \
+    X(haversine)          \
+    X(vincenty)
+
+typedef enum {
+#define X(value) df_ ## value,
+    DISTANCE_FORMULAS
+#undef X
+    df_count
+} distance_formula;
+
+char *distance_formula_str[] = {
+#define X(value) #value,
+    DISTANCE_FORMULAS
+#undef X
+};
+
+#define WGS84_SEMI_MAJOR_KM 6378.137
+#define WGS84_FLATTENING (1.0/298.257223563)
+#define VINCENTY_MAX_ITERATIONS 20
+
+#define DISTANCE_FORMULAS_H
+#endif
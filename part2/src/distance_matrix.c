@@ -0,0 +1,204 @@
+/*  +======| File Info |===============================================================+
+    |                                                                                  |
+    |     Subdirectory:  /src                                                          |
+    |    Creation date:  10/19/2026 1:22:31 PM                                         |
+    |    Last Modified:                                                                |
+    |                                                                                  |
+    +======================================| Copyright © Sayed Abid Hashimi |==========+  */
+
+#include "distance_matrix.h"
+
+/* NOTE(abid): `lon` and `lat` are in degrees and must be readable up to the padded count (pair
+ * columns are). */
+internal point_set
+point_set_from_degrees(f64 *lon, f64 *lat, u64 count, mem_arena *arena) {
+    u64 padded_count = pairs_padded_count(count);
+    point_set result = { .count = count };
+    result.x = push_array_aligned(f64, padded_count, PAIRS_ALIGNMENT, arena);
+    result.y = push_array_aligned(f64, padded_count, PAIRS_ALIGNMENT, arena);
+    result.z = push_array_aligned(f64, padded_count, PAIRS_ALIGNMENT, arena);
+
+    lane_f64 to_radians = lane_f64_set1(DEGREES_TO_RADIANS);
+    for(u64 idx = 0; idx < padded_count; idx += LANE_F64_WIDTH) {
+        lane_f64 lat_radians = lane_f64_mul(lane_f64_load(lat + idx), to_radians);
+        lane_f64 lon_radians = lane_f64_mul(lane_f64_load(lon + idx), to_radians);
+        lane_f64 cos_lat = lane_f64_cos(lat_radians);
+        lane_f64_store(result.x + idx, lane_f64_mul(cos_lat, lane_f64_cos(lon_radians)));
+        lane_f64_store(result.y + idx, lane_f64_mul(cos_lat, lane_f64_sin(lon_radians)));
+        lane_f64_store(result.z + idx, lane_f64_sin(lat_radians));
+    }
+    for(u64 idx = count; idx < padded_count; ++idx) result.x[idx] = result.y[idx] = result.z[idx] = NAN;
+
+    return result;
+}
+
+inline internal f64
+distance_from_chord_squared(f64 chord_squared, f64 earth_radius) {
+    f64 half_chord = 0.5*sqrt(chord_squared);
+    if(half_chord > 1.0) half_chord = 1.0;
+    return 2.0*earth_radius*asin(half_chord);
+}
+
+/* NOTE(abid): Max-heap keyed on chord squared, the root is the current k-th nearest. The heap is
+ * pre-filled with INFINITY so we only ever replace the root. */
+internal void
+knn_heap_replace_top(f64 *heap_distance, u32 *heap_index, u32 k, f64 distance, u32 index) {
+    u32 parent = 0;
+    while(true) {
+        u32 child = 2*parent + 1;
+        if(child >= k) break;
+        if(child + 1 < k && heap_distance[child + 1] > heap_distance[child]) ++child;
+        if(heap_distance[child] <= distance) break;
+
+        heap_distance[parent] = heap_distance[child];
+        heap_index[parent] = heap_index[child];
+        parent = child;
+    }
+    heap_distance[parent] = distance;
+    heap_index[parent] = index;
+}
+
+/* NOTE(abid): Heap sort the row in place (ascending) and turn chord squared into distance. */
+internal void
+knn_row_finalize(f64 *heap_distance, u32 *heap_index, u32 k, f64 earth_radius) {
+    for(u32 heap_size = k; heap_size > 1; --heap_size) {
+        f64 top_distance = heap_distance[0];
+        u32 top_index = heap_index[0];
+        f64 last_distance = heap_distance[heap_size - 1];
+        u32 last_index = heap_index[heap_size - 1];
+
+        heap_distance[heap_size - 1] = top_distance;
+        heap_index[heap_size - 1] = top_index;
+        knn_heap_replace_top(heap_distance, heap_index, heap_size - 1, last_distance, last_index);
+    }
+
+    for(u32 idx = 0; idx < k; ++idx) {
+        if(heap_index[idx] == KNN_NO_NEIGHBOUR) break;
+        heap_distance[idx] = distance_from_chord_squared(heap_distance[idx], earth_radius);
+    }
+}
+
+internal void
+distance_matrix_process_block(distance_matrix_job *job, u64 row_start, u64 row_end) {
+    point_set *rows = job->rows;
+    point_set *cols = job->cols;
+    u64 col_padded_count = pairs_padded_count(cols->count);
+    u32 k = job->k;
+
+    lane_f64 two_radius = lane_f64_set1(2.0*job->earth_radius);
+    lane_f64 half = lane_f64_set1(0.5);
+    lane_f64 one = lane_f64_set1(1.0);
+
+    for(u64 tile_start = 0; tile_start < col_padded_count; tile_start += MATRIX_COL_TILE) {
+        u64 tile_end = tile_start + MATRIX_COL_TILE;
+        if(tile_end > col_padded_count) tile_end = col_padded_count;
+
+        for(u64 row = row_start; row < row_end; ++row) {
+            lane_f64 px = lane_f64_set1(rows->x[row]);
+            lane_f64 py = lane_f64_set1(rows->y[row]);
+            lane_f64 pz = lane_f64_set1(rows->z[row]);
+
+            if(k) {
+                f64 *heap_distance = job->knn_distance + row*k;
+                u32 *heap_index = job->knn_index + row*k;
+                lane_f64 threshold = lane_f64_set1(heap_distance[0]);
+                for(u64 col = tile_start; col < tile_end; col += LANE_F64_WIDTH) {
+                    lane_f64 dx = lane_f64_sub(lane_f64_load(cols->x + col), px);
+                    lane_f64 dy = lane_f64_sub(lane_f64_load(cols->y + col), py);
+                    lane_f64 dz = lane_f64_sub(lane_f64_load(cols->z + col), pz);
+                    lane_f64 chord_squared = lane_f64_fmadd(dz, dz, lane_f64_fmadd(dy, dy, lane_f64_mul(dx, dx)));
+
+                    /* NOTE(abid): Almost every lane loses against the k-th nearest, only go scalar
+                     * when one of them does not. */
+                    i32 closer_mask = lane_f64_movemask(lane_f64_lt(chord_squared, threshold));
+                    if(closer_mask) {
+                        f64 lanes[LANE_F64_WIDTH];
+                        lane_f64_store(lanes, chord_squared);
+                        for(u32 lane = 0; lane < LANE_F64_WIDTH; ++lane) {
+                            u64 col_idx = col + lane;
+                            if(!(closer_mask & (1 << lane))) continue;
+                            if(job->exclude_self && col_idx == row) continue;
+                            if(lanes[lane] < heap_distance[0]) {
+                                knn_heap_replace_top(heap_distance, heap_index, k, lanes[lane], (u32)col_idx);
+                            }
+                        }
+                        threshold = lane_f64_set1(heap_distance[0]);
+                    }
+                }
+            } else {
+                f64 *out = job->matrix + row*job->matrix_stride;
+                for(u64 col = tile_start; col < tile_end; col += LANE_F64_WIDTH) {
+                    lane_f64 dx = lane_f64_sub(lane_f64_load(cols->x + col), px);
+                    lane_f64 dy = lane_f64_sub(lane_f64_load(cols->y + col), py);
+                    lane_f64 dz = lane_f64_sub(lane_f64_load(cols->z + col), pz);
+                    lane_f64 chord_squared = lane_f64_fmadd(dz, dz, lane_f64_fmadd(dy, dy, lane_f64_mul(dx, dx)));
+                    lane_f64 half_chord = lane_f64_min(lane_f64_mul(lane_f64_sqrt(chord_squared), half), one);
+                    lane_f64_store(out + col, lane_f64_mul(two_radius, lane_f64_asin(half_chord)));
+                }
+            }
+        }
+    }
+}
+
+internal THREAD_PROC(distance_matrix_worker) {
+    distance_matrix_job *job = (distance_matrix_job *)param;
+    u64 row_count = job->rows->count;
+    u64 block_count = (row_count + MATRIX_ROW_BLOCK - 1) / MATRIX_ROW_BLOCK;
+    u32 k = job->k;
+
+    while(true) {
+        u64 block = platform_atomic_add_u64(&job->next_row_block, 1);
+        if(block >= block_count) break;
+
+        u64 row_start = block*MATRIX_ROW_BLOCK;
+        u64 row_end = row_start + MATRIX_ROW_BLOCK;
+        if(row_end > row_count) row_end = row_count;
+
+        if(k) {
+            for(u64 idx = row_start*k; idx < row_end*k; ++idx) {
+                job->knn_distance[idx] = INFINITY;
+                job->knn_index[idx] = KNN_NO_NEIGHBOUR;
+            }
+        }
+
+        distance_matrix_process_block(job, row_start, row_end);
+
+        if(k) {
+            for(u64 row = row_start; row < row_end; ++row) {
+                knn_row_finalize(job->knn_distance + row*k, job->knn_index + row*k, k, job->earth_radius);
+            }
+        }
+    }
+
+    return 0;
+}
+
+/* NOTE(abid): Allocates the output the job asks for (matrix or k-nearest lists). */
+internal void
+distance_matrix_alloc_output(distance_matrix_job *job, mem_arena *arena) {
+    if(job->k) {
+        job->knn_index = push_array_aligned(u32, job->rows->count*job->k, PAIRS_ALIGNMENT, arena);
+        job->knn_distance = push_array_aligned(f64, job->rows->count*job->k, PAIRS_ALIGNMENT, arena);
+    } else {
+        job->matrix_stride = pairs_padded_count(job->cols->count);
+        job->matrix = push_array_aligned(f64, job->rows->count*job->matrix_stride, PAIRS_ALIGNMENT, arena);
+    }
+}
+
+internal void
+distance_matrix_compute(distance_matrix_job *job) {
+    assert(job->cols->count < KNN_NO_NEIGHBOUR, "column set too large for u32 neighbour indices.");
+    if(job->thread_count == 0) job->thread_count = platform_cpu_count();
+    job->next_row_block = 0;
+
+    /* NOTE(abid): The calling thread is worker zero. */
+    u32 extra_threads = job->thread_count - 1;
+    platform_thread *threads = malloc(sizeof(platform_thread)*(extra_threads + 1));
+    for(u32 idx = 0; idx < extra_threads; ++idx) {
+        threads[idx] = platform_thread_create(distance_matrix_worker, job);
+    }
+    distance_matrix_worker(job);
+    for(u32 idx = 0; idx < extra_threads; ++idx) platform_thread_join(threads[idx]);
+
+    free(threads);
+}
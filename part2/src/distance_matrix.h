@@ -0,0 +1,50 @@
+/*  +======| File Info |===============================================================+
+    |                                                                                  |
+    |     Subdirectory:  /src                                                          |
+    |    Creation date:  10/19/2026 1:22:08 PM                                         |
+    |    Last Modified:                                                                |
+    |                                                                                  |
+    +======================================| Copyright © Sayed Abid Hashimi |==========+  */
+
+#if !defined(DISTANCE_MATRIX_H)
+
+/* NOTE(abid): Points with their trig terms precomputed once, as unit vectors on the sphere. The
+ * great-circle distance only needs the chord between two of them: d = 2R*asin(|p1 - p2|/2), which
+ * is exactly haversine with a = |p1 - p2|^2/4. Columns are padded like the pair columns, padding
+ * points are NaN so they never compare less than anything. */
+typedef struct {
+    u64 count;
+    f64 *x;
+    f64 *y;
+    f64 *z;
+} point_set;
+
+/* NOTE(abid): Tile shape, a column tile of 1024 points is 24KB of x/y/z and stays in L1/L2 while a
+ * row block sweeps over it. Row blocks are the unit of work handed to threads. */
+#define MATRIX_ROW_BLOCK 64
+#define MATRIX_COL_TILE 1024
+
+#define KNN_NO_NEIGHBOUR 0xFFFFFFFF
+
+typedef struct {
+    point_set *rows;
+    point_set *cols;
+    f64 earth_radius;
+    u32 thread_count;
+
+    /* NOTE(abid): k == 0 writes the full matrix (rows->count x matrix_stride, row major), otherwise
+     * only the k nearest columns per row are kept, sorted by distance. */
+    u32 k;
+    bool exclude_self; /* NOTE(abid): Skip col == row, for a set against itself. */
+
+    f64 *matrix;
+    u64 matrix_stride;
+
+    u32 *knn_index;
+    f64 *knn_distance;
+
+    volatile u64 next_row_block;
+} distance_matrix_job;
+
+#define DISTANCE_MATRIX_H
+#endif
@@ -0,0 +1,190 @@
+/*  +======| File Info |===============================================================+
+    |                                                                                  |
+    |     Subdirectory:  /src                                                          |
+    |    Creation date:  10/20/2026 1:02:18 PM                                         |
+    |    Last Modified:                                                                |
+    |                                                                                  |
+    +======================================| Copyright © Sayed Abid Hashimi |==========+  */
+
+#if PLT_LINUX
+#include <aio.h>
+#endif
+
+#include "file_reader.h"
+
+/* NOTE(abid): NULL if the combination can run here, otherwise why not. */
+internal char *
+file_reader_unsupported(file_read_method method, file_read_cache cache) {
+    if(cache == frc_direct && (method == frm_fread || method == frm_mmap || method == frm_mmap_populate)) {
+        return "needs the page cache";
+    }
+#if PLT_WIN
+    if(cache == frc_cold) return "no per-file page cache eviction on Win32";
+    if(method == frm_async) return "async reads are POSIX AIO, Linux only";
+#endif
+
+    return NULL;
+}
+
+/* NOTE(abid): The buffer is page aligned, which covers the direct I/O alignment. */
+internal file_reader
+file_reader_create(char *filename, file_read_method method, file_read_cache cache) {
+    file_reader result = {
+        .method = method,
+        .cache = cache,
+        .filename = filename,
+        .size = platform_file_64bit_get_size(filename),
+        .file = PLATFORM_FILE_INVALID,
+        .error = file_reader_unsupported(method, cache),
+    };
+    result.buffer_size = (result.size + FILE_READER_ALIGNMENT - 1) & ~(usize)(FILE_READER_ALIGNMENT - 1);
+    if(!result.error && method != frm_mmap && method != frm_mmap_populate) {
+        result.buffer = platform_allocate(result.buffer_size);
+        memset(result.buffer, 0, result.buffer_size);
+    }
+    if(!result.error && cache == frc_warm) {
+        FILE *handle = fopen(filename, "rb");
+        u8 block[kilobyte(64)];
+        if(handle) {
+            while(fread(block, 1, sizeof(block), handle) == sizeof(block)) {}
+            fclose(handle);
+        }
+    }
+
+    return result;
+}
+
+internal void
+file_reader_destroy(file_reader *reader) {
+    if(reader->buffer) platform_free(reader->buffer, reader->buffer_size);
+    reader->buffer = NULL;
+}
+
+/* NOTE(abid): Untimed part before a run, evicts the file for cold runs and opens it. */
+internal bool
+file_reader_prepare(file_reader *reader) {
+    if(reader->cache == frc_cold && !platform_file_drop_cache(reader->filename)) {
+        reader->error = "cannot evict the file from the page cache";
+        return false;
+    }
+    if(reader->method == frm_fread) {
+        reader->stream = fopen(reader->filename, "rb");
+        if(!reader->stream) reader->error = "cannot open the file";
+        return reader->stream != NULL;
+    }
+
+    reader->file = platform_file_open_read(reader->filename, reader->cache == frc_direct);
+    if(reader->file == PLATFORM_FILE_INVALID) {
+        reader->error = reader->cache == frc_direct ? "the file system does not support direct I/O" :
+                                                      "cannot open the file";
+    }
+
+    return reader->file != PLATFORM_FILE_INVALID;
+}
+
+#if PLT_LINUX
+/* NOTE(abid): Keeps FILE_READER_ASYNC_DEPTH chunk reads queued, waits for the oldest, queues the
+ * next one in its place. */
+internal usize
+file_reader_read_async(file_reader *reader, u64 chunk) {
+    struct aiocb requests[FILE_READER_ASYNC_DEPTH] = {0};
+    u64 next_offset = 0, done = 0;
+    u32 in_flight = 0, oldest = 0;
+    bool failed = false;
+    while(!failed && (next_offset < reader->size || in_flight)) {
+        while(in_flight < FILE_READER_ASYNC_DEPTH && next_offset < reader->size) {
+            struct aiocb *request = requests + (oldest + in_flight)%FILE_READER_ASYNC_DEPTH;
+            u64 left = reader->buffer_size - next_offset;
+            *request = (struct aiocb) {
+                .aio_fildes = reader->file,
+                .aio_buf = reader->buffer + next_offset,
+                .aio_nbytes = left < chunk ? left : chunk,
+                .aio_offset = (off_t)next_offset,
+            };
+            if(aio_read(request) != 0) {
+                failed = true;
+                break;
+            }
+            next_offset += chunk;
+            ++in_flight;
+        }
+        if(!in_flight) break;
+
+        struct aiocb *request = requests + oldest;
+        const struct aiocb *wait_list[1] = { request };
+        while(aio_error(request) == EINPROGRESS) aio_suspend(wait_list, 1, NULL);
+        ssize_t read = aio_return(request);
+        if(read < 0) failed = true;
+        else done += (u64)read;
+        oldest = (oldest + 1)%FILE_READER_ASYNC_DEPTH;
+        --in_flight;
+    }
+    /* NOTE(abid): Nothing may still write into the buffer once we return. */
+    for(; in_flight; --in_flight, oldest = (oldest + 1)%FILE_READER_ASYNC_DEPTH) {
+        struct aiocb *request = requests + oldest;
+        const struct aiocb *wait_list[1] = { request };
+        while(aio_error(request) == EINPROGRESS) aio_suspend(wait_list, 1, NULL);
+        aio_return(request);
+    }
+
+    return failed ? 0 : (usize)(done < reader->size ? done : reader->size);
+}
+#endif
+
+/* NOTE(abid): The timed part, returns the bytes that made it into memory. Direct reads ask for
+ * whole aligned blocks, the last one comes back short at the end of the file. */
+internal usize
+file_reader_read(file_reader *reader) {
+    u64 chunk = file_read_method_chunk[reader->method];
+    usize result = 0;
+    switch(reader->method) {
+        case frm_fread: {
+            result = fread(reader->buffer, 1, reader->size, reader->stream);
+        } break;
+        case frm_read_4k:
+        case frm_read_64k:
+        case frm_read_1m:
+        case frm_read_whole: {
+            usize request_size = reader->cache == frc_direct ? reader->buffer_size : reader->size;
+            if(!chunk) chunk = request_size;
+            for(u64 offset = 0; offset < request_size; offset += chunk) {
+                usize size = (request_size - offset < chunk) ? request_size - offset : chunk;
+                usize read = platform_file_read_at(reader->file, reader->buffer + offset, size, offset);
+                result += read;
+                if(read < size) break;
+            }
+            if(result > reader->size) result = reader->size;
+        } break;
+        case frm_mmap:
+        case frm_mmap_populate: {
+            reader->mapped = platform_file_map_read(reader->file, reader->size, reader->method == frm_mmap_populate);
+            if(reader->mapped) {
+                u8 *bytes = (u8 *)reader->mapped;
+                usize page_size = platform_page_get_size();
+                u64 touched = 0;
+                for(usize offset = 0; offset < reader->size; offset += page_size) touched += bytes[offset];
+                reader->touched += touched;
+                result = reader->size;
+            }
+        } break;
+        case frm_async: {
+#if PLT_LINUX
+            result = file_reader_read_async(reader, chunk);
+#endif
+        } break;
+        default: assert(false, "unknown file read method.");
+    }
+
+    return result;
+}
+
+/* NOTE(abid): Untimed part after a run. */
+internal void
+file_reader_finish(file_reader *reader) {
+    if(reader->mapped) platform_file_unmap(reader->mapped, reader->size);
+    if(reader->stream) fclose(reader->stream);
+    if(reader->file != PLATFORM_FILE_INVALID) platform_file_close(reader->file);
+    reader->mapped = NULL;
+    reader->stream = NULL;
+    reader->file = PLATFORM_FILE_INVALID;
+}
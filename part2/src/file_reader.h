@@ -0,0 +1,94 @@
+/*  +======| File Info |===============================================================+
+    |                                                                                  |
+    |     Subdirectory:  /src                                                          |
+    |    Creation date:  10/20/2026 1:02:18 PM                                         |
+    |    Last Modified:                                                                |
+    |                                                                                  |
+    +======================================| Copyright © Sayed Abid Hashimi |==========+  */
+
+#if !defined(FILE_READER_H)
+
+/* NOTE(abid): Ways of getting a whole file into memory, for `--iotest`.
+ * - fread:         one fread through stdio into the buffer (what `read_file` does).
+ * - read_4k .. 1m: positioned reads of that many bytes each.
+ * - read_whole:    one positioned read of the whole file.
+ * - mmap:          map the file and touch every page, the faults are the read (nothing is copied,
+ *                  so it is only comparable as "time until the bytes are addressable").
+ * - mmap_populate: the same with the pages faulted in by the map call (MAP_POPULATE).
+ * - async:         FILE_READER_ASYNC_DEPTH reads of the chunk size in flight (POSIX AIO, Linux).
+ * Chunk 0 = the whole file in one call. */
+#define FILE_READ_METHODS          \
+    X(fread, 0)                    \
+    X(read_4k, kilobyte(4))        \
+    X(read_64k, kilobyte(64))      \
+    X(read_1m, megabyte(1))        \
+    X(read_whole, 0)               \
+    X(mmap, 0)                     \
+    X(mmap_populate, 0)            \
+    X(async, megabyte(1))
+
+typedef enum {
+#define X(value, chunk) frm_ ## value,
+    FILE_READ_METHODS
+#undef X
+    frm_count
+} file_read_method;
+
+char *file_read_method_str[] = {
+#define X(value, chunk) #value,
+    FILE_READ_METHODS
+#undef X
+};
+
+u64 file_read_method_chunk[] = {
+#define X(value, chunk) (u64)(chunk),
+    FILE_READ_METHODS
+#undef X
+};
+
+/* NOTE(abid): Where the file is when a run starts.
+ * - warm:   in the page cache, read once before the first run.
+ * - cold:   evicted (posix_fadvise DONTNEED) before every run, so every run goes to the device.
+ * - direct: O_DIRECT / NO_BUFFERING, the page cache is bypassed altogether (positioned and
+ *           async reads only, the buffer, sizes and offsets are FILE_READER_ALIGNMENT aligned).
+ * A file system that keeps the pages anyway (tmpfs, some overlays) makes cold the same as warm,
+ * the report prints how much of the file was cached when the run started. */
+#define FILE_READ_CACHE_MODES \
+    X(warm)                   \
+    X(cold)                   \
+    X(direct)
+
+typedef enum {
+#define X(value) frc_ ## value,
+    FILE_READ_CACHE_MODES
+#undef X
+    frc_count
+} file_read_cache;
+
+char *file_read_cache_str[] = {
+#define X(value) #value,
+    FILE_READ_CACHE_MODES
+#undef X
+};
+
+#define FILE_READER_ALIGNMENT 4096
+#define FILE_READER_ASYNC_DEPTH 4
+
+typedef struct {
+    file_read_method method;
+    file_read_cache cache;
+    char *filename;
+    usize size;
+    usize buffer_size; /* NOTE(abid): `size` rounded up to the alignment. */
+    u8 *buffer;
+    char *error;
+
+    /* NOTE(abid): Current run. */
+    FILE *stream;
+    platform_file file;
+    void *mapped;
+    volatile u64 touched; /* NOTE(abid): Sum of one byte per mapped page, keeps the touches. */
+} file_reader;
+
+#define FILE_READER_H
+#endif
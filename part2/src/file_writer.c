@@ -0,0 +1,152 @@
+/*  +======| File Info |===============================================================+
+    |                                                                                  |
+    |     Subdirectory:  /src                                                          |
+    |    Creation date:  10/19/2026 5:41:48 PM                                         |
+    |    Last Modified:                                                                |
+    |                                                                                  |
+    +======================================| Copyright © Sayed Abid Hashimi |==========+  */
+
+#include "file_writer.h"
+
+internal void
+file_writer_flush_pending(file_writer *writer) {
+    u8 *data = writer->pending_data;
+    usize size = writer->pending_size;
+    u64 offset = writer->pending_offset;
+
+    switch(writer->mode) {
+        case fwm_buffered: {
+            if(!platform_file_write_at(writer->file, data, size, offset)) writer->failed = true;
+        } break;
+        case fwm_direct: {
+            /* NOTE(abid): Only the tail can be short, pad it to a whole sector, the padding is
+             * truncated away on close. */
+            usize aligned_size = (size + FILE_WRITER_SECTOR_SIZE - 1) & ~(usize)(FILE_WRITER_SECTOR_SIZE - 1);
+            memset(data + size, 0, aligned_size - size);
+            if(!platform_file_write_at(writer->file, data, aligned_size, offset)) writer->failed = true;
+        } break;
+        case fwm_mmap: {
+            void *mapped = NULL;
+            if(platform_file_set_size(writer->file, offset + size)) {
+                mapped = platform_file_map_range(writer->file, offset, size);
+            }
+            if(mapped) {
+                memcpy(mapped, data, size);
+                platform_file_unmap(mapped, size);
+            } else writer->failed = true;
+        } break;
+        default: assert(false, "unknown file writer mode.");
+    }
+}
+
+internal THREAD_PROC(file_writer_thread) {
+    file_writer *writer = (file_writer *)param;
+
+    while(true) {
+        platform_semaphore_wait(&writer->work_ready);
+        if(writer->quit) break;
+
+        file_writer_flush_pending(writer);
+        platform_semaphore_signal(&writer->buffer_free);
+    }
+
+    return 0;
+}
+
+/* NOTE(abid): Creates (or truncates) `filename`, the file stays open until `file_writer_close`. */
+internal file_writer *
+file_writer_open(char *filename, file_writer_mode mode) {
+    file_writer *writer = calloc(1, sizeof(file_writer));
+    writer->mode = mode;
+    writer->buffer_size = FILE_WRITER_BUFFER_SIZE;
+
+    bool unbuffered = false;
+    writer->file = platform_file_open_write(filename, mode == fwm_direct, &unbuffered);
+    assert(writer->file != PLATFORM_FILE_INVALID, "cannot open %s for writing.", filename);
+    if(mode == fwm_direct && !unbuffered) writer->mode = fwm_buffered;
+
+    /* NOTE(abid): Page aligned, which covers the direct I/O alignment. */
+    for(u32 idx = 0; idx < 2; ++idx) {
+        writer->buffers[idx] = platform_allocate(writer->buffer_size + FILE_WRITER_MAX_RESERVE);
+    }
+
+    platform_semaphore_init(&writer->buffer_free, 1);
+    platform_semaphore_init(&writer->work_ready, 0);
+    writer->thread = platform_thread_create(file_writer_thread, writer);
+
+    return writer;
+}
+
+/* NOTE(abid): Waits for the writer thread to release the other buffer, then hands it `size` bytes
+ * of the current one. */
+internal void
+file_writer_submit(file_writer *writer, usize size) {
+    platform_semaphore_wait(&writer->buffer_free);
+    writer->pending_data = writer->buffers[writer->fill_idx];
+    writer->pending_size = size;
+    writer->pending_offset = writer->submitted_bytes;
+    writer->submitted_bytes += size;
+    platform_semaphore_signal(&writer->work_ready);
+}
+
+/* NOTE(abid): Space for at least `size` bytes, only `file_writer_commit` makes them part of the
+ * file. */
+inline internal void *
+file_writer_reserve(file_writer *writer, usize size) {
+    assert(size <= FILE_WRITER_MAX_RESERVE, "file writer reservation too large.");
+    return writer->buffers[writer->fill_idx] + writer->fill_used;
+}
+
+inline internal void
+file_writer_commit(file_writer *writer, usize size) {
+    writer->fill_used += size;
+    if(writer->fill_used < writer->buffer_size) return;
+
+    /* NOTE(abid): Submit exactly one full buffer, whatever spilled past it starts the next one. */
+    usize overflow = writer->fill_used - writer->buffer_size;
+    u8 *full = writer->buffers[writer->fill_idx];
+    file_writer_submit(writer, writer->buffer_size);
+    writer->fill_idx ^= 1;
+    memcpy(writer->buffers[writer->fill_idx], full + writer->buffer_size, overflow);
+    writer->fill_used = overflow;
+}
+
+internal void
+file_writer_write(file_writer *writer, void *data, usize size) {
+    u8 *src = (u8 *)data;
+    while(size) {
+        usize chunk = (size > FILE_WRITER_MAX_RESERVE) ? FILE_WRITER_MAX_RESERVE : size;
+        memcpy(file_writer_reserve(writer, chunk), src, chunk);
+        file_writer_commit(writer, chunk);
+        src += chunk;
+        size -= chunk;
+    }
+}
+
+/* NOTE(abid): Flushes what is left, stops the writer thread and closes the file. Returns the
+ * number of bytes in the file. */
+internal u64
+file_writer_close(file_writer *writer) {
+    if(writer->fill_used) {
+        file_writer_submit(writer, writer->fill_used);
+        writer->fill_used = 0;
+    }
+    platform_semaphore_wait(&writer->buffer_free);
+    writer->quit = true;
+    platform_semaphore_signal(&writer->work_ready);
+    platform_thread_join(writer->thread);
+
+    u64 total_bytes = writer->submitted_bytes;
+    if(writer->mode == fwm_direct && !platform_file_set_size(writer->file, total_bytes)) writer->failed = true;
+    assert(!writer->failed, "file writer could not write %llu bytes.", total_bytes);
+
+    platform_file_close(writer->file);
+    platform_semaphore_destroy(&writer->buffer_free);
+    platform_semaphore_destroy(&writer->work_ready);
+    for(u32 idx = 0; idx < 2; ++idx) {
+        platform_free(writer->buffers[idx], writer->buffer_size + FILE_WRITER_MAX_RESERVE);
+    }
+    free(writer);
+
+    return total_bytes;
+}
@@ -0,0 +1,65 @@
+/*  +======| File Info |===============================================================+
+    |                                                                                  |
+    |     Subdirectory:  /src                                                          |
+    |    Creation date:  10/19/2026 5:41:12 PM                                         |
+    |    Last Modified:                                                                |
+    |                                                                                  |
+    +======================================| Copyright © Sayed Abid Hashimi |==========+  */
+
+#if !defined(FILE_WRITER_H)
+
+/* NOTE(abid): How the writer thread gets a full buffer to disk.
+ * - buffered: positioned write through the page cache.
+ * - direct:   O_DIRECT / NO_BUFFERING write, the tail is padded and the file truncated on close.
+ *             Falls back to buffered where the file system does not support it.
+ * - mmap:     grows the file and copies the buffer into a shared mapping of that range. */
+#define FILE_WRITER_MODES \
+    X(buffered)           \
+    X(direct)             \
+    X(mmap)
+
+typedef enum {
+#define X(value) fwm_ ## value,
+    FILE_WRITER_MODES
+#undef X
+    fwm_count
+} file_writer_mode;
+
+char *file_writer_mode_str[] = {
+#define X(value) #value,
+    FILE_WRITER_MODES
+#undef X
+};
+
+/* NOTE(abid): Buffer size is a multiple of the direct I/O sector size and of the Win32 mapping
+ * granularity, so every full buffer lands on an aligned file offset. A reservation may run up to
+ * `FILE_WRITER_MAX_RESERVE` past the end of the buffer, the overflow moves to the next one. */
+#define FILE_WRITER_BUFFER_SIZE megabyte(4)
+#define FILE_WRITER_MAX_RESERVE kilobyte(4)
+#define FILE_WRITER_SECTOR_SIZE 4096
+
+typedef struct {
+    file_writer_mode mode;
+    platform_file file;
+    usize buffer_size;
+
+    /* NOTE(abid): The producer fills buffers[fill_idx] while the writer thread owns the other one. */
+    u8 *buffers[2];
+    u32 fill_idx;
+    usize fill_used;
+    u64 submitted_bytes;
+
+    /* NOTE(abid): Hand-off, `buffer_free` is signaled when the writer thread is done with a buffer,
+     * `work_ready` when a new one is pending (or `quit` is set). */
+    platform_thread thread;
+    platform_semaphore buffer_free;
+    platform_semaphore work_ready;
+    u8 *pending_data;
+    usize pending_size;
+    u64 pending_offset;
+    bool quit;
+    bool failed;
+} file_writer;
+
+#define FILE_WRITER_H
+#endif
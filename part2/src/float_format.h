@@ -0,0 +1,24 @@
+/*  +======| File Info |===============================================================+
+    |                                                                                  |
+    |     Subdirectory:  /src                                                          |
+    |    Creation date:  10/19/2026 7:12:06 PM                                         |
+    |    Last Modified:                                                                |
+    |                                                                                  |
+    +======================================| Copyright © Sayed Abid Hashimi |==========+  */
+
+#if !defined(FLOAT_FORMAT_H)
+
+/* NOTE(abid): f64 to text without going through printf.
+ * - shortest: the fewest digits that parse back to the exact same f64 (Schubfach), fixed notation
+ *             for decimal exponents in [-5, 21), scientific otherwise. Always has a '.' or an 'e'
+ *             so the JSON lexer sees a float.
+ * - fixed:    `precision` decimals, correctly rounded (ties to even on the exact binary value),
+ *             same output as "%.*f" for precision <= FLOAT_FORMAT_MAX_PRECISION and
+ *             |value| < 2^53. Anything outside that falls back to shortest.
+ * Neither writes a terminator. */
+#define FLOAT_FORMAT_SHORTEST 0xFFFFFFFF
+#define FLOAT_FORMAT_MAX_PRECISION 22
+#define FLOAT_FORMAT_MAX_LEN 96
+
+#define FLOAT_FORMAT_H
+#endif
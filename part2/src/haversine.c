@@ -6,8 +6,12 @@
     |                                                                                  |
     +======================================| Copyright © Sayed Abid Hashimi |==========+  */
 
+#include "haversine.h"
+
 /* NOTE(abid): EarthRadius is generally expected to be 6372.8 */
 #define EARTH_RAIDUS 6372.8
+/* NOTE(abid): The reference answers, the same on every ISA. */
+FP_CONTRACT_OFF_BEGIN
 internal f64
 haversine(f64 x0, f64 y0, f64 x1, f64 y1, f64 earth_radius) {
     f64 lat1 = y0;
@@ -27,148 +31,993 @@ haversine(f64 x0, f64 y0, f64 x1, f64 y1, f64 earth_radius) {
     
     return result;
 }
+FP_CONTRACT_OFF_END
+
+#define DEGREES_TO_RADIANS 0.01745329251994329577
+
+/* NOTE(abid): `units_to_radians` lets callers feed coordinates in other units than degrees (q32
+ * fixed point) and fold the conversion into the radians multiply. */
+internal inline lane_f64
+haversine_lane_f64_units(lane_f64 x0, lane_f64 y0, lane_f64 x1, lane_f64 y1, lane_f64 earth_radius,
+                         f64 units_to_radians) {
+    lane_f64 to_radians = lane_f64_set1(units_to_radians);
+    lane_f64 to_half_radians = lane_f64_set1(0.5*units_to_radians);
+
+    lane_f64 half_dlat = lane_f64_mul(lane_f64_sub(y1, y0), to_half_radians);
+    lane_f64 half_dlon = lane_f64_mul(lane_f64_sub(x1, x0), to_half_radians);
+    lane_f64 lat1 = lane_f64_mul(y0, to_radians);
+    lane_f64 lat2 = lane_f64_mul(y1, to_radians);
+
+    lane_f64 sin_dlat = lane_f64_sin(half_dlat);
+    lane_f64 sin_dlon = lane_f64_sin(half_dlon);
+    lane_f64 cos_lat_product = lane_f64_mul(lane_f64_cos(lat1), lane_f64_cos(lat2));
+    lane_f64 a = lane_f64_fmadd(cos_lat_product, lane_f64_mul(sin_dlon, sin_dlon),
+                                lane_f64_mul(sin_dlat, sin_dlat));
+    /* NOTE(abid): Rounding can push `a` a hair above 1 for antipodal points. */
+    a = lane_f64_min(a, lane_f64_set1(1.0));
+    lane_f64 c = lane_f64_mul(lane_f64_set1(2.0), lane_f64_asin(lane_f64_sqrt(a)));
+
+    return lane_f64_mul(earth_radius, c);
+}
+
+internal inline lane_f64
+haversine_lane_f64(lane_f64 x0, lane_f64 y0, lane_f64 x1, lane_f64 y1, lane_f64 earth_radius) {
+    return haversine_lane_f64_units(x0, y0, x1, y1, earth_radius, DEGREES_TO_RADIANS);
+}
+
+internal inline lane_f32
+haversine_lane_f32(lane_f32 x0, lane_f32 y0, lane_f32 x1, lane_f32 y1, lane_f32 earth_radius) {
+    lane_f32 to_radians = lane_f32_set1((f32)DEGREES_TO_RADIANS);
+    lane_f32 to_half_radians = lane_f32_set1((f32)(0.5*DEGREES_TO_RADIANS));
+
+    lane_f32 half_dlat = lane_f32_mul(lane_f32_sub(y1, y0), to_half_radians);
+    lane_f32 half_dlon = lane_f32_mul(lane_f32_sub(x1, x0), to_half_radians);
+    lane_f32 lat1 = lane_f32_mul(y0, to_radians);
+    lane_f32 lat2 = lane_f32_mul(y1, to_radians);
+
+    lane_f32 sin_dlat = lane_f32_sin(half_dlat);
+    lane_f32 sin_dlon = lane_f32_sin(half_dlon);
+    lane_f32 cos_lat_product = lane_f32_mul(lane_f32_cos(lat1), lane_f32_cos(lat2));
+    lane_f32 a = lane_f32_fmadd(cos_lat_product, lane_f32_mul(sin_dlon, sin_dlon),
+                                lane_f32_mul(sin_dlat, sin_dlat));
+    a = lane_f32_min(a, lane_f32_set1(1.0f));
+    lane_f32 c = lane_f32_mul(lane_f32_set1(2.0f), lane_f32_asin(lane_f32_sqrt(a)));
+
+    return lane_f32_mul(earth_radius, c);
+}
+
+/* NOTE(abid): SoA pair columns. */
+inline internal u64
+pairs_padded_count(u64 count) {
+    return (count + PAIRS_PADDING - 1) & ~(u64)(PAIRS_PADDING - 1);
+}
+
+internal pairs_f64
+pairs_f64_alloc(u64 count, mem_arena *arena) {
+    u64 padded_count = pairs_padded_count(count);
+    pairs_f64 result = { .count = count };
+    result.x0 = push_array_aligned(f64, padded_count, PAIRS_ALIGNMENT, arena);
+    result.y0 = push_array_aligned(f64, padded_count, PAIRS_ALIGNMENT, arena);
+    result.x1 = push_array_aligned(f64, padded_count, PAIRS_ALIGNMENT, arena);
+    result.y1 = push_array_aligned(f64, padded_count, PAIRS_ALIGNMENT, arena);
+    for(u64 idx = count; idx < padded_count; ++idx) {
+        result.x0[idx] = result.y0[idx] = result.x1[idx] = result.y1[idx] = 0.0;
+    }
+
+    return result;
+}
+
+internal pairs_f32
+pairs_f32_alloc(u64 count, mem_arena *arena) {
+    u64 padded_count = pairs_padded_count(count);
+    pairs_f32 result = { .count = count };
+    result.x0 = push_array_aligned(f32, padded_count, PAIRS_ALIGNMENT, arena);
+    result.y0 = push_array_aligned(f32, padded_count, PAIRS_ALIGNMENT, arena);
+    result.x1 = push_array_aligned(f32, padded_count, PAIRS_ALIGNMENT, arena);
+    result.y1 = push_array_aligned(f32, padded_count, PAIRS_ALIGNMENT, arena);
+    for(u64 idx = count; idx < padded_count; ++idx) {
+        result.x0[idx] = result.y0[idx] = result.x1[idx] = result.y1[idx] = 0.0f;
+    }
+
+    return result;
+}
+
+internal pairs_q32
+pairs_q32_alloc(u64 count, mem_arena *arena) {
+    u64 padded_count = pairs_padded_count(count);
+    pairs_q32 result = { .count = count };
+    result.x0 = push_array_aligned(i32, padded_count, PAIRS_ALIGNMENT, arena);
+    result.y0 = push_array_aligned(i32, padded_count, PAIRS_ALIGNMENT, arena);
+    result.x1 = push_array_aligned(i32, padded_count, PAIRS_ALIGNMENT, arena);
+    result.y1 = push_array_aligned(i32, padded_count, PAIRS_ALIGNMENT, arena);
+    for(u64 idx = count; idx < padded_count; ++idx) {
+        result.x0[idx] = result.y0[idx] = result.x1[idx] = result.y1[idx] = 0;
+    }
+
+    return result;
+}
+
+inline internal i32
+coord_q32_from_degrees(f64 degrees) { return (i32)lround(degrees*COORD_Q32_SCALE); }
+
+/* NOTE(abid): Division (not multiply by 1e-7) so the result is the correctly rounded value of the
+ * 7 decimal string, the same double `strtod` gives back when the file is parsed. */
+inline internal f64
+coord_degrees_from_q32(i32 fixed) { return (f64)fixed / COORD_Q32_SCALE; }
+
+internal pairs_f64
+pairs_f64_from_json(json_dict *json, mem_arena *arena) {
+    json_list *pairs = jp_get_dict_value(json, "pairs", json_list);
+    pairs_f64 result = pairs_f64_alloc(pairs->count, arena);
+    for(u64 idx = 0; idx < pairs->count; ++idx) {
+        json_dict *elem = jp_get_list_elem(pairs, idx, json_dict);
+        result.x0[idx] = *jp_get_dict_value(elem, "x0", f64);
+        result.y0[idx] = *jp_get_dict_value(elem, "y0", f64);
+        result.x1[idx] = *jp_get_dict_value(elem, "x1", f64);
+        result.y1[idx] = *jp_get_dict_value(elem, "y1", f64);
+    }
+
+    return result;
+}
+
+#define JSON_SCHEMA_NAME pair_record
+#define JSON_SCHEMA_FIELDS PAIR_RECORD_FIELDS
+#include "json_schema_parser.h"
+
+/* NOTE(abid): Upper bound on the records of a pairs document, every record opens one '{' and the
+ * document itself another. */
+internal u64
+pairs_json_capacity(char *data, usize size) {
+    u64 braces = json_schema_count_byte(data, size, '{');
+    return braces ? braces - 1 : 0;
+}
+
+/* NOTE(abid): Parses a pairs document straight into f64 columns with room for `capacity` records,
+ * no tree in between. The columns are sized for `capacity` and trimmed to what was parsed. */
+internal json_schema_status
+pairs_f64_from_json_schema(char *data, usize size, u64 capacity, mem_arena *arena, pairs_f64 *out) {
+    pairs_f64 result = pairs_f64_alloc(capacity, arena);
+    pair_record_columns columns = {
+        .capacity = capacity,
+        .x0 = result.x0, .y0 = result.y0, .x1 = result.x1, .y1 = result.y1,
+    };
+    json_schema_status status = pair_record_parse_document(data, size, "pairs", &columns);
+
+    result.count = columns.count;
+    for(u64 idx = result.count; idx < pairs_padded_count(result.count); ++idx) {
+        result.x0[idx] = result.y0[idx] = result.x1[idx] = result.y1[idx] = 0.0;
+    }
+    *out = result;
+
+    return status;
+}
+
+internal pairs_f32
+pairs_f32_from_json(json_dict *json, mem_arena *arena) {
+    json_list *pairs = jp_get_dict_value(json, "pairs", json_list);
+    pairs_f32 result = pairs_f32_alloc(pairs->count, arena);
+    for(u64 idx = 0; idx < pairs->count; ++idx) {
+        json_dict *elem = jp_get_list_elem(pairs, idx, json_dict);
+        result.x0[idx] = (f32)*jp_get_dict_value(elem, "x0", f64);
+        result.y0[idx] = (f32)*jp_get_dict_value(elem, "y0", f64);
+        result.x1[idx] = (f32)*jp_get_dict_value(elem, "x1", f64);
+        result.y1[idx] = (f32)*jp_get_dict_value(elem, "y1", f64);
+    }
+
+    return result;
+}
+
+internal pairs_q32
+pairs_q32_from_json(json_dict *json, mem_arena *arena) {
+    json_list *pairs = jp_get_dict_value(json, "pairs", json_list);
+    pairs_q32 result = pairs_q32_alloc(pairs->count, arena);
+    for(u64 idx = 0; idx < pairs->count; ++idx) {
+        json_dict *elem = jp_get_list_elem(pairs, idx, json_dict);
+        result.x0[idx] = coord_q32_from_degrees(*jp_get_dict_value(elem, "x0", f64));
+        result.y0[idx] = coord_q32_from_degrees(*jp_get_dict_value(elem, "y0", f64));
+        result.x1[idx] = coord_q32_from_degrees(*jp_get_dict_value(elem, "x1", f64));
+        result.y1[idx] = coord_q32_from_degrees(*jp_get_dict_value(elem, "y1", f64));
+    }
+
+    return result;
+}
+
+internal pairs_f32
+pairs_f32_from_f64(pairs_f64 *pairs, mem_arena *arena) {
+    pairs_f32 result = pairs_f32_alloc(pairs->count, arena);
+    for(u64 idx = 0; idx < pairs->count; ++idx) {
+        result.x0[idx] = (f32)pairs->x0[idx];
+        result.y0[idx] = (f32)pairs->y0[idx];
+        result.x1[idx] = (f32)pairs->x1[idx];
+        result.y1[idx] = (f32)pairs->y1[idx];
+    }
+
+    return result;
+}
 
+internal pairs_q32
+pairs_q32_from_f64(pairs_f64 *pairs, mem_arena *arena) {
+    pairs_q32 result = pairs_q32_alloc(pairs->count, arena);
+    for(u64 idx = 0; idx < pairs->count; ++idx) {
+        result.x0[idx] = coord_q32_from_degrees(pairs->x0[idx]);
+        result.y0[idx] = coord_q32_from_degrees(pairs->y0[idx]);
+        result.x1[idx] = coord_q32_from_degrees(pairs->x1[idx]);
+        result.y1[idx] = coord_q32_from_degrees(pairs->y1[idx]);
+    }
+
+    return result;
+}
+
+internal pairs_f64
+pairs_f64_from_q32(pairs_q32 *pairs, mem_arena *arena) {
+    pairs_f64 result = pairs_f64_alloc(pairs->count, arena);
+    for(u64 idx = 0; idx < pairs->count; ++idx) {
+        result.x0[idx] = coord_degrees_from_q32(pairs->x0[idx]);
+        result.y0[idx] = coord_degrees_from_q32(pairs->y0[idx]);
+        result.x1[idx] = coord_degrees_from_q32(pairs->x1[idx]);
+        result.y1[idx] = coord_degrees_from_q32(pairs->y1[idx]);
+    }
+
+    return result;
+}
+
+inline internal bool
+pairs_mapping_is_q32(pairs_file_mapping *mapping) {
+    return (mapping->header->flags & PAIRS_FILE_FLAG_QUANTIZED_Q32) != 0;
+}
+
+/* NOTE(abid): The mapped columns of a quantized file, padded and aligned, the q32 kernel uses them
+ * in place. */
+inline internal pairs_q32
+pairs_q32_from_mapping(pairs_file_mapping *mapping) {
+    assert(pairs_mapping_is_q32(mapping), ".pairs columns are not q32.");
+    pairs_q32 result = {
+        .count = mapping->header->count,
+        .x0 = mapping->columns[0],
+        .y0 = mapping->columns[1],
+        .x1 = mapping->columns[2],
+        .y1 = mapping->columns[3],
+    };
+    assert(mapping->header->column_stride >= pairs_padded_count(result.count), ".pairs columns are not padded.");
+
+    return result;
+}
+
+/* NOTE(abid): Mapped f64 columns are padded and aligned already, the kernels use them in place.
+ * The i32 columns of a quantized file are converted once into `mapping->converted` (exact, they
+ * are the grid values), freed with the mapping. */
+internal pairs_f64
+pairs_f64_from_mapping(pairs_file_mapping *mapping) {
+    if(pairs_mapping_is_q32(mapping)) {
+        assert(!mapping->converted, ".pairs columns converted twice.");
+        pairs_q32 fixed = pairs_q32_from_mapping(mapping);
+        usize column_bytes = 4*sizeof(f64)*pairs_padded_count(fixed.count) + 4*PAIRS_ALIGNMENT;
+        mapping->converted = arena_create(column_bytes, column_bytes);
+        return pairs_f64_from_q32(&fixed, mapping->converted);
+    }
+
+    pairs_f64 result = {
+        .count = mapping->header->count,
+        .x0 = mapping->columns[0],
+        .y0 = mapping->columns[1],
+        .x1 = mapping->columns[2],
+        .y1 = mapping->columns[3],
+    };
+    assert(mapping->header->column_stride >= pairs_padded_count(result.count), ".pairs columns are not padded.");
+
+    return result;
+}
+
+/* NOTE(abid): Unquantized only, a quantized file wants i32 columns (see `pairs_file_append`). */
 internal void
-offload_to_buffer(mem_arena *json_arena, mem_arena *result_arena, f64 y0, f64 y1, f64 x0, f64 x1,
-                  bool is_last, char *json_filename, char *f64_filename) {
-    u64 suffix_len = 3; /* NOTE(abid): Length of "\n]}" */
-
-    /* NOTE(abid): We will be overestimating our memory usage since we assume each number's
-     *             length to be 3 + FloatPrecision, which will not always be true. */
-    u32 precision = 20;
-    i32 num_chars_per_pair = 1 + 2 + 4*4 + 4 + 3 + 1 + 1 + 4*(4 + 1 + precision);
-    snprintf(arena_current(json_arena), json_arena->size - json_arena->used,
-              "\t{\"x0\":%.*f, \"y0\":%.*f, \"x1\":%.*f, \"y1\":%.*f}",
-              precision, x0, precision, y0, precision, x1, precision, y1);
-    arena_advance(json_arena, strlen(arena_current(json_arena)), char);
+pairs_f64_write_file(char *filename, pairs_f64 *pairs, u64 seed, u64 num_clusters, u32 flags) {
+    assert(!(flags & PAIRS_FILE_FLAG_QUANTIZED_Q32), "f64 pairs written as a quantized file.");
+    pairs_file_writer *writer = pairs_file_create(filename, pairs->count, pairs_padded_count(pairs->count),
+                                                  seed, num_clusters, flags);
+    void *columns[PAIRS_FILE_COLUMNS] = { pairs->x0, pairs->y0, pairs->x1, pairs->y1 };
+    pairs_file_append(writer, columns, pairs->count);
+    pairs_file_close(writer);
+}
 
+/* NOTE(abid): Batch kernels. Each returns the sum of all distances, and if `out` is not NULL also
+ * writes the per-pair distances to it (must hold `pairs_padded_count(count)` values). */
+internal f64
+haversine_sum_f64(pairs_f64 *pairs, f64 earth_radius, f64 *out) {
+    u64 padded_count = pairs_padded_count(pairs->count);
+    lane_f64 radius = lane_f64_set1(earth_radius);
+    lane_f64 sum = lane_f64_zero();
+    for(u64 idx = 0; idx < padded_count; idx += LANE_F64_WIDTH) {
+        lane_f64 distance = haversine_lane_f64(lane_f64_load(pairs->x0 + idx), lane_f64_load(pairs->y0 + idx),
+                                               lane_f64_load(pairs->x1 + idx), lane_f64_load(pairs->y1 + idx),
+                                               radius);
+        sum = lane_f64_add(sum, distance);
+        if(out) lane_f64_store(out + idx, distance);
+    }
+
+    return lane_f64_hsum(sum);
+}
+
+internal f64
+haversine_sum_f32(pairs_f32 *pairs, f64 earth_radius, f64 *out) {
+    /* NOTE(abid): f32 math, but each lane result is widened before it hits the accumulator, the
+     * sum over millions of pairs would otherwise lose far more than the kernel itself. */
+    u64 padded_count = pairs_padded_count(pairs->count);
+    lane_f32 radius = lane_f32_set1((f32)earth_radius);
+    lane_f64 sum_lo = lane_f64_zero();
+    lane_f64 sum_hi = lane_f64_zero();
+    for(u64 idx = 0; idx < padded_count; idx += LANE_F32_WIDTH) {
+        lane_f32 distance = haversine_lane_f32(lane_f32_load(pairs->x0 + idx), lane_f32_load(pairs->y0 + idx),
+                                               lane_f32_load(pairs->x1 + idx), lane_f32_load(pairs->y1 + idx),
+                                               radius);
+        lane_f64 distance_lo = lane_f64_from_f32_lo(distance);
+        lane_f64 distance_hi = lane_f64_from_f32_hi(distance);
+        sum_lo = lane_f64_add(sum_lo, distance_lo);
+        sum_hi = lane_f64_add(sum_hi, distance_hi);
+        if(out) {
+            lane_f64_store(out + idx, distance_lo);
+            lane_f64_store(out + idx + LANE_F64_WIDTH, distance_hi);
+        }
+    }
+
+    return lane_f64_hsum(lane_f64_add(sum_lo, sum_hi));
+}
+
+internal f64
+haversine_sum_mixed(pairs_f32 *pairs, f64 earth_radius, f64 *out) {
+    u64 padded_count = pairs_padded_count(pairs->count);
+    lane_f64 radius = lane_f64_set1(earth_radius);
+    lane_f64 sum = lane_f64_zero();
+    for(u64 idx = 0; idx < padded_count; idx += LANE_F32_WIDTH) {
+        lane_f32 x0 = lane_f32_load(pairs->x0 + idx);
+        lane_f32 y0 = lane_f32_load(pairs->y0 + idx);
+        lane_f32 x1 = lane_f32_load(pairs->x1 + idx);
+        lane_f32 y1 = lane_f32_load(pairs->y1 + idx);
+        lane_f64 distance_lo = haversine_lane_f64(lane_f64_from_f32_lo(x0), lane_f64_from_f32_lo(y0),
+                                                  lane_f64_from_f32_lo(x1), lane_f64_from_f32_lo(y1), radius);
+        lane_f64 distance_hi = haversine_lane_f64(lane_f64_from_f32_hi(x0), lane_f64_from_f32_hi(y0),
+                                                  lane_f64_from_f32_hi(x1), lane_f64_from_f32_hi(y1), radius);
+        sum = lane_f64_add(sum, lane_f64_add(distance_lo, distance_hi));
+        if(out) {
+            lane_f64_store(out + idx, distance_lo);
+            lane_f64_store(out + idx + LANE_F64_WIDTH, distance_hi);
+        }
+    }
+
+    return lane_f64_hsum(sum);
+}
+
+internal f64
+haversine_sum_q32(pairs_q32 *pairs, f64 earth_radius, f64 *out) {
+    /* NOTE(abid): Integer to f64 conversion happens in lanes, the 1e-7 scale is folded into the
+     * degrees to radians multiply. */
+    u64 padded_count = pairs_padded_count(pairs->count);
+    lane_f64 radius = lane_f64_set1(earth_radius);
+    f64 q32_to_radians = DEGREES_TO_RADIANS/COORD_Q32_SCALE;
+    lane_f64 sum = lane_f64_zero();
+    for(u64 idx = 0; idx < padded_count; idx += LANE_F32_WIDTH) {
+        lane_i32 x0 = lane_i32_load(pairs->x0 + idx);
+        lane_i32 y0 = lane_i32_load(pairs->y0 + idx);
+        lane_i32 x1 = lane_i32_load(pairs->x1 + idx);
+        lane_i32 y1 = lane_i32_load(pairs->y1 + idx);
+        lane_f64 distance_lo = haversine_lane_f64_units(lane_f64_from_i32_lo(x0), lane_f64_from_i32_lo(y0),
+                                                        lane_f64_from_i32_lo(x1), lane_f64_from_i32_lo(y1),
+                                                        radius, q32_to_radians);
+        lane_f64 distance_hi = haversine_lane_f64_units(lane_f64_from_i32_hi(x0), lane_f64_from_i32_hi(y0),
+                                                        lane_f64_from_i32_hi(x1), lane_f64_from_i32_hi(y1),
+                                                        radius, q32_to_radians);
+        sum = lane_f64_add(sum, lane_f64_add(distance_lo, distance_hi));
+        if(out) {
+            lane_f64_store(out + idx, distance_lo);
+            lane_f64_store(out + idx + LANE_F64_WIDTH, distance_hi);
+        }
+    }
+
+    return lane_f64_hsum(sum);
+}
+
+internal THREAD_PROC(haversine_slice_worker) {
+    haversine_slice *slice = (haversine_slice *)param;
+    if(slice->fixed.x0) slice->sum = haversine_sum_q32(&slice->fixed, slice->earth_radius, NULL);
+    else slice->sum = haversine_sum_f64(&slice->pairs, slice->earth_radius, NULL);
+
+    return 0;
+}
+
+/* NOTE(abid): The batch kernel split into one contiguous slice per thread, the calling thread
+ * takes the first. Slices start on `PAIRS_PADDING` boundaries so every slice but the last is whole
+ * and the last one ends in the columns' own padding. Slices are summed in order, the result only
+ * depends on the thread count by the rounding of that final sum. Exactly one of `pairs`/`fixed`. */
+internal f64
+haversine_sum_parallel(pairs_f64 *pairs, pairs_q32 *fixed, f64 earth_radius, u32 thread_count) {
+    u64 count = pairs ? pairs->count : fixed->count;
+    u64 blocks = pairs_padded_count(count)/PAIRS_PADDING;
+    if(thread_count > blocks) thread_count = blocks ? (u32)blocks : 1;
+    if(thread_count <= 1) {
+        return pairs ? haversine_sum_f64(pairs, earth_radius, NULL) : haversine_sum_q32(fixed, earth_radius, NULL);
+    }
+
+    haversine_slice *slices = malloc(thread_count*sizeof(haversine_slice));
+    platform_thread *threads = malloc(thread_count*sizeof(platform_thread));
+    for(u32 idx = 0; idx < thread_count; ++idx) {
+        u64 first = blocks*idx/thread_count*PAIRS_PADDING;
+        u64 end = (idx + 1 == thread_count) ? count : blocks*(idx + 1)/thread_count*PAIRS_PADDING;
+        slices[idx] = (haversine_slice) { .earth_radius = earth_radius };
+        if(pairs) {
+            slices[idx].pairs = (pairs_f64) {
+                .count = end - first,
+                .x0 = pairs->x0 + first, .y0 = pairs->y0 + first,
+                .x1 = pairs->x1 + first, .y1 = pairs->y1 + first,
+            };
+        } else {
+            slices[idx].fixed = (pairs_q32) {
+                .count = end - first,
+                .x0 = fixed->x0 + first, .y0 = fixed->y0 + first,
+                .x1 = fixed->x1 + first, .y1 = fixed->y1 + first,
+            };
+        }
+        if(idx) threads[idx] = platform_thread_create(haversine_slice_worker, slices + idx);
+    }
+    haversine_slice_worker(slices);
+
+    f64 result = slices[0].sum;
+    for(u32 idx = 1; idx < thread_count; ++idx) {
+        platform_thread_join(threads[idx]);
+        result += slices[idx].sum;
+    }
+    free(threads);
+    free(slices);
+
+    return result;
+}
+
+inline internal f64
+haversine_sum_f64_parallel(pairs_f64 *pairs, f64 earth_radius, u32 thread_count) {
+    return haversine_sum_parallel(pairs, NULL, earth_radius, thread_count);
+}
+
+inline internal f64
+haversine_sum_q32_parallel(pairs_q32 *pairs, f64 earth_radius, u32 thread_count) {
+    return haversine_sum_parallel(NULL, pairs, earth_radius, thread_count);
+}
+
+/* NOTE(abid): Compare computed distances against the reference answers (the .f64 file). */
+internal precision_report
+haversine_precision_report(f64 *computed, f64 *reference, u64 count) {
+    precision_report report = { .count = count };
+    if(count == 0) return report;
+
+    f64 abs_error_sum = 0;
+    f64 computed_sum = 0;
+    f64 reference_sum = 0;
+    for(u64 idx = 0; idx < count; ++idx) {
+        f64 abs_error = fabs(computed[idx] - reference[idx]);
+        if(abs_error > report.max_abs_error) {
+            report.max_abs_error = abs_error;
+            report.max_abs_error_idx = idx;
+        }
+        if(reference[idx] != 0.0) {
+            f64 rel_error = abs_error / fabs(reference[idx]);
+            if(rel_error > report.max_rel_error) report.max_rel_error = rel_error;
+        }
+        abs_error_sum += abs_error;
+        computed_sum += computed[idx];
+        reference_sum += reference[idx];
+    }
+    report.mean_abs_error = abs_error_sum / (f64)count;
+    report.computed_average = computed_sum / (f64)count;
+    report.reference_average = reference_sum / (f64)count;
+    if(report.reference_average != 0.0) {
+        report.average_rel_error = fabs(report.computed_average - report.reference_average) /
+                                   fabs(report.reference_average);
+    }
+
+    return report;
+}
+
+internal void
+precision_report_print(precision_report *report, pair_precision precision) {
+    printf("Precision report [%s] over %llu pairs:\n", pair_precision_str[precision], report->count);
+    printf("  Max abs error: %.6e (pair %llu)\n", report->max_abs_error, report->max_abs_error_idx);
+    printf("  Mean abs error: %.6e\n", report->mean_abs_error);
+    printf("  Max rel error: %.6e\n", report->max_rel_error);
+    printf("  Average: %.12f (reference %.12f, rel error %.6e)\n",
+           report->computed_average, report->reference_average, report->average_rel_error);
+}
+
+/* NOTE(abid): Maps doubles onto integers that are ordered the same way, so the difference of two
+ * of them is their distance in ULPs (+0 and -0 land on the same value). */
+inline internal u64
+f64_ordered_bits(f64 value) {
+    u64 bits;
+    memcpy(&bits, &value, sizeof(bits));
+    u64 sign_mask = 0x8000000000000000ULL;
+    return (bits & sign_mask) ? sign_mask - (bits & ~sign_mask) : sign_mask + bits;
+}
+
+inline internal u64
+f64_ulp_distance(f64 a, f64 b) {
+    if(a != a || b != b) return (u64)-1;
+    u64 ordered_a = f64_ordered_bits(a);
+    u64 ordered_b = f64_ordered_bits(b);
+    return (ordered_a > ordered_b) ? ordered_a - ordered_b : ordered_b - ordered_a;
+}
+
+/* NOTE(abid): Distances are computed VERIFY_BATCH pairs at a time with the lane kernel and compared
+ * right away while the batch is still in L1. Only pairs further than `ulp_print_threshold` ULPs
+ * from the reference get printed (at most VERIFY_PRINT_LIMIT of them). */
+internal verify_report
+haversine_verify_answers(pairs_f64 *pairs, f64 *reference, u64 ulp_print_threshold) {
+    verify_report report = { .count = pairs->count };
+    f64 computed[VERIFY_BATCH];
+
+    for(u64 batch_start = 0; batch_start < pairs->count; batch_start += VERIFY_BATCH) {
+        u64 batch_count = pairs->count - batch_start;
+        if(batch_count > VERIFY_BATCH) batch_count = VERIFY_BATCH;
+        pairs_f64 batch = {
+            .count = batch_count,
+            .x0 = pairs->x0 + batch_start,
+            .y0 = pairs->y0 + batch_start,
+            .x1 = pairs->x1 + batch_start,
+            .y1 = pairs->y1 + batch_start,
+        };
+        haversine_sum_f64(&batch, EARTH_RAIDUS, computed);
+
+        f64 *batch_reference = reference + batch_start;
+        for(u64 idx = 0; idx < batch_count; ++idx) {
+            u64 ulp = f64_ulp_distance(computed[idx], batch_reference[idx]);
+            u32 bucket = 0;
+            for(u64 remaining = ulp; remaining && bucket < ULP_HISTOGRAM_BUCKETS - 1; remaining >>= 1) ++bucket;
+            ++report.ulp_histogram[bucket];
+
+            if(ulp > report.max_ulp) {
+                report.max_ulp = ulp;
+                report.worst_idx = batch_start + idx;
+                report.max_abs_error = fabs(computed[idx] - batch_reference[idx]);
+            }
+            if(ulp > ulp_print_threshold) {
+                if(report.over_threshold < VERIFY_PRINT_LIMIT) {
+                    printf("%llu. stored = %.17g, calculated = %.17g, ulp = %llu\n",
+                           batch_start + idx, batch_reference[idx], computed[idx], ulp);
+                }
+                ++report.over_threshold;
+            }
+        }
+    }
+
+    return report;
+}
+
+internal void
+verify_report_print(verify_report *report, u64 ulp_print_threshold) {
+    printf("Verified %llu pairs:\n", report->count);
+    printf("  Worst pair: %llu (%llu ulp, abs error %.6e)\n",
+           report->worst_idx, report->max_ulp, report->max_abs_error);
+    printf("  Over %llu ulp: %llu", ulp_print_threshold, report->over_threshold);
+    if(report->over_threshold > VERIFY_PRINT_LIMIT) printf(" (first %d printed)", VERIFY_PRINT_LIMIT);
+    printf("\n  ULP histogram:\n");
+    for(u32 bucket = 0; bucket < ULP_HISTOGRAM_BUCKETS; ++bucket) {
+        if(report->ulp_histogram[bucket] == 0) continue;
+        f64 percent = 100.0*(f64)report->ulp_histogram[bucket]/(f64)report->count;
+        if(bucket == 0) printf("    %20s: %llu (%.3f%%)\n", "0", report->ulp_histogram[bucket], percent);
+        else if(bucket == ULP_HISTOGRAM_BUCKETS - 1) {
+            printf("    %19s%llu: %llu (%.3f%%)\n", ">= ", 1ULL << (bucket - 1), report->ulp_histogram[bucket], percent);
+        } else {
+            char range[32];
+            snprintf(range, sizeof(range), "[%llu, %llu]", 1ULL << (bucket - 1), (1ULL << bucket) - 1);
+            printf("    %20s: %llu (%.3f%%)\n", range, report->ulp_histogram[bucket], percent);
+        }
+    }
+}
+
+/* NOTE(abid): `precision` is FLOAT_FORMAT_SHORTEST or a fixed decimal count, writes at most
+ * GENERATOR_MAX_PAIR_LEN chars. */
+internal usize
+generator_format_pair(char *dest, f64 y0, f64 y1, f64 x0, f64 x1, u32 precision, bool is_last) {
+    char *start = dest;
+
+    memcpy(dest, "\t{\"x0\":", 7); dest += 7;
+    dest += f64_format(dest, x0, precision);
+    memcpy(dest, ", \"y0\":", 7); dest += 7;
+    dest += f64_format(dest, y0, precision);
+    memcpy(dest, ", \"x1\":", 7); dest += 7;
+    dest += f64_format(dest, x1, precision);
+    memcpy(dest, ", \"y1\":", 7); dest += 7;
+    dest += f64_format(dest, y1, precision);
     if(is_last) {
-        snprintf(arena_current(json_arena), suffix_len+1, /* suffix = */ "\n]}");
-        arena_advance(json_arena, suffix_len, char);
+        memcpy(dest, "}\n]}", 4); dest += 4;
     } else {
-        snprintf(arena_current(json_arena), 3, ",\n");
-        arena_advance(json_arena, 2, char);
+        memcpy(dest, "},\n", 3); dest += 3;
     }
 
-    /* NOTE(abid): Save the result to buffer and .f64 file. */
-    f64 *dest = arena_current(result_arena);
-    *dest = haversine(x0, y0, x1, y1, EARTH_RAIDUS);
-    arena_advance(result_arena, 1, f64);
+    return dest - start;
+}
+
+/* NOTE(abid): The generator. Box datasets and their answers are the same for a seed whatever the
+ * target ISA, gaussian and sphere ones only per ISA (see generator_gaussian_from_unit). */
+FP_CONTRACT_OFF_BEGIN
+
+/* NOTE(abid): Snap to the q32 grid if requested, the snapped value is what gets written, summed
+ * and used for the reference answer. */
+inline internal f64
+generator_coord(f64 degrees, generator_config *config) {
+    if(config->quantize_q32) return coord_degrees_from_q32(coord_q32_from_degrees(degrees));
+    return degrees;
+}
+
+/* NOTE(abid): In place Box-Muller, `u1` and `u2` hold `count` uniform [0, 1) draws each and come
+ * out as `2*count` independent standard normal draws. A partial last lane goes through a temporary,
+ * so every value is computed by the same lane code. That code (log, sin, cos here, asin for the
+ * sphere) uses FMA where the build has it, so these draws differ in the last bits between ISAs. */
+internal void
+generator_gaussian_from_unit(f64 *u1, f64 *u2, u64 count) {
+    lane_f64 one = lane_f64_set1(1.0);
+    lane_f64 minus_two = lane_f64_set1(-2.0);
+    lane_f64 two_pi = lane_f64_set1(4.0*F64_HALF_PI);
+    for(u64 idx = 0; idx < count; idx += LANE_F64_WIDTH) {
+        f64 tail1[LANE_F64_WIDTH], tail2[LANE_F64_WIDTH];
+        f64 *a = u1 + idx;
+        f64 *b = u2 + idx;
+        u64 lanes = (count - idx < LANE_F64_WIDTH) ? count - idx : LANE_F64_WIDTH;
+        if(lanes < LANE_F64_WIDTH) {
+            for(u64 lane = 0; lane < LANE_F64_WIDTH; ++lane) {
+                tail1[lane] = (lane < lanes) ? a[lane] : 0.5;
+                tail2[lane] = (lane < lanes) ? b[lane] : 0.5;
+            }
+            a = tail1;
+            b = tail2;
+        }
+
+        /* NOTE(abid): 1 - u is in (0, 1], log never sees a zero. */
+        lane_f64 radius = lane_f64_sqrt(lane_f64_mul(minus_two, lane_f64_log(lane_f64_sub(one, lane_f64_load(a)))));
+        lane_f64 angle = lane_f64_mul(two_pi, lane_f64_load(b));
+        lane_f64_store(a, lane_f64_mul(radius, lane_f64_cos(angle)));
+        lane_f64_store(b, lane_f64_mul(radius, lane_f64_sin(angle)));
 
-    /* NOTE(abid): If end of buffer, or we are out of memory for next round, then flush. */
-    if(result_arena->used >= result_arena->size || is_last) {
-        FILE *file_handle = fopen(f64_filename, "ab");
-        assert(file_handle, "cannot save to .f64 file.");
-        fwrite(result_arena->ptr, sizeof(f64), result_arena->used/sizeof(f64), file_handle);
-        fclose(file_handle);
-        result_arena->used = 0;
+        if(lanes < LANE_F64_WIDTH) {
+            memcpy(u1 + idx, tail1, lanes*sizeof(f64));
+            memcpy(u2 + idx, tail2, lanes*sizeof(f64));
+        }
     }
+}
+
+/* NOTE(abid): In place, uniform [0, 1) draws to area uniform latitudes in degrees. */
+internal void
+generator_latitude_from_unit(f64 *unit, u64 count) {
+    lane_f64 one = lane_f64_set1(1.0);
+    lane_f64 two = lane_f64_set1(2.0);
+    lane_f64 to_degrees = lane_f64_set1(90.0/F64_HALF_PI);
+    for(u64 idx = 0; idx < count; idx += LANE_F64_WIDTH) {
+        f64 tail[LANE_F64_WIDTH];
+        f64 *a = unit + idx;
+        u64 lanes = (count - idx < LANE_F64_WIDTH) ? count - idx : LANE_F64_WIDTH;
+        if(lanes < LANE_F64_WIDTH) {
+            for(u64 lane = 0; lane < LANE_F64_WIDTH; ++lane) tail[lane] = (lane < lanes) ? a[lane] : 0.5;
+            a = tail;
+        }
+
+        lane_f64 sine = lane_f64_sub(lane_f64_mul(two, lane_f64_load(a)), one);
+        lane_f64_store(a, lane_f64_mul(lane_f64_asin(sine), to_degrees));
 
-    /* NOTE(abid): If end of buffer, or we are out of memory for next round, then flush. */
-    if((json_arena->used + num_chars_per_pair + suffix_len + 1 >= json_arena->size) || is_last) {
-        FILE *file_handle = fopen(json_filename, "ab");
-        assert(file_handle, "cannot save to .json file.");
-        fputs(json_arena->ptr, file_handle);
-        fclose(file_handle);
-        json_arena->used = 0;
+        if(lanes < LANE_F64_WIDTH) memcpy(unit + idx, tail, lanes*sizeof(f64));
     }
 }
 
-internal stat_f64
-generate_haversine_json(u64 number_pairs, u64 num_clusters, char *filename) {
-    mem_arena *temp_arena = arena_create(kilobyte(1), gigabyte(10));
-    mem_arena *json_arena = arena_create(megabyte(1), terabyte(10));
-    mem_arena *result_arena = arena_create(megabyte(1), terabyte(10));
+/* NOTE(abid): Brings a gaussian draw back on the globe, past a pole the point comes down the other
+ * side (half a turn of longitude away). */
+inline internal void
+generator_wrap(f64 *lat, f64 *lon) {
+    if(*lat > 90.0) {
+        *lat = 180.0 - *lat;
+        *lon += 180.0;
+    } else if(*lat < -90.0) {
+        *lat = -180.0 - *lat;
+        *lon += 180.0;
+    }
+    *lon -= 360.0*floor((*lon + 180.0)/360.0);
+}
 
-    stat_f64 haversine_stat = {0};
+inline internal u64
+generator_shard_pair_end(generator_job *job, u32 shard) {
+    u64 pair_end = job->shard_first_chunk[shard + 1]*GENERATOR_CHUNK_PAIRS;
+    return (pair_end < job->config->number_pairs) ? pair_end : job->config->number_pairs;
+}
+
+inline internal void
+generator_json_write(generator_job *job, void *data, usize size) {
+    file_writer_write(job->json_writer, data, size);
+    stream_checksum_update(&job->json_checksum, data, size);
+}
+
+/* NOTE(abid): Files are truncated, a rerun overwrites the previous shard. */
+internal void
+generator_shard_open(generator_job *job, u32 shard) {
+    generator_config *config = job->config;
+    shard_entry *entry = job->shards + shard;
+    entry->first_pair = job->shard_first_chunk[shard]*GENERATOR_CHUNK_PAIRS;
+    entry->count = generator_shard_pair_end(job, shard) - entry->first_pair;
+
+    char *json_filename = shard_filename(config->filename, config->shard_count, shard, ".json");
+    char *f64_filename = shard_filename(config->filename, config->shard_count, shard, ".f64");
+    char *pairs_filename = shard_filename(config->filename, config->shard_count, shard, ".pairs");
+    job->json_writer = file_writer_open(json_filename, config->output_mode);
+    job->f64_writer = file_writer_open(f64_filename, config->output_mode);
+    job->pairs_writer = pairs_file_create(pairs_filename, entry->count, pairs_padded_count(entry->count), config->seed,
+                                          config->num_clusters, config->quantize_q32 ? PAIRS_FILE_FLAG_QUANTIZED_Q32 : 0);
+    job->json_checksum = stream_checksum_init();
+    job->f64_checksum = stream_checksum_init();
+    free(json_filename);
+    free(f64_filename);
+    free(pairs_filename);
+
+    char *prefix = "{\"pairs\":[\n";
+    generator_json_write(job, prefix, strlen(prefix));
+    if(entry->count == 0) generator_json_write(job, "]}", 2);
+}
 
-    u64 filename_len = strlen(filename); // Yes, I ain't using strlen
-    char *json_extension = ".json";
-    char *f64_extension = ".f64";
-    u64 json_extension_len = strlen(json_extension);
-    u64 f64_extension_len = strlen(f64_extension);
-    char *json_filename = push_size(filename_len + json_extension_len + 1, temp_arena);
-    char *f64_filename = push_size(filename_len + f64_extension_len + 1, temp_arena);
+internal void
+generator_shard_close(generator_job *job, u32 shard) {
+    generator_config *config = job->config;
+    shard_entry *entry = job->shards + shard;
+    entry->json_bytes = file_writer_close(job->json_writer);
+    entry->json_checksum = stream_checksum_finalize(&job->json_checksum);
+    entry->f64_bytes = file_writer_close(job->f64_writer);
+    entry->f64_checksum = stream_checksum_finalize(&job->f64_checksum);
+    entry->pairs_checksum = pairs_file_close(job->pairs_writer);
+
+    char *pairs_filename = shard_filename(config->filename, config->shard_count, shard, ".pairs");
+    entry->pairs_bytes = platform_file_64bit_get_size(pairs_filename);
+    free(pairs_filename);
+}
 
-    for(u64 Idx = 0; Idx < filename_len; ++Idx) {
-        json_filename[Idx] = filename[Idx];
-        f64_filename[Idx] = filename[Idx];
+/* NOTE(abid): Appends a finished chunk to its shard, only called on the chunk's turn. The shard's
+ * expected sum is accumulated in chunk order, so it is as deterministic as the files. */
+internal void
+generator_write_chunk(generator_job *job, u64 chunk, char *json, usize json_size, f64 *answers, void **columns,
+                      u64 chunk_pairs) {
+    u32 shard = job->current_shard;
+    if(chunk == job->shard_first_chunk[shard]) generator_shard_open(job, shard);
+
+    generator_json_write(job, json, json_size);
+    file_writer_write(job->f64_writer, answers, chunk_pairs*sizeof(f64));
+    stream_checksum_update(&job->f64_checksum, answers, chunk_pairs*sizeof(f64));
+    pairs_file_append(job->pairs_writer, columns, chunk_pairs);
+    for(u64 idx = 0; idx < chunk_pairs; ++idx) job->shards[shard].expected_sum += answers[idx];
+
+    if(chunk + 1 == job->shard_first_chunk[shard + 1]) {
+        generator_shard_close(job, shard);
+        ++job->current_shard;
     }
-    for(u64 Idx = 0; Idx < json_extension_len; ++Idx) json_filename[filename_len+Idx] = json_extension[Idx];
-    json_filename[json_extension_len + filename_len] = '\0';
-    for(u64 idx = 0; idx < f64_extension_len; ++idx) f64_filename[filename_len+idx] = f64_extension[idx];
-    f64_filename[f64_extension_len + filename_len] = '\0';
+}
 
+internal THREAD_PROC(generator_worker) {
+    generator_job *job = (generator_job *)param;
+    generator_config *config = job->config;
+    u64 number_pairs = config->number_pairs;
 
-    /* NOTE(abid): Alignment to the 8 bytes of f64. */
-    usize alignment = sizeof(f64);
-    assert(result_arena->size >= 2*sizeof(f64)*alignment, "minimum size requirement for result buffer not met.");
-    usize alignment_mask = alignment - 1;
-    if((usize)result_arena->ptr & alignment_mask) {
-        usize aligment_offset = alignment - ((usize)result_arena->ptr & alignment_mask);
-        result_arena->ptr = (void *)((usize)result_arena->ptr + aligment_offset);
-        result_arena->size -= sizeof(f64);
+    char *json_chunk = malloc(GENERATOR_CHUNK_PAIRS*GENERATOR_MAX_PAIR_LEN);
+    f64 *f64_chunk = malloc(GENERATOR_CHUNK_PAIRS*sizeof(f64));
+    f64 *unit_chunk = malloc(4*GENERATOR_CHUNK_PAIRS*sizeof(f64));
+    f64 *column_chunk = malloc(PAIRS_FILE_COLUMNS*GENERATOR_CHUNK_PAIRS*sizeof(f64));
+    f64 *columns[PAIRS_FILE_COLUMNS];
+    for(u32 column = 0; column < PAIRS_FILE_COLUMNS; ++column) columns[column] = column_chunk + column*GENERATOR_CHUNK_PAIRS;
+    /* NOTE(abid): What goes to the .pairs file, the f64 columns or their i32 grid values. */
+    i32 *fixed_chunk = config->quantize_q32 ? malloc(PAIRS_FILE_COLUMNS*GENERATOR_CHUNK_PAIRS*sizeof(i32)) : NULL;
+    void *file_columns[PAIRS_FILE_COLUMNS];
+    for(u32 column = 0; column < PAIRS_FILE_COLUMNS; ++column) {
+        file_columns[column] = fixed_chunk ? (void *)(fixed_chunk + column*GENERATOR_CHUNK_PAIRS) : columns[column];
     }
 
-    char *prefix = "{\"pairs\":[\n";
-    u64 prefix_len = 11;
-    for(; json_arena->used < prefix_len; arena_advance(json_arena, 1, char)) {
-        char *dest = arena_current(json_arena);
-        *dest = prefix[json_arena->used];
+    while(true) {
+        u64 chunk = platform_atomic_add_u64(&job->next_chunk, 1);
+        if(chunk >= job->end_chunk) break;
+
+        u64 pair_start = chunk*GENERATOR_CHUNK_PAIRS;
+        u64 pair_end = pair_start + GENERATOR_CHUNK_PAIRS;
+        if(pair_end > number_pairs) pair_end = number_pairs;
+        /* NOTE(abid): The last pair of a shard closes its JSON document. */
+        u32 shard = 0;
+        while(chunk >= job->shard_first_chunk[shard + 1]) ++shard;
+        u64 shard_pair_end = generator_shard_pair_end(job, shard);
+
+        /* NOTE(abid): Four unit draws per pair. Box keeps them interleaved (lat1, lat2, lon1, lon2)
+         * and scales them to the cluster, gaussian and sphere transform them in bulk first, the
+         * latitudes are the first half (lat1, lat2 per pair) and the longitudes the second. */
+        u64 chunk_pairs = pair_end - pair_start;
+        f64 *lat_unit = unit_chunk;
+        f64 *lon_unit = unit_chunk + 2*chunk_pairs;
+        TIME_BANDWIDTH("generator draw", 4*chunk_pairs*sizeof(f64)) {
+            rand_batch_state random;
+            rand_batch_seed(&random, config->seed, chunk + 1);
+            rand_fill_f64(&random, unit_chunk, 4*chunk_pairs, 0.0, 1.0);
+            if(config->distribution == gd_gaussian) generator_gaussian_from_unit(lat_unit, lon_unit, 2*chunk_pairs);
+            else if(config->distribution == gd_sphere) generator_latitude_from_unit(lat_unit, 2*chunk_pairs);
+        }
+
+        stat_f64 *chunk_stat = job->chunk_stats + chunk;
+        usize json_used = 0;
+        TIME_BLOCK("generator format")
+        for(u64 pair_idx = pair_start; pair_idx < pair_end; ++pair_idx) {
+            u64 cluster_idx = pair_idx/job->pairs_per_cluster;
+            if(cluster_idx >= job->cluster_count) {
+                assert(pair_idx >= (job->cluster_count - 1)*job->pairs_per_cluster, "pair %llu is past the clusters.",
+                       pair_idx);
+                cluster_idx = job->cluster_count - 1;
+            }
+            generator_cluster *cluster = job->clusters + cluster_idx;
+            u64 local_idx = pair_idx - pair_start;
+            f64 lat1, lat2, lon1, lon2;
+            switch(config->distribution) {
+                case gd_box: {
+                    f64 *unit = unit_chunk + 4*local_idx;
+                    lat1 = cluster->lat0_start + unit[0]*cluster->lat0_size;
+                    lat2 = cluster->lat1_start + unit[1]*cluster->lat1_size;
+                    lon1 = cluster->lon0_start + unit[2]*cluster->lon0_size;
+                    lon2 = cluster->lon1_start + unit[3]*cluster->lon1_size;
+                } break;
+                case gd_gaussian: {
+                    f64 *lat_normal = lat_unit + 2*local_idx;
+                    f64 *lon_normal = lon_unit + 2*local_idx;
+                    lat1 = cluster->lat0_start + cluster->lat0_size*(0.5 + lat_normal[0]/6.0);
+                    lat2 = cluster->lat1_start + cluster->lat1_size*(0.5 + lat_normal[1]/6.0);
+                    lon1 = cluster->lon0_start + cluster->lon0_size*(0.5 + lon_normal[0]/6.0);
+                    lon2 = cluster->lon1_start + cluster->lon1_size*(0.5 + lon_normal[1]/6.0);
+                    generator_wrap(&lat1, &lon1);
+                    generator_wrap(&lat2, &lon2);
+                } break;
+                case gd_sphere: {
+                    lat1 = lat_unit[2*local_idx];
+                    lat2 = lat_unit[2*local_idx + 1];
+                    lon1 = -180.0 + 360.0*lon_unit[2*local_idx];
+                    lon2 = -180.0 + 360.0*lon_unit[2*local_idx + 1];
+                } break;
+                default: assert(0, "invalid code path");
+            }
+            lat1 = generator_coord(lat1, config);
+            lat2 = generator_coord(lat2, config);
+            lon1 = generator_coord(lon1, config);
+            lon2 = generator_coord(lon2, config);
+            json_used += generator_format_pair(json_chunk + json_used, lat1, lat2, lon1, lon2,
+                                               job->precision, pair_idx + 1 == shard_pair_end);
+            u64 chunk_idx = pair_idx - pair_start;
+            f64_chunk[chunk_idx] = haversine(lon1, lat1, lon2, lat2, EARTH_RAIDUS);
+            columns[0][chunk_idx] = lon1;
+            columns[1][chunk_idx] = lat1;
+            columns[2][chunk_idx] = lon2;
+            columns[3][chunk_idx] = lat2;
+        }
+        /* NOTE(abid): The coordinate stats in bulk over the columns instead of four per pair. */
+        TIME_BANDWIDTH("generator stats", PAIRS_FILE_COLUMNS*chunk_pairs*sizeof(f64)) {
+            for(u32 column = 0; column < PAIRS_FILE_COLUMNS; ++column) {
+                stat_f64_accumulate_bulk(columns[column], chunk_pairs, chunk_stat);
+            }
+        }
+        if(fixed_chunk) {
+            for(u32 column = 0; column < PAIRS_FILE_COLUMNS; ++column) {
+                i32 *fixed = file_columns[column];
+                for(u64 idx = 0; idx < chunk_pairs; ++idx) fixed[idx] = coord_q32_from_degrees(columns[column][idx]);
+            }
+        }
+
+        /* NOTE(abid): Chunks are claimed in order, so whoever holds the chunk we wait on is never
+         * waiting itself. */
+        TIME_BLOCK("generator wait") {
+            while(platform_atomic_load_u64(&job->next_chunk_to_write) != chunk) platform_thread_yield();
+        }
+        TIME_BANDWIDTH("generator write", json_used + chunk_pairs*(sizeof(f64) + PAIRS_FILE_COLUMNS*
+                                                                   (fixed_chunk ? sizeof(i32) : sizeof(f64)))) {
+            generator_write_chunk(job, chunk, json_chunk, json_used, f64_chunk, file_columns, chunk_pairs);
+        }
+        platform_atomic_add_u64(&job->next_chunk_to_write, 1);
+    }
+
+    free(json_chunk);
+    free(f64_chunk);
+    free(unit_chunk);
+    free(column_chunk);
+    free(fixed_chunk);
+
+    return 0;
+}
+
+internal stat_f64
+generate_haversine_json(generator_config *config) {
+    u64 number_pairs = config->number_pairs;
+    u64 num_clusters = config->num_clusters;
+    char *filename = config->filename;
+
+    mem_arena *temp_arena = arena_create(kilobyte(1), gigabyte(10));
+
+    /* NOTE(abid): An empty dataset is still one (empty) chunk, so its files get written. */
+    generator_job job = {
+        .config = config,
+        /* NOTE(abid): Shortest round-trip digits, grid coordinates have at most 7 decimals anyway. */
+        .precision = config->quantize_q32 ? 7 : FLOAT_FORMAT_SHORTEST,
+        .chunk_count = number_pairs ? (number_pairs + GENERATOR_CHUNK_PAIRS - 1)/GENERATOR_CHUNK_PAIRS : 1,
+    };
+
+    job.shard_count = config->shard_count ? config->shard_count : 1;
+    if(job.shard_count > job.chunk_count) job.shard_count = (u32)job.chunk_count;
+    job.shard_first_chunk = push_array(u64, job.shard_count + 1, temp_arena);
+    for(u32 shard = 0; shard <= job.shard_count; ++shard) {
+        job.shard_first_chunk[shard] = shard_first_chunk(job.chunk_count, job.shard_count, shard);
     }
+    job.shards = push_array(shard_entry, job.shard_count, temp_arena);
+    memset(job.shards, 0, job.shard_count*sizeof(shard_entry));
+    job.end_chunk = job.chunk_count;
+    if(config->regenerate_one) {
+        assert(config->shard_count && config->regenerate_shard < job.shard_count, "no shard %u to regenerate.",
+               config->regenerate_shard);
+        job.current_shard = config->regenerate_shard;
+        job.first_chunk = job.shard_first_chunk[job.current_shard];
+        job.end_chunk = job.shard_first_chunk[job.current_shard + 1];
+    }
+    job.next_chunk = job.first_chunk;
+    job.next_chunk_to_write = job.first_chunk;
 
+    /* NOTE(abid): Uniform generation is a single cluster covering the globe (the sphere distribution
+     * always is). Clustered generation splits the pairs evenly, a remainder gets a cluster of its own
+     * (which can hold more pairs than the others, as before). */
+    if(num_clusters > number_pairs) num_clusters = number_pairs;
+    if(config->distribution == gd_sphere) num_clusters = 0;
     if(num_clusters) {
-        // NumClusters = (NumClusters) ? NumClusters : RandRangeU64(20, 300);
-        u64 num_pair_per_cluster = (u64)(number_pairs / num_clusters);
-        u64 pair_remainder = number_pairs % num_clusters;
-        if(pair_remainder) ++num_clusters;
-        for(u64 cluster_idx = 0; cluster_idx < num_clusters; cluster_idx++) {
-            f64 lat1_size = rand_range_f64(10., 100.);
-            f64 lon1_size = rand_range_f64(20., 200.);
-            f64 lat1_start = rand_range_f64(-90., 90. - lat1_size);
-            f64 lon1_start = rand_range_f64(-180., 180. - lon1_size);
-
-            f64 lat2_size = rand_range_f64(10., 100.);
-            f64 lon2_size = rand_range_f64(20., 200.);
-            f64 lat2_start = rand_range_f64(-90., 90. - lat2_size);
-            f64 lon2_start = rand_range_f64(-180., 180. - lon2_size);
-
-            /* NOTE(abid): In case we have remainders left. */
-            u64 num_to_generate = ((cluster_idx == num_clusters-1) && pair_remainder) ? pair_remainder
-                                                                                      : num_pair_per_cluster;
-            for(u64 pair_idx = 0; pair_idx < num_to_generate; pair_idx++) {
-                f64 lat1 = rand_range_f64(lat1_start, lat1_start+lat1_size);
-                f64 lat2 = rand_range_f64(lat2_start, lat2_start+lat2_size);
-                f64 lon1 = rand_range_f64(lon1_start, lon1_start+lon1_size);
-                f64 lon2 = rand_range_f64(lon2_start, lon2_start+lon2_size);
-                stat_f64_accumulate(lat1, &haversine_stat);
-                stat_f64_accumulate(lat2, &haversine_stat);
-                stat_f64_accumulate(lon1, &haversine_stat);
-                stat_f64_accumulate(lon2, &haversine_stat);
-                offload_to_buffer(
-                    json_arena, result_arena, lat1, lat2, lon1, lon2,
-                    cluster_idx*num_pair_per_cluster + pair_idx + 1 == number_pairs,
-                    json_filename, f64_filename
-                );
-            }
+        job.pairs_per_cluster = number_pairs/num_clusters;
+        if(number_pairs % num_clusters) ++num_clusters;
+        job.cluster_count = num_clusters;
+        job.clusters = push_array(generator_cluster, num_clusters, temp_arena);
+
+        rand_stream stream = rand_stream_create(config->seed, 0);
+        for(u64 cluster_idx = 0; cluster_idx < num_clusters; ++cluster_idx) {
+            generator_cluster *cluster = job.clusters + cluster_idx;
+            cluster->lat0_size = rand_stream_range_f64(&stream, 10., 100.);
+            cluster->lon0_size = rand_stream_range_f64(&stream, 20., 200.);
+            cluster->lat0_start = rand_stream_range_f64(&stream, -90., 90. - cluster->lat0_size);
+            cluster->lon0_start = rand_stream_range_f64(&stream, -180., 180. - cluster->lon0_size);
+
+            cluster->lat1_size = rand_stream_range_f64(&stream, 10., 100.);
+            cluster->lon1_size = rand_stream_range_f64(&stream, 20., 200.);
+            cluster->lat1_start = rand_stream_range_f64(&stream, -90., 90. - cluster->lat1_size);
+            cluster->lon1_start = rand_stream_range_f64(&stream, -180., 180. - cluster->lon1_size);
         }
     } else {
-        for(u64 idx = 0; idx < number_pairs; idx++) {
-            f64 lat1 = rand_range_f64(-90., 90.);
-            f64 lat2 = rand_range_f64(-90., 90.);
-            f64 lon1 = rand_range_f64(-180., 180.);
-            f64 lon2 = rand_range_f64(-180., 180.);
-            stat_f64_accumulate(lat1, &haversine_stat);
-            stat_f64_accumulate(lat2, &haversine_stat);
-            stat_f64_accumulate(lon1, &haversine_stat);
-            stat_f64_accumulate(lon2, &haversine_stat);
+        job.pairs_per_cluster = number_pairs ? number_pairs : 1;
+        job.cluster_count = 1;
+        job.clusters = push_struct(generator_cluster, temp_arena);
+        *job.clusters = (generator_cluster) {
+            .lat0_start = -90., .lat0_size = 180., .lon0_start = -180., .lon0_size = 360.,
+            .lat1_start = -90., .lat1_size = 180., .lon1_start = -180., .lon1_size = 360.,
+        };
+    }
+    job.chunk_stats = push_array(stat_f64, job.chunk_count, temp_arena);
+    memset(job.chunk_stats, 0, job.chunk_count*sizeof(stat_f64));
 
-            offload_to_buffer(
-                json_arena, result_arena, lat1, lat2, lon1, lon2,
-                idx+1 == number_pairs, json_filename, f64_filename
-            );
-        }
+    /* NOTE(abid): The calling thread is worker zero. */
+    u32 thread_count = config->thread_count ? config->thread_count : platform_cpu_count();
+    if(thread_count > job.end_chunk - job.first_chunk) thread_count = (u32)(job.end_chunk - job.first_chunk);
+    platform_thread *threads = malloc(sizeof(platform_thread)*thread_count);
+    TIME_FUNCTION {
+        for(u32 idx = 0; idx < thread_count - 1; ++idx) threads[idx] = platform_thread_create(generator_worker, &job);
+        generator_worker(&job);
+        for(u32 idx = 0; idx < thread_count - 1; ++idx) platform_thread_join(threads[idx]);
     }
+    free(threads);
+
+    if(config->shard_count && !config->regenerate_one) {
+        shard_manifest manifest = {
+            .number_pairs = number_pairs,
+            .seed = config->seed,
+            .num_clusters = config->num_clusters,
+            .distribution = config->distribution,
+            .quantize_q32 = config->quantize_q32,
+            .shard_count = job.shard_count,
+            .shards = job.shards,
+        };
+        shard_manifest_write(filename, &manifest);
+    }
+
+    stat_f64 haversine_stat = {0};
+    for(u64 chunk = 0; chunk < job.chunk_count; ++chunk) stat_f64_merge(&haversine_stat, job.chunk_stats + chunk);
+    arena_free(temp_arena);
 
     return haversine_stat;
 }
+FP_CONTRACT_OFF_END
@@ -0,0 +1,213 @@
+/*  +======| File Info |===============================================================+
+    |                                                                                  |
+    |     Subdirectory:  /src                                                          |
+    |    Creation date:  10/19/2026 10:05:27 AM                                        |
+    |    Last Modified:                                                                |
+    |                                                                                  |
+    +======================================| Copyright © Sayed Abid Hashimi |==========+  */
+
+#if !defined(HAVERSINE_H)
+
+/* NOTE(abid): Storage/math precision of the pair pipeline.
+ * - f64:   f64 columns, f64 lane math.
+ * - f32:   f32 columns, f32 lane math (twice the lanes), f64 accumulation of the sum.
+ * - mixed: f32 columns (half the memory traffic), widened to f64 lanes inside the kernel.
+ * - q32:   32-bit fixed point columns (see below), converted to f64 lanes inside the kernel. */
+#define PAIR_PRECISIONS \
+    X(f64)              \
+    X(f32)              \
+    X(mixed)            \
+    X(q32)
+
+typedef enum {
+#define X(value) pp_ ## value,
+    PAIR_PRECISIONS
+#undef X
+    pp_count
+} pair_precision;
+
+char *pair_precision_str[] = {
+#define X(value) #value,
+    PAIR_PRECISIONS
+#undef X
+};
+
+/* NOTE(abid): Columns are padded up to `PAIRS_PADDING` elements with zeroed pairs, a zero pair is
+ * a zero distance, so the kernels never need a scalar tail loop. */
+#define PAIRS_PADDING 16
+#define PAIRS_ALIGNMENT 64
+
+typedef struct {
+    u64 count;
+    f64 *x0;
+    f64 *y0;
+    f64 *x1;
+    f64 *y1;
+} pairs_f64;
+
+/* NOTE(abid): One element of the "pairs" list, for the schema parser (see json_schema.h). */
+#define PAIR_RECORD_FIELDS \
+    X(f64, x0)             \
+    X(f64, y0)             \
+    X(f64, x1)             \
+    X(f64, y1)
+
+typedef struct {
+    u64 count;
+    f32 *x0;
+    f32 *y0;
+    f32 *x1;
+    f32 *y1;
+} pairs_f32;
+
+/* NOTE(abid): Compact coordinates, degrees quantized to a 1e-7 degree grid in an i32, lon at
+ * +-180 is 1.8e9 which still fits. Rounding moves a coordinate by at most 0.5e-7 degrees, so an
+ * endpoint moves at most sqrt(2)*0.5e-7 degrees of arc, that is 7.9e-6 km on a 6372.8 km sphere.
+ * With both endpoints off the worst-case distance error is 1.6e-5 km (1.6 cm), independent of the
+ * distance itself. Datasets generated with `quantize_q32` sit on the grid already and lose nothing.
+ * - 19.Oct.2026 */
+#define COORD_Q32_SCALE 1e7
+#define COORD_Q32_MAX_DISTANCE_ERROR_KM 1.6e-5
+
+typedef struct {
+    u64 count;
+    i32 *x0;
+    i32 *y0;
+    i32 *x1;
+    i32 *y1;
+} pairs_q32;
+
+/* NOTE(abid): Work of one thread of `haversine_sum_f64_parallel` / `haversine_sum_q32_parallel`,
+ * `fixed` is used when it has columns. */
+typedef struct {
+    pairs_f64 pairs;
+    pairs_q32 fixed;
+    f64 earth_radius;
+    f64 sum;
+} haversine_slice;
+
+/* NOTE(abid): How the generator places pair endpoints:
+ * - box:      uniform in lat/lon inside each cluster's rectangle (the whole globe without clusters).
+ * - gaussian: normal blobs centered on each cluster's rectangle, sigma a sixth of its size, so the
+ *             rectangle spans +-3 sigma. Draws past a pole are reflected, longitude wraps.
+ * - sphere:   uniform over the surface, latitude asin(2u - 1), clusters are ignored.
+ * Gaussian draws come from a lane Box-Muller, sphere latitudes from a lane asin. */
+#define GENERATOR_DISTRIBUTIONS \
+    X(box)                      \
+    X(gaussian)                 \
+    X(sphere)
+
+typedef enum {
+#define X(value) gd_ ## value,
+    GENERATOR_DISTRIBUTIONS
+#undef X
+    gd_count
+} generator_distribution;
+
+char *generator_distribution_str[] = {
+#define X(value) #value,
+    GENERATOR_DISTRIBUTIONS
+#undef X
+};
+
+typedef struct {
+    u64 number_pairs;
+    u64 num_clusters;
+    char *filename;
+    generator_distribution distribution;
+
+    /* NOTE(abid): Snap every generated coordinate to the q32 grid and write it with 7 decimals. */
+    bool quantize_q32;
+    file_writer_mode output_mode;
+
+    u64 seed;
+    u32 thread_count; /* NOTE(abid): 0 = one per logical core. */
+
+    /* NOTE(abid): 0 = one unsharded dataset, otherwise that many shards plus a manifest (see
+     * shards.h). `regenerate_one` writes only shard `regenerate_shard` and leaves the manifest. */
+    u32 shard_count;
+    bool regenerate_one;
+    u32 regenerate_shard;
+} generator_config;
+
+/* NOTE(abid): Parallel generation. Every dataset is written as .json, .f64 (answers) and .pairs
+ * (binary columns, see pairs_file.h). Pairs are generated in fixed chunks, chunk c fills its
+ * coordinates from its own batch generator seeded with (seed, c + 1), stream 0 draws the cluster
+ * boxes. Threads grab chunks in order, format them privately and append them to the files
+ * strictly in chunk order, so the output only depends on the seed, never on the thread count.
+ * Shards are runs of whole chunks, the thread whose turn it is to write opens and closes them. */
+#define GENERATOR_CHUNK_PAIRS 16384
+#define GENERATOR_MAX_PAIR_LEN (4*FLOAT_FORMAT_MAX_LEN + 64)
+
+/* NOTE(abid): Region both endpoints of a pair are drawn from. */
+typedef struct {
+    f64 lat0_start, lat0_size;
+    f64 lon0_start, lon0_size;
+    f64 lat1_start, lat1_size;
+    f64 lon1_start, lon1_size;
+} generator_cluster;
+
+typedef struct {
+    generator_config *config;
+    u32 precision;
+
+    /* NOTE(abid): Pair i is in cluster i/pairs_per_cluster, the remainder pairs past the last
+     * whole cluster all go to the last one. */
+    generator_cluster *clusters;
+    u64 cluster_count;
+    u64 pairs_per_cluster;
+
+    u64 chunk_count;
+    stat_f64 *chunk_stats;
+
+    /* NOTE(abid): An unsharded dataset is a single shard with the plain file names. Chunks
+     * [first_chunk, end_chunk) are generated, all of them unless one shard is regenerated. */
+    u32 shard_count;
+    u64 *shard_first_chunk;
+    shard_entry *shards;
+    u64 first_chunk;
+    u64 end_chunk;
+
+    /* NOTE(abid): Files of the shard being written, only touched by the thread whose turn it is. */
+    u32 current_shard;
+    file_writer *json_writer;
+    file_writer *f64_writer;
+    pairs_file_writer *pairs_writer;
+    stream_checksum json_checksum;
+    stream_checksum f64_checksum;
+
+    volatile u64 next_chunk;
+    volatile u64 next_chunk_to_write;
+} generator_job;
+
+typedef struct {
+    u64 count;
+
+    f64 max_abs_error;
+    u64 max_abs_error_idx;
+    f64 mean_abs_error;
+    f64 max_rel_error;
+
+    f64 reference_average;
+    f64 computed_average;
+    f64 average_rel_error;
+} precision_report;
+
+/* NOTE(abid): Verification of computed distances against the reference answers. The ULP histogram
+ * buckets are powers of two, bucket 0 is an exact match, bucket b holds distances in
+ * [2^(b-1), 2^b) and the last bucket everything further out. */
+#define ULP_HISTOGRAM_BUCKETS 24
+#define VERIFY_BATCH 4096
+#define VERIFY_PRINT_LIMIT 64
+
+typedef struct {
+    u64 count;
+    u64 ulp_histogram[ULP_HISTOGRAM_BUCKETS];
+    u64 max_ulp;
+    u64 worst_idx;
+    f64 max_abs_error;
+    u64 over_threshold;
+} verify_report;
+
+#define HAVERSINE_H
+#endif
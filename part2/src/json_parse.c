@@ -90,7 +90,13 @@ buffer_consume_extract_numeric(string_value *str, buffer *json_buffer) {
     usize start_idx = json_buffer->current_idx;
     while(buffer_is_numeric(json_buffer)) {
         buffer_consume(json_buffer);
-        if(!is_float && json_buffer->str[json_buffer->current_idx] == '.') {
+        char current_char = json_buffer->str[json_buffer->current_idx];
+        if(!is_float && current_char == '.') {
+            is_float = true;
+            buffer_consume(json_buffer);
+        }
+        /* NOTE(abid): Exponent, its sign is picked up as numeric by the loop. */
+        if(current_char == 'e' || current_char == 'E') {
             is_float = true;
             buffer_consume(json_buffer);
         }
@@ -320,6 +326,7 @@ jp_parser(parser_state *state) {
 
     /* NOTE(abid): Push the entire required memory for json object at once. */
     mem_arena *json_arena = arena_create(state->global_bytes_size, state->global_bytes_size);
+    state->json_arena = json_arena;
     state->json = json_arena->ptr;
 
     /* NOTE(abid): Current scope of the container we are in [json_list | json_dict]. */
@@ -429,8 +436,9 @@ jp_parser(parser_state *state) {
     }
 }
 
+/* NOTE(abid): `size_out` (optional) gets the file size. */
 internal void *
-read_file(char *filename, usize object_size) {
+read_file(char *filename, usize object_size, usize *size_out) {
     FILE *handle = fopen(filename, "rb");
     assert(handle != NULL, "file could not be opened.");
 
@@ -445,23 +453,23 @@ read_file(char *filename, usize object_size) {
 
     usize num_values = file_size/object_size;
     /* NOTE(abid): Read into the buffer */
-    size_t number_of_read = fread(content, object_size, num_values, handle);
+    size_t number_of_read = 0;
+    TIME_FUNCTION_BANDWIDTH(file_size) number_of_read = fread(content, object_size, num_values, handle);
     if (number_of_read != num_values) {
         fclose(handle);
         platform_free(content, file_size);
         assert(false, "could not load file into memory");
     }
     fclose(handle);
+    if(size_out) *size_out = file_size;
 
     return content;
 }
 
 internal json_dict *
 jp_load(char *Filename) {
-    buffer buffer = {
-        .str = (char *)read_file(Filename, /*object_size=*/1),
-        .current_idx = 0
-    };
+    buffer buffer = { .current_idx = 0 };
+    buffer.str = (char *)read_file(Filename, /*object_size=*/1, &buffer.size);
     usize physical_mem_max_size = platform_ram_get_size();
     parser_state state = {
         .json = NULL,
@@ -470,8 +478,8 @@ jp_load(char *Filename) {
         .current_token = NULL
     };
 
-    jp_lexer(&buffer, &state);
-    jp_parser(&state);
+    TIME_BANDWIDTH("jp_lexer", buffer.size) jp_lexer(&buffer, &state);
+    TIME_BANDWIDTH("jp_parser", buffer.size) jp_parser(&state);
 
     arena_free(state.temp_arena);
 
@@ -38,6 +38,7 @@ typedef struct {
 
 typedef struct {
     char *str;
+    usize size;
     usize current_idx;
 } buffer;
 
@@ -112,6 +113,7 @@ typedef struct {
     token *token_list;
     token *current_token;
     usize global_bytes_size;
+    mem_arena *json_arena; /* NOTE(abid): Holds the tree, set by the parser. */
 
     json_scope *scope_free_list;
 } parser_state;
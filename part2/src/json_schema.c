@@ -0,0 +1,145 @@
+/*  +======| File Info |===============================================================+
+    |                                                                                  |
+    |     Subdirectory:  /src                                                          |
+    |    Creation date:  10/20/2026 12:21:09 AM                                        |
+    |    Last Modified:                                                                |
+    |                                                                                  |
+    +======================================| Copyright © Sayed Abid Hashimi |==========+  */
+
+#include "json_schema.h"
+
+global_var f64 json_schema_pow10[JSON_SCHEMA_EXACT_POW10 + 1] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22,
+};
+
+inline internal char *
+json_schema_skip_whitespace(char *at, char *end) {
+    while(at < end && (*at == ' ' || *at == '\t' || *at == '\n' || *at == '\r')) ++at;
+    return at;
+}
+
+/* NOTE(abid): First (up to) 8 bytes of a key as one integer, constant folded for literals. */
+inline internal u64
+json_schema_key_prefix(char *key, usize length) {
+    u64 result = 0;
+    for(usize idx = 0; idx < length && idx < sizeof(u64); ++idx) result |= (u64)(u8)key[idx] << (8*idx);
+
+    return result;
+}
+
+/* NOTE(abid): Occurrences of `value` in the buffer, byte lanes and a popcount per block. */
+internal u64
+json_schema_count_byte(char *data, usize size, char value) {
+    u64 result = 0;
+    usize idx = 0;
+    lane_u8 match = lane_u8_set1(value);
+    for(; idx + LANE_U8_WIDTH <= size; idx += LANE_U8_WIDTH) {
+        result += u64_popcount(lane_u8_movemask(lane_u8_eq(lane_u8_load(data + idx), match)));
+    }
+    for(; idx < size; ++idx) result += data[idx] == value;
+
+    return result;
+}
+
+/* NOTE(abid): `mantissa * 10^exponent` for a non-zero mantissa, false when undecided. */
+internal bool
+json_schema_scale_pow10(u64 mantissa, i32 exponent, f64 *out) {
+    if(exponent < SCHUBFACH_K_MIN || exponent > SCHUBFACH_K_MAX) return false;
+
+    u32 leading_zeros = u64_leading_zeros(mantissa);
+    u64 normalized = mantissa << leading_zeros;
+    u64 *g = schubfach_g[exponent - SCHUBFACH_K_MIN];
+    u128 low = u128_mul_u64(normalized, g[1]);
+    u128 top = u128_add_u64(u128_mul_u64(normalized, g[0]), low.hi);
+
+    /* NOTE(abid): `top` is in [2^126, 2^128), keep 53 bits plus the rounding bit. */
+    u32 shift = (top.hi >> 63) ? 74 : 73;
+    u64 below_mask = (1ULL << (shift - 64)) - 1;
+    u64 below_hi = top.hi & below_mask;
+    if((below_hi == 0 && top.lo == 0) || (below_hi == below_mask && top.lo == ~0ULL)) return false;
+
+    u64 bits = top.hi >> (shift - 64);
+    u64 significand = (bits >> 1) + (bits & 1);
+    i32 binary_exponent = (i32)shift + 1 + floor_log2_pow10(exponent) - 63 - (i32)leading_zeros;
+    if(significand == (1ULL << 53)) {
+        significand >>= 1;
+        ++binary_exponent;
+    }
+
+    i32 biased_exponent = binary_exponent + 52 + 1023;
+    if(biased_exponent < 1 || biased_exponent > 2046) return false;
+    u64 ieee = ((u64)biased_exponent << 52) | (significand & ((1ULL << 52) - 1));
+    memcpy(out, &ieee, sizeof(f64));
+
+    return true;
+}
+
+internal bool
+json_schema_read_f64(char **at_inout, char *end, f64 *out) {
+    char *at = *at_inout;
+    bool negative = at < end && *at == '-';
+    at += negative;
+
+    u64 mantissa = 0;
+    i32 exponent = 0;
+    u32 digits = 0;
+    bool truncated = false;
+    char *int_start = at;
+    for(; at < end && (u8)(*at - '0') < 10; ++at) {
+        if(digits < 19) {
+            mantissa = mantissa*10 + (u64)(*at - '0');
+            digits += mantissa != 0;
+        } else {
+            truncated |= *at != '0';
+            ++exponent;
+        }
+    }
+    if(at == int_start) return false;
+
+    if(at < end && *at == '.') {
+        char *frac_start = ++at;
+        for(; at < end && (u8)(*at - '0') < 10; ++at) {
+            if(digits < 19) {
+                mantissa = mantissa*10 + (u64)(*at - '0');
+                digits += mantissa != 0;
+                --exponent;
+            } else truncated |= *at != '0';
+        }
+        if(at == frac_start) return false;
+    }
+
+    if(at < end && (*at == 'e' || *at == 'E')) {
+        ++at;
+        bool exponent_negative = at < end && *at == '-';
+        if(at < end && (*at == '-' || *at == '+')) ++at;
+        char *exponent_start = at;
+        i32 value = 0;
+        for(; at < end && (u8)(*at - '0') < 10; ++at) {
+            if(value < 100000) value = value*10 + (*at - '0');
+        }
+        if(at == exponent_start) return false;
+        exponent += exponent_negative ? -value : value;
+    }
+
+    f64 result;
+    if(!truncated && mantissa <= (1ULL << 53) &&
+       exponent >= -JSON_SCHEMA_EXACT_POW10 && exponent <= JSON_SCHEMA_EXACT_POW10) {
+        result = (f64)mantissa;
+        result = (exponent < 0) ? result/json_schema_pow10[-exponent] : result*json_schema_pow10[exponent];
+        if(negative) result = -result;
+    } else if(!truncated && mantissa && json_schema_scale_pow10(mantissa, exponent, &result)) {
+        if(negative) result = -result;
+    } else {
+        /* NOTE(abid): strtod needs a terminator after the number, a number is never the last
+         * byte of a valid document. */
+        if(at == end) return false;
+        char *strtod_end;
+        result = strtod(*at_inout, &strtod_end);
+        if(strtod_end != at) return false;
+    }
+
+    *out = result;
+    *at_inout = at;
+    return true;
+}
@@ -0,0 +1,67 @@
+/*  +======| File Info |===============================================================+
+    |                                                                                  |
+    |     Subdirectory:  /src                                                          |
+    |    Creation date:  10/20/2026 12:21:09 AM                                        |
+    |    Last Modified:                                                                |
+    |                                                                                  |
+    +======================================| Copyright © Sayed Abid Hashimi |==========+  */
+
+#if !defined(JSON_SCHEMA_H)
+
+/* NOTE(abid): Schema parsers. A record type is declared as an X-macro of (type, name) fields and
+ * json_schema_parser.h is included with it, which expands into a parser for exactly that record:
+ *
+ *   #define POINT_FIELDS \
+ *       X(f64, lat)      \
+ *       X(f64, lon)
+ *   #define JSON_SCHEMA_NAME point
+ *   #define JSON_SCHEMA_FIELDS POINT_FIELDS
+ *   #include "json_schema_parser.h"
+ *
+ * gives `point` (the record), `point_columns` (one array per field) and
+ * `point_parse_document(data, size, "points", &columns)` for `{"points": [{...}, ...]}`.
+ * Keys are matched by length and their first 8 bytes (one compare), values are written straight
+ * into the columns, no tree and no hash table. Unknown, duplicate or missing fields, escaped keys
+ * and anything that is not the expected shape are rejected with the byte offset.
+ * Field types: f64, the only one a record uses so far, another type needs its
+ * `json_schema_read_<type>` in json_schema.c. */
+/* NOTE(abid): How a run turns its .json into pair columns:
+ * - tree:   jp_load builds the generic tree, pairs are looked up in it afterwards.
+ * - schema: the pair_record schema parser writes the columns directly. */
+#define JSON_PARSERS \
+    X(tree)          \
+    X(schema)
+
+typedef enum {
+#define X(value) jsp_ ## value,
+    JSON_PARSERS
+#undef X
+    jsp_count
+} json_parser;
+
+char *json_parser_str[] = {
+#define X(value) #value,
+    JSON_PARSERS
+#undef X
+};
+
+#define JSON_SCHEMA_MAX_FIELDS 64
+#define JSON_SCHEMA_NO_FIELD 0xFFFFFFFF
+
+/* NOTE(abid): Number conversion, all correctly rounded:
+ * - digits up to 2^53 and a power of ten up to 22: one exact multiply or divide (Clinger).
+ * - up to 19 digits otherwise: digits times the 128-bit power of ten from the Schubfach table
+ *   (float_format.c). That power is high by less than one unit, so the top 128 bits of the product
+ *   are within one of the exact value, unless the bits below the rounding bit are all zeros or all
+ *   ones the rounding is decided (same idea as Eisel-Lemire).
+ * - anything else (more digits, near ties, subnormals, out of range) goes to strtod. */
+#define JSON_SCHEMA_EXACT_POW10 22
+
+typedef struct {
+    char *error; /* NOTE(abid): NULL on success. */
+    u64 offset;
+    u64 record;
+} json_schema_status;
+
+#define JSON_SCHEMA_H
+#endif
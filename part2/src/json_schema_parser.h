@@ -0,0 +1,182 @@
+/*  +======| File Info |===============================================================+
+    |                                                                                  |
+    |     Subdirectory:  /src                                                          |
+    |    Creation date:  10/20/2026 12:21:09 AM                                        |
+    |    Last Modified:                                                                |
+    |                                                                                  |
+    +======================================| Copyright © Sayed Abid Hashimi |==========+  */
+
+/* NOTE(abid): No include guard, included once per record type, see json_schema.h.
+ * Expects JSON_SCHEMA_NAME and JSON_SCHEMA_FIELDS, undefines both at the end. */
+#if !defined(JSON_SCHEMA_NAME) || !defined(JSON_SCHEMA_FIELDS)
+#error "json_schema_parser.h needs JSON_SCHEMA_NAME and JSON_SCHEMA_FIELDS"
+#endif
+
+#define JSON_SCHEMA_PASTE_(A, B) A ## B
+#define JSON_SCHEMA_PASTE(A, B) JSON_SCHEMA_PASTE_(A, B)
+#define JSON_SCHEMA_FN(Suffix) JSON_SCHEMA_PASTE(JSON_SCHEMA_NAME, Suffix)
+
+typedef struct {
+#define X(type, name) type name;
+    JSON_SCHEMA_FIELDS
+#undef X
+} JSON_SCHEMA_NAME;
+
+typedef struct {
+    u64 count;
+    u64 capacity;
+#define X(type, name) type *name;
+    JSON_SCHEMA_FIELDS
+#undef X
+} JSON_SCHEMA_FN(_columns);
+
+enum {
+#define X(type, name) JSON_SCHEMA_FN(_field_ ## name),
+    JSON_SCHEMA_FIELDS
+#undef X
+    JSON_SCHEMA_FN(_field_count)
+};
+/* NOTE(abid): Fields are tracked in a u64 bitmask, fails to compile past JSON_SCHEMA_MAX_FIELDS. */
+typedef char JSON_SCHEMA_FN(_field_limit)[(JSON_SCHEMA_FN(_field_count) <= JSON_SCHEMA_MAX_FIELDS) ? 1 : -1];
+
+inline internal json_schema_status
+JSON_SCHEMA_FN(_error)(char *message, char *data, char *at, u64 record) {
+    json_schema_status result = { .error = message, .offset = (u64)(at - data), .record = record };
+    return result;
+}
+
+/* NOTE(abid): One `{...}` record into row `record` of the columns, `*at_inout` on the '{'. */
+internal json_schema_status
+JSON_SCHEMA_FN(_parse_record)(char *data, char **at_inout, char *end,
+                              JSON_SCHEMA_FN(_columns) *columns, u64 record) {
+    char *at = *at_inout;
+    if(at >= end || *at != '{') return JSON_SCHEMA_FN(_error)("expected '{'", data, at, record);
+    at = json_schema_skip_whitespace(at + 1, end);
+
+    u64 seen = 0;
+    if(at < end && *at == '}') {
+        ++at;
+    } else for(;;) {
+        if(at >= end || *at != '"') return JSON_SCHEMA_FN(_error)("expected a key", data, at, record);
+        char *key = ++at;
+        while(at < end && *at != '"' && *at != '\\') ++at;
+        if(at >= end || *at != '"') return JSON_SCHEMA_FN(_error)("unterminated or escaped key", data, key, record);
+        usize key_length = (usize)(at - key);
+        u64 key_prefix = json_schema_key_prefix(key, key_length);
+
+        u32 field = JSON_SCHEMA_NO_FIELD;
+#define X(type, name)                                                                         \
+        if(key_length == sizeof(#name) - 1 &&                                                 \
+           key_prefix == json_schema_key_prefix(#name, sizeof(#name) - 1) &&                  \
+           (key_length <= sizeof(u64) || memcmp(key, #name, key_length) == 0)) {              \
+            field = JSON_SCHEMA_FN(_field_ ## name);                                          \
+        } else
+        JSON_SCHEMA_FIELDS
+#undef X
+        {
+            return JSON_SCHEMA_FN(_error)("unexpected field", data, key, record);
+        }
+        if(seen & (1ULL << field)) return JSON_SCHEMA_FN(_error)("duplicate field", data, key, record);
+        seen |= 1ULL << field;
+
+        at = json_schema_skip_whitespace(at + 1, end);
+        if(at >= end || *at != ':') return JSON_SCHEMA_FN(_error)("expected ':'", data, at, record);
+        at = json_schema_skip_whitespace(at + 1, end);
+
+        bool read = false;
+        switch(field) {
+#define X(type, name)                                                                 \
+            case JSON_SCHEMA_FN(_field_ ## name): {                                   \
+                read = json_schema_read_ ## type(&at, end, columns->name + record);   \
+            } break;
+            JSON_SCHEMA_FIELDS
+#undef X
+        }
+        if(!read) return JSON_SCHEMA_FN(_error)("malformed value", data, at, record);
+
+        at = json_schema_skip_whitespace(at, end);
+        if(at < end && *at == ',') {
+            at = json_schema_skip_whitespace(at + 1, end);
+        } else if(at < end && *at == '}') {
+            ++at;
+            break;
+        } else return JSON_SCHEMA_FN(_error)("expected ',' or '}'", data, at, record);
+    }
+
+    u64 all_fields = (JSON_SCHEMA_FN(_field_count) == 64) ? ~0ULL :
+                     (1ULL << JSON_SCHEMA_FN(_field_count)) - 1;
+    if(seen != all_fields) return JSON_SCHEMA_FN(_error)("missing field", data, *at_inout, record);
+
+    *at_inout = at;
+    json_schema_status result = {0};
+    return result;
+}
+
+/* NOTE(abid): A `[{...}, ...]` array, appended after `columns->count`. */
+internal json_schema_status
+JSON_SCHEMA_FN(_parse_list)(char *data, char **at_inout, char *end, JSON_SCHEMA_FN(_columns) *columns) {
+    char *at = *at_inout;
+    if(at >= end || *at != '[') return JSON_SCHEMA_FN(_error)("expected '['", data, at, columns->count);
+    at = json_schema_skip_whitespace(at + 1, end);
+
+    if(at < end && *at == ']') {
+        *at_inout = at + 1;
+        json_schema_status result = {0};
+        return result;
+    }
+    for(;;) {
+        if(at >= end || *at != '{') return JSON_SCHEMA_FN(_error)("expected '{'", data, at, columns->count);
+        if(columns->count == columns->capacity) {
+            return JSON_SCHEMA_FN(_error)("more records than capacity", data, at, columns->count);
+        }
+        json_schema_status status = JSON_SCHEMA_FN(_parse_record)(data, &at, end, columns, columns->count);
+        if(status.error) return status;
+        ++columns->count;
+
+        at = json_schema_skip_whitespace(at, end);
+        if(at < end && *at == ',') {
+            at = json_schema_skip_whitespace(at + 1, end);
+        } else if(at < end && *at == ']') {
+            ++at;
+            break;
+        } else return JSON_SCHEMA_FN(_error)("expected ',' or ']'", data, at, columns->count);
+    }
+
+    *at_inout = at;
+    json_schema_status result = {0};
+    return result;
+}
+
+/* NOTE(abid): A whole `{"<list_key>": [...]}` document, nothing else is accepted. */
+internal json_schema_status
+JSON_SCHEMA_FN(_parse_document)(char *data, usize size, char *list_key, JSON_SCHEMA_FN(_columns) *columns) {
+    char *end = data + size;
+    char *at = json_schema_skip_whitespace(data, end);
+    if(at >= end || *at != '{') return JSON_SCHEMA_FN(_error)("expected '{'", data, at, 0);
+    at = json_schema_skip_whitespace(at + 1, end);
+
+    usize key_length = strlen(list_key);
+    if((usize)(end - at) < key_length + 2 || at[0] != '"' || memcmp(at + 1, list_key, key_length) != 0 ||
+       at[key_length + 1] != '"') {
+        return JSON_SCHEMA_FN(_error)("unexpected field", data, at, 0);
+    }
+    at = json_schema_skip_whitespace(at + key_length + 2, end);
+    if(at >= end || *at != ':') return JSON_SCHEMA_FN(_error)("expected ':'", data, at, 0);
+    at = json_schema_skip_whitespace(at + 1, end);
+
+    json_schema_status status = JSON_SCHEMA_FN(_parse_list)(data, &at, end, columns);
+    if(status.error) return status;
+
+    at = json_schema_skip_whitespace(at, end);
+    if(at >= end || *at != '}') return JSON_SCHEMA_FN(_error)("expected '}'", data, at, columns->count);
+    at = json_schema_skip_whitespace(at + 1, end);
+    if(at != end) return JSON_SCHEMA_FN(_error)("trailing data", data, at, columns->count);
+
+    return status;
+}
+
+#undef JSON_SCHEMA_FN
+#undef JSON_SCHEMA_PASTE
+#undef JSON_SCHEMA_PASTE_
+#undef JSON_SCHEMA_FIELDS
+#undef JSON_SCHEMA_NAME
@@ -0,0 +1,230 @@
+/*  +======| File Info |===============================================================+
+    |                                                                                  |
+    |     Subdirectory:  /src                                                          |
+    |    Creation date:  10/19/2026 11:48:31 PM                                        |
+    |    Last Modified:                                                                |
+    |                                                                                  |
+    +======================================| Copyright © Sayed Abid Hashimi |==========+  */
+
+#include "json_transcode.h"
+
+inline internal void
+json_transcode_reserve(json_transcoder *transcoder, usize size) {
+    if(transcoder->out_used + size > JSON_TRANSCODE_OUT_SIZE) {
+        file_writer_write(transcoder->writer, transcoder->out, transcoder->out_used);
+        transcoder->out_used = 0;
+    }
+}
+
+inline internal void
+json_transcode_put(json_transcoder *transcoder, u8 value) {
+    json_transcode_reserve(transcoder, 1);
+    transcoder->out[transcoder->out_used++] = value;
+}
+
+internal void
+json_transcode_newline(json_transcoder *transcoder) {
+    json_transcode_put(transcoder, '\n');
+    for(u32 left = transcoder->depth; left;) {
+        u32 count = (left < JSON_TRANSCODE_BLOCK) ? left : JSON_TRANSCODE_BLOCK;
+        json_transcode_reserve(transcoder, count);
+        memset(transcoder->out + transcoder->out_used, '\t', count);
+        transcoder->out_used += count;
+        left -= count;
+    }
+    transcoder->newline_pending = false;
+    transcoder->after_open = false;
+}
+
+/* NOTE(abid): Copies `size` (< block) bytes, always moving a whole block, `data` has to stay
+ * readable for a block past its start. */
+inline internal void
+json_transcode_run(json_transcoder *transcoder, u8 *data, usize size) {
+    if(size == 0) return;
+    if(transcoder->newline_pending) json_transcode_newline(transcoder);
+    json_transcode_reserve(transcoder, JSON_TRANSCODE_BLOCK);
+    memcpy(transcoder->out + transcoder->out_used, data, JSON_TRANSCODE_BLOCK);
+    transcoder->out_used += size;
+    transcoder->after_open = false;
+}
+
+/* NOTE(abid): Minify keeps the bytes in `keep` and packs them together, 8 at a time: the LUT entry
+ * of an 8 bit mask holds the byte indices of its set bits in order (a pshufb control), all 8
+ * shuffled bytes are stored and the output moves on by the kept count. Without SSSE3 every byte is
+ * stored and the output moves on by its bit. */
+global_var u64 json_transcode_pack_lut[256];
+
+internal void
+json_transcode_pack_lut_init() {
+    for(u32 mask = 0; mask < 256; ++mask) {
+        u64 entry = 0;
+        u32 kept = 0;
+        for(u32 idx = 0; idx < 8; ++idx) {
+            if((mask >> idx) & 1) entry |= (u64)idx << (8*kept++);
+        }
+        json_transcode_pack_lut[mask] = entry;
+    }
+}
+
+inline internal void
+json_transcode_pack(json_transcoder *transcoder, u8 *block, u64 keep) {
+    json_transcode_reserve(transcoder, JSON_TRANSCODE_BLOCK);
+    u8 *out = transcoder->out + transcoder->out_used;
+    if(keep == ~0ULL) {
+        memcpy(out, block, JSON_TRANSCODE_BLOCK);
+        out += JSON_TRANSCODE_BLOCK;
+    } else {
+#if defined(__SSSE3__)
+        for(u32 idx = 0; idx < JSON_TRANSCODE_BLOCK; idx += 8) {
+            u32 mask = (u32)(keep >> idx) & 0xff;
+            __m128i bytes = _mm_loadl_epi64((__m128i *)(block + idx));
+            __m128i shuffle = _mm_cvtsi64_si128((i64)json_transcode_pack_lut[mask]);
+            _mm_storel_epi64((__m128i *)out, _mm_shuffle_epi8(bytes, shuffle));
+            out += u64_popcount(mask);
+        }
+#else
+        for(u32 idx = 0; idx < JSON_TRANSCODE_BLOCK; ++idx) {
+            *out = block[idx];
+            out += (keep >> idx) & 1;
+        }
+#endif
+    }
+    transcoder->out_used = (usize)(out - transcoder->out);
+}
+
+/* NOTE(abid): A structural character outside of a string. */
+internal void
+json_transcode_pretty(json_transcoder *transcoder, u8 value) {
+    switch(value) {
+        case '{':
+        case '[': {
+            if(transcoder->newline_pending) json_transcode_newline(transcoder);
+            json_transcode_put(transcoder, value);
+            ++transcoder->depth;
+            transcoder->newline_pending = true;
+            transcoder->after_open = true;
+        } break;
+        case '}':
+        case ']': {
+            if(transcoder->depth) --transcoder->depth;
+            if(!transcoder->after_open) json_transcode_newline(transcoder);
+            json_transcode_put(transcoder, value);
+            transcoder->newline_pending = false;
+            transcoder->after_open = false;
+        } break;
+        case ',': {
+            json_transcode_put(transcoder, ',');
+            transcoder->newline_pending = true;
+        } break;
+        case ':': {
+            json_transcode_put(transcoder, ':');
+            json_transcode_put(transcoder, ' ');
+        } break;
+        default: break; /* NOTE(abid): Whitespace. */
+    }
+}
+
+/* NOTE(abid): One block, `len` bytes are real, the block stays readable for another block past
+ * its start. */
+internal void
+json_transcode_block(json_transcoder *transcoder, u8 *block, u32 len) {
+    u64 quote = 0, backslash = 0, whitespace = 0, structural = 0;
+    bool pretty = transcoder->mode == jtm_pretty;
+    for(u32 idx = 0; idx < JSON_TRANSCODE_BLOCK; idx += LANE_U8_WIDTH) {
+        lane_u8 bytes = lane_u8_load(block + idx);
+        quote |= lane_u8_movemask(lane_u8_eq(bytes, lane_u8_set1('"'))) << idx;
+        backslash |= lane_u8_movemask(lane_u8_eq(bytes, lane_u8_set1('\\'))) << idx;
+        lane_u8 space = lane_u8_or(lane_u8_or(lane_u8_eq(bytes, lane_u8_set1(' ')), lane_u8_eq(bytes, lane_u8_set1('\t'))),
+                                   lane_u8_or(lane_u8_eq(bytes, lane_u8_set1('\n')), lane_u8_eq(bytes, lane_u8_set1('\r'))));
+        whitespace |= lane_u8_movemask(space) << idx;
+        if(pretty) {
+            lane_u8 brackets = lane_u8_or(lane_u8_or(lane_u8_eq(bytes, lane_u8_set1('{')), lane_u8_eq(bytes, lane_u8_set1('}'))),
+                                          lane_u8_or(lane_u8_eq(bytes, lane_u8_set1('[')), lane_u8_eq(bytes, lane_u8_set1(']'))));
+            lane_u8 separators = lane_u8_or(lane_u8_eq(bytes, lane_u8_set1(',')), lane_u8_eq(bytes, lane_u8_set1(':')));
+            structural |= lane_u8_movemask(lane_u8_or(brackets, separators)) << idx;
+        }
+    }
+    u64 valid = (len == JSON_TRANSCODE_BLOCK) ? ~0ULL : (1ULL << len) - 1;
+
+    /* NOTE(abid): Escapes are rare (none in generated data), blocks with a backslash take the
+     * scalar path: a backslash escapes the next byte unless it is escaped itself. */
+    u64 escaped = 0;
+    if((backslash & valid) || transcoder->escape_pending) {
+        bool escape = transcoder->escape_pending;
+        for(u32 idx = 0; idx < len; ++idx) {
+            if(escape) {
+                escaped |= 1ULL << idx;
+                escape = false;
+            } else if((backslash >> idx) & 1) escape = true;
+        }
+        transcoder->escape_pending = escape;
+    }
+
+    /* NOTE(abid): Prefix XOR, every bit from an opening quote up to (not including) its closing
+     * quote is set. */
+    u64 in_string = quote & ~escaped & valid;
+    in_string ^= in_string << 1;
+    in_string ^= in_string << 2;
+    in_string ^= in_string << 4;
+    in_string ^= in_string << 8;
+    in_string ^= in_string << 16;
+    in_string ^= in_string << 32;
+    in_string ^= transcoder->in_string;
+    transcoder->in_string = (u64)((i64)in_string >> 63);
+
+    if(!pretty) {
+        json_transcode_pack(transcoder, block, ~(whitespace & ~in_string) & valid);
+        return;
+    }
+
+    /* NOTE(abid): Pretty printing goes event by event, the bytes between them are copied as runs. */
+    u64 events = (whitespace | structural) & ~in_string & valid;
+    u32 pos = 0;
+    while(events) {
+        u32 idx = u64_trailing_zeros(events);
+        events &= events - 1;
+        json_transcode_run(transcoder, block + pos, idx - pos);
+        json_transcode_pretty(transcoder, block[idx]);
+        pos = idx + 1;
+    }
+    json_transcode_run(transcoder, block + pos, len - pos);
+}
+
+/* NOTE(abid): Streams `src_filename` into `dest_filename`, neither file has to fit in memory. */
+internal json_transcode_stats
+json_transcode_file(char *src_filename, char *dest_filename, json_transcode_mode mode) {
+    FILE *input = fopen(src_filename, "rb");
+    assert(input, "cannot open %s.", src_filename);
+
+    json_transcoder transcoder = {
+        .mode = mode,
+        .writer = file_writer_open(dest_filename, fwm_buffered),
+        .out = malloc(JSON_TRANSCODE_OUT_SIZE + JSON_TRANSCODE_SLACK),
+    };
+    u8 *read_buffer = malloc(JSON_TRANSCODE_READ_SIZE + JSON_TRANSCODE_SLACK);
+    memset(read_buffer + JSON_TRANSCODE_READ_SIZE, ' ', JSON_TRANSCODE_SLACK);
+
+    if(mode == jtm_minify) json_transcode_pack_lut_init();
+
+    json_transcode_stats stats = {0};
+    usize read_size;
+    while((read_size = fread(read_buffer, 1, JSON_TRANSCODE_READ_SIZE, input)) > 0) {
+        stats.bytes_in += read_size;
+        /* NOTE(abid): Only the last read is short, pad its partial block. */
+        memset(read_buffer + read_size, ' ', JSON_TRANSCODE_BLOCK);
+        for(usize offset = 0; offset < read_size; offset += JSON_TRANSCODE_BLOCK) {
+            usize len = read_size - offset;
+            json_transcode_block(&transcoder, read_buffer + offset,
+                                 (u32)((len < JSON_TRANSCODE_BLOCK) ? len : JSON_TRANSCODE_BLOCK));
+        }
+    }
+    if(mode == jtm_pretty && stats.bytes_in) json_transcode_put(&transcoder, '\n');
+
+    file_writer_write(transcoder.writer, transcoder.out, transcoder.out_used);
+    stats.bytes_out = file_writer_close(transcoder.writer);
+    fclose(input);
+    free(read_buffer);
+    free(transcoder.out);
+
+    return stats;
+}
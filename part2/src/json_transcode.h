@@ -0,0 +1,66 @@
+/*  +======| File Info |===============================================================+
+    |                                                                                  |
+    |     Subdirectory:  /src                                                          |
+    |    Creation date:  10/19/2026 11:48:31 PM                                        |
+    |    Last Modified:                                                                |
+    |                                                                                  |
+    +======================================| Copyright © Sayed Abid Hashimi |==========+  */
+
+#if !defined(JSON_TRANSCODE_H)
+
+/* NOTE(abid): Streaming JSON re-formatter, the input is read in fixed pieces so it can be larger
+ * than RAM. Every 64 byte block is classified with byte lanes into bit masks (quotes, backslashes,
+ * whitespace, structural characters), the string mask is the prefix XOR of the unescaped quotes
+ * carried across blocks.
+ * - minify: drops all whitespace outside of strings, the rest of a block is packed together with
+ *           byte shuffles.
+ * - pretty: drops it as well, then puts every value on its own line, indented with tabs.
+ * The input is not validated, malformed JSON comes out just as malformed. */
+#define JSON_TRANSCODE_MODES \
+    X(minify)                \
+    X(pretty)
+
+typedef enum {
+#define X(value) jtm_ ## value,
+    JSON_TRANSCODE_MODES
+#undef X
+    jtm_count
+} json_transcode_mode;
+
+char *json_transcode_mode_str[] = {
+#define X(value) #value,
+    JSON_TRANSCODE_MODES
+#undef X
+};
+
+#define JSON_TRANSCODE_BLOCK 64
+#define JSON_TRANSCODE_READ_SIZE megabyte(4)
+#define JSON_TRANSCODE_OUT_SIZE megabyte(1)
+/* NOTE(abid): Runs are copied a whole block at a time, both buffers keep this much room past
+ * their end. */
+#define JSON_TRANSCODE_SLACK (2*JSON_TRANSCODE_BLOCK)
+
+typedef struct {
+    json_transcode_mode mode;
+    file_writer *writer;
+    u8 *out;
+    usize out_used;
+
+    /* NOTE(abid): Carried from one block to the next. */
+    u64 in_string; /* NOTE(abid): All ones inside a string. */
+    bool escape_pending;
+
+    /* NOTE(abid): Pretty printing. A newline is only written once the next token shows up, so
+     * empty containers stay `{}` / `[]`. */
+    u32 depth;
+    bool newline_pending;
+    bool after_open;
+} json_transcoder;
+
+typedef struct {
+    u64 bytes_in;
+    u64 bytes_out;
+} json_transcode_stats;
+
+#define JSON_TRANSCODE_H
+#endif
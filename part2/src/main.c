@@ -6,48 +6,58 @@
     |                                                                                  |
     +======================================| Copyright © Sayed Abid Hashimi |==========+  */
 
+#if defined(PLT_LINUX)
+#define _GNU_SOURCE /* NOTE(abid): O_DIRECT */
+#endif
 #include <stdio.h>
 #include <stdint.h>
+#include <stddef.h>
 #include <stdlib.h>
 #include <math.h>
 
 #include "types.h"
 #include "utils.c"
-#include "random.c"
+#include "bench.h"
 #include "stat.c"
+#include "results.c"
+#include "perf_counters.c"
+#include "profiler.c"
+#include "sampler.c"
+#include "repetition_tester.c"
+#include "random.c"
+#include "float_format.c"
 #include "json_parse.c"
+#include "simd_math.c"
+#include "memory_probe.c"
+#include "json_schema.c"
+#include "file_writer.c"
+#include "file_reader.c"
+#include "json_transcode.c"
+#include "block_codec.c"
+#include "pairs_file.c"
+#include "shards.c"
 #include "haversine.c"
-#include "bench.h"
+#include "distance_formulas.c"
+#include "distance_matrix.c"
 
 typedef struct {
     f64 *f64_buffer;
     json_dict *json;
 } haversine_files;
+
+#define SWEEP_MAX_VALUES 16
+#define SWEEP_DEFAULT_SECONDS 1
+#define SWEEP_FIRST_PAIRS 1000
+
 internal haversine_files
 load_json_f64_files(char *filename) {
-    /* NOTE(abid): `filename` should be without extension. */
-    usize filename_len = strlen(filename);
-    char *temp = malloc(strlen(filename) + 5 + 1);
-    char *json_extension = ".json";
-    char *f64_extension = ".f64";
-    usize json_extension_len = strlen(json_extension);
-    usize f64_extension_len = strlen(f64_extension);
-    memcpy(temp, filename, filename_len);
-
-    /* NOTE(abid): Load JSON. */
-    u32 idx;
-    for(idx = 0; idx < json_extension_len; ++idx)
-        temp[idx + filename_len] = json_extension[idx];
-    temp[idx + filename_len] = '\0';
-    json_dict *json = jp_load(temp);
-
-    /* NOTE(abid): Load .f64 file. */
-    for(idx = 0; idx < f64_extension_len; ++idx)
-        temp[idx + filename_len] = f64_extension[idx];
-    temp[idx + filename_len] = '\0';
-    f64 *f64_buffer = read_file(temp, sizeof(f64));
-
-    free(temp);
+    char *json_filename = filename_with_extension(filename, ".json");
+    json_dict *json = jp_load(json_filename);
+    free(json_filename);
+
+    char *f64_filename = filename_with_extension(filename, ".f64");
+    f64 *f64_buffer = read_file(f64_filename, sizeof(f64), NULL);
+    free(f64_filename);
 
     return (haversine_files) {
         .json = json,
@@ -55,88 +65,1502 @@ load_json_f64_files(char *filename) {
     };
 }
 
+/* NOTE(abid): Recomputes every pair of an existing dataset and compares it to the .f64 answers.
+ * The pairs come from the mapped .pairs file (required with `--input=pairs`), without one the .json
+ * goes through the schema parser, so loading costs about as much as the verification itself. */
+internal bool
+verify_json_f64_answers(char *filename, dataset_format input, u64 ulp_print_threshold) {
+    u64 cpu_freq = platform_get_cpu_timer_freq_estimate(/*ms_to_wait =*/0);
+
+    u64 load_start = platform_get_cpu_timer();
+    char *pairs_filename = filename_with_extension(filename, ".pairs");
+    pairs_file_mapping mapping = {0};
+    FILE *pairs_file = fopen(pairs_filename, "rb");
+    if(pairs_file) fclose(pairs_file);
+    bool mapped = (pairs_file || input == dsf_pairs) && pairs_file_map(pairs_filename, &mapping, /*verify_columns =*/false);
+    if(!mapped && input == dsf_pairs) {
+        printf("Cannot load %s, generate the dataset first.\n", pairs_filename);
+        free(pairs_filename);
+        return false;
+    }
+    free(pairs_filename);
+
+    pairs_f64 pairs = {0};
+    char *json_data = NULL;
+    usize json_size = 0;
+    mem_arena *pairs_arena = NULL;
+    if(mapped) {
+        pairs = pairs_f64_from_mapping(&mapping);
+    } else {
+        char *json_filename = filename_with_extension(filename, ".json");
+        json_data = platform_file_map(json_filename, &json_size);
+        if(!json_data) {
+            printf("Cannot load %s or a .pairs file next to it.\n", json_filename);
+            free(json_filename);
+            return false;
+        }
+        free(json_filename);
+
+        u64 capacity = pairs_json_capacity(json_data, json_size);
+        usize column_bytes = 4*sizeof(f64)*pairs_padded_count(capacity) + 4*PAIRS_ALIGNMENT;
+        pairs_arena = arena_create(column_bytes, column_bytes);
+        json_schema_status status = pairs_f64_from_json_schema(json_data, json_size, capacity, pairs_arena, &pairs);
+        if(status.error) {
+            printf("Schema parser: %s at byte %llu (record %llu).\n", status.error, status.offset, status.record);
+            platform_file_unmap(json_data, json_size);
+            arena_free(pairs_arena);
+            return false;
+        }
+    }
+
+    char *f64_filename = filename_with_extension(filename, ".f64");
+    usize f64_size = 0;
+    f64 *reference = platform_file_map(f64_filename, &f64_size);
+    u64 load_elapsed = platform_get_cpu_timer() - load_start;
+
+    bool result = false;
+    u64 reference_count = f64_size/sizeof(f64);
+    if(!reference && pairs.count) {
+        printf("Cannot load the answers, %s is missing or unreadable.\n", f64_filename);
+    } else if(reference_count != pairs.count) {
+        printf("Answer count mismatch: %llu pairs in the %s, %llu answers in .f64\n", pairs.count,
+               mapped ? ".pairs" : ".json", reference_count);
+    } else {
+        u64 verify_start = platform_get_cpu_timer();
+        verify_report report = haversine_verify_answers(&pairs, reference, ulp_print_threshold);
+        u64 verify_elapsed = platform_get_cpu_timer() - verify_start;
+
+        verify_report_print(&report, ulp_print_threshold);
+        printf("  Load (%s): %fms, Verify: %fms\n", mapped ? "mapped .pairs" : ".json, schema parser",
+               1000.0*(f64)load_elapsed/(f64)cpu_freq, 1000.0*(f64)verify_elapsed/(f64)cpu_freq);
+        result = report.over_threshold == 0;
+    }
+    free(f64_filename);
+
+    if(reference) platform_file_unmap(reference, f64_size);
+    if(mapped) pairs_file_unmap(&mapping);
+    if(json_data) platform_file_unmap(json_data, json_size);
+    if(pairs_arena) arena_free(pairs_arena);
+
+    return result;
+}
+
+typedef struct {
+    u64 seed;
+    u64 num_pairs;
+    u64 num_clusters;
+    char *filename;
+
+    pair_precision precision;
+    bool quantize_q32;
+    generator_distribution distribution;
+    file_writer_mode output_mode;
+    dataset_format input;
+    json_parser parser;
+    dataset_format convert_to; /* NOTE(abid): dsf_count = no conversion. */
+    bool compress; /* NOTE(abid): Only write .hvz copies of the .pairs and .f64 files. */
+    json_transcode_mode transcode; /* NOTE(abid): jtm_count = none. */
+    bool compressed; /* NOTE(abid): Load the .hvz copies instead (pairs input). */
+
+    i64 matrix_k; /* NOTE(abid): -1 = no distance matrix, 0 = full matrix, k = k nearest. */
+    u32 thread_count; /* NOTE(abid): 0 = one per logical core. */
+
+    /* NOTE(abid): 0 = unsharded. Sharded runs generate (json input, unless `no_generate`) or reuse
+     * (pairs input) the shards and only run the shard loader. */
+    u32 shard_count;
+    bool no_generate;
+    bool regenerate_one;
+    u32 regenerate_shard;
+
+    /* NOTE(abid): Bit per repetition_target to repetition test on the existing dataset, 0 = none. */
+    u32 reptest_targets;
+    u32 iotest_caches; /* NOTE(abid): Bit per file_read_cache, 0 = no `--iotest`. */
+    u32 iotest_methods; /* NOTE(abid): Bit per file_read_method. */
+    u32 reptest_seconds;
+    bool fresh;
+    i32 pin_core; /* NOTE(abid): -1 = not pinned. */
+    bool perf; /* NOTE(abid): perf counters on the main thread's profiler blocks and repetition tests. */
+    bool probe; /* NOTE(abid): Only run the memory probe (see memory_probe.h). */
+
+    /* NOTE(abid): Sweep mode, see `sweep_datasets`. A list left empty takes its default there. */
+    bool sweep;
+    u32 sweep_seconds;
+    u32 sweep_pairs_count;
+    u32 sweep_clusters_count;
+    u32 sweep_threads_count;
+    u64 sweep_pairs[SWEEP_MAX_VALUES];
+    u64 sweep_clusters[SWEEP_MAX_VALUES];
+    u64 sweep_threads[SWEEP_MAX_VALUES];
+    char *results_filename; /* NOTE(abid): NULL = no results file (see results.h). */
+    u32 probe_seconds;
+    u32 sample_hz; /* NOTE(abid): 0 = no sampling profiler (see sampler.h). */
+    char *sample_filename;
+
+    bool verify; /* NOTE(abid): Only verify the existing dataset against its .f64 answers. */
+    u64 verify_ulp_threshold;
+} run_options;
+
 internal void
-test_json_f64_difference(char *filename) {
-    /* NOTE(abid): Testing, using .f64, whether json parser parses values correctly. */
-    haversine_files loaded_files = load_json_f64_files(filename);
-    json_list *pairs = jp_get_dict_value(loaded_files.json, "pairs", json_list);
-    f64 difference_sum = 0;
-    for(u64 idx = 0; idx < pairs->count; ++idx) {
-        json_dict *elem = jp_get_list_elem(pairs, idx, json_dict);
-        f64 x0 = *jp_get_dict_value(elem, "x0", f64);
-        f64 x1 = *jp_get_dict_value(elem, "x1", f64);
-        f64 y0 = *jp_get_dict_value(elem, "y0", f64);
-        f64 y1 = *jp_get_dict_value(elem, "y1", f64);
-        f64 stored_value = loaded_files.f64_buffer[idx];
-        f64 calc_value = haversine(x0, y0, x1, y1, EARTH_RAIDUS);
-        f64 difference = fabs(stored_value - calc_value);
-        if(difference != 0.0f) {
-            int value = 3;
-            value = 2;
-        }
-        difference_sum += difference;
-        printf("%llu. stored = %f, calculated = %f, difference = %f\n",
-               idx+1, stored_value, calc_value, difference);
-    }
-    printf("\nTotal difference: %f\n", difference_sum);
+benchmark_distance_matrix(run_options *options, pairs_f64 *dataset) {
+    /* NOTE(abid): Distance matrix between the two point sets of the dataset, origins (x0, y0)
+     * against destinations (x1, y1). */
+    pairs_f64 pairs = *dataset;
+    u64 count = pairs.count;
+    u64 padded_count = pairs_padded_count(count);
+    u32 k = (u32)options->matrix_k;
+
+    usize output_bytes = k ? count*k*(sizeof(u32) + sizeof(f64)) : count*padded_count*sizeof(f64);
+    usize arena_bytes = 6*sizeof(f64)*padded_count + output_bytes + 16*PAIRS_ALIGNMENT;
+    /* NOTE(abid): Everything is pushed once up front, so commit it all, a smaller commit would
+     * grow by whole strides past the end of the reservation. */
+    mem_arena *matrix_arena = arena_create(arena_bytes, arena_bytes);
+
+    distance_matrix_job job = {
+        .earth_radius = EARTH_RAIDUS,
+        .thread_count = options->thread_count,
+        .k = k,
+    };
+    u64 cpu_freq = platform_get_cpu_timer_freq_estimate(/*ms_to_wait =*/0);
+
+    u64 prepare_start = platform_get_cpu_timer();
+    point_set origins = point_set_from_degrees(pairs.x0, pairs.y0, count, matrix_arena);
+    point_set destinations = point_set_from_degrees(pairs.x1, pairs.y1, count, matrix_arena);
+    u64 prepare_elapsed = platform_get_cpu_timer() - prepare_start;
+
+    job.rows = &origins;
+    job.cols = &destinations;
+    distance_matrix_alloc_output(&job, matrix_arena);
+
+    u64 compute_start = platform_get_cpu_timer();
+    distance_matrix_compute(&job);
+    u64 compute_elapsed = platform_get_cpu_timer() - compute_start;
+
+    f64 compute_seconds = (f64)compute_elapsed/(f64)cpu_freq;
+    char stage[64];
+    snprintf(stage, sizeof(stage), "distance matrix [k %u, %u threads]", k, job.thread_count);
+    results_add_single("benchmark", stage, 0, compute_elapsed);
+    printf("Distance matrix %llu x %llu (%s, %u threads):\n", count, count,
+           k ? "k nearest" : "full", job.thread_count);
+    if(k) printf("  k: %u\n", k);
+    printf("  Precompute points: %fms\n", 1000.0*(f64)prepare_elapsed/(f64)cpu_freq);
+    printf("  Compute: %fms (%.3f ns/pair)\n", 1000.0*compute_seconds,
+           1e9*compute_seconds/((f64)count*(f64)count));
+
+    /* NOTE(abid): Spot check the first row against the scalar haversine. */
+    if(count) {
+        f64 max_error = 0;
+        f64 nearest = INFINITY;
+        for(u64 col = 0; col < count; ++col) {
+            f64 expected = haversine(pairs.x0[0], pairs.y0[0], pairs.x1[col], pairs.y1[col], EARTH_RAIDUS);
+            if(k == 0) {
+                f64 error = fabs(job.matrix[col] - expected);
+                if(error > max_error) max_error = error;
+            } else if(expected < nearest) nearest = expected;
+        }
+        if(k) max_error = fabs(job.knn_distance[0] - nearest);
+        printf("  Row 0 check against scalar haversine: max abs error %.6e\n", max_error);
+    }
+
+    arena_free(matrix_arena);
 }
 
 internal void
-benchmark_haversine_gen_and_load(u64 number_pairs, u64 num_clusters, char *filename) {
+benchmark_distance_formulas(pairs_f64 *pairs, f64 *reference, u64 cpu_freq) {
+    /* NOTE(abid): One row per distance formula, error is relative to the haversine reference
+     * answers (so for vincenty it is the sphere vs ellipsoid gap, not an error of the kernel). */
+    u64 count = pairs->count;
+    if(count == 0) return;
+
+    usize arena_bytes = sizeof(f64)*pairs_padded_count(count) + 2*PAIRS_ALIGNMENT;
+    mem_arena *formula_arena = arena_create(arena_bytes, arena_bytes);
+    f64 *computed = push_array_aligned(f64, pairs_padded_count(count), PAIRS_ALIGNMENT, formula_arena);
+
+    printf("%-16s %12s %14s %14s %18s\n", "Formula", "ns/pair", "max rel err", "mean rel err", "average");
+    for(u32 formula = 0; formula < df_count; ++formula) {
+        u64 start = platform_get_cpu_timer();
+        f64 sum = distance_sum_f64((distance_formula)formula, pairs, EARTH_RAIDUS, NULL);
+        u64 elapsed = platform_get_cpu_timer() - start;
+
+        distance_sum_f64((distance_formula)formula, pairs, EARTH_RAIDUS, computed);
+        f64 max_rel_error = 0;
+        f64 rel_error_sum = 0;
+        for(u64 idx = 0; idx < count; ++idx) {
+            if(reference[idx] == 0.0) continue;
+            f64 rel_error = fabs(computed[idx] - reference[idx]) / reference[idx];
+            if(rel_error > max_rel_error) max_rel_error = rel_error;
+            rel_error_sum += rel_error;
+        }
+        char stage[64];
+        snprintf(stage, sizeof(stage), "distance [%s]", distance_formula_str[formula]);
+        results_add_single("benchmark", stage, 4*sizeof(f64)*count, elapsed);
+        printf("%-16s %12.3f %14.6e %14.6e %18.6f\n", distance_formula_str[formula],
+               1e9*(f64)elapsed/(f64)cpu_freq/(f64)count, max_rel_error, rel_error_sum/(f64)count,
+               sum/(f64)count);
+    }
+
+    arena_free(formula_arena);
+}
+
+internal void
+benchmark_haversine_gen_and_load(run_options *options) {
     /* NOTE(abid): This benchmarks the time(ms) it takes to:
-     * - Generate haversine values and save them.
-     * - Read and Parse the saved haversine json file.
-     * - Iterate over all haversine pairs and sum their calculation.
+     * - Generate haversine values and save them (json input only).
+     * - Read and Parse the saved haversine json file, or map the .pairs file.
+     * - Extract the pairs into SoA columns of the requested precision.
+     * - Run the haversine kernel over all pairs and sum their calculation.
      */
     u64 cpu_freq = platform_get_cpu_timer_freq_estimate(/*ms_to_wait =*/0);
+    bool from_json = options->input == dsf_json;
+    /* NOTE(abid): Only the tree parser leaves a tree to extract from, the schema parser fills the
+     * f64 dataset while loading and is treated like a mapped .pairs file from there on. */
+    bool from_tree = from_json && options->parser == jsp_tree;
+
+    u64 gen_elapsed = 0;
+    if(from_json) {
+        generator_config gen_config = {
+            .number_pairs = options->num_pairs,
+            .num_clusters = options->num_clusters,
+            .filename = options->filename,
+            .quantize_q32 = options->quantize_q32,
+            .distribution = options->distribution,
+            .output_mode = options->output_mode,
+            .seed = options->seed,
+            .thread_count = options->thread_count,
+        };
+
+        u64 gen_start = platform_get_cpu_timer();
+        generate_haversine_json(&gen_config);
+        gen_elapsed = platform_get_cpu_timer() - gen_start;
+    }
+
+    /* NOTE(abid): `dataset` is the f64 view every later benchmark runs on, the columns of the
+     * requested precision are what gets timed. */
+    u64 load_start = platform_get_cpu_timer();
+    haversine_files loaded_files = {0};
+    pairs_file_mapping mapping = {0};
+    usize reference_size = 0;
+    f64 *reference = NULL;
+    pairs_f64 dataset = {0};
+    usize json_size = 0;
+    char *json_data = NULL;
+    mem_arena *dataset_arena = NULL;
+    /* NOTE(abid): A quantized .pairs maps i32 columns, the q32 kernel takes them as they are, the
+     * other precisions convert them while extracting. */
+    bool mapped_q32 = false;
+    if(from_tree) {
+        loaded_files = load_json_f64_files(options->filename);
+        reference = loaded_files.f64_buffer;
+    } else if(from_json) {
+        char *json_filename = filename_with_extension(options->filename, ".json");
+        json_data = platform_file_map(json_filename, &json_size);
+        assert(json_data || json_size == 0, "cannot map %s.", json_filename);
+        free(json_filename);
+
+        u64 capacity = pairs_json_capacity(json_data, json_size);
+        usize dataset_bytes = 4*sizeof(f64)*pairs_padded_count(capacity) + 4*PAIRS_ALIGNMENT;
+        dataset_arena = arena_create(dataset_bytes, dataset_bytes);
+        json_schema_status status = pairs_f64_from_json_schema(json_data, json_size, capacity,
+                                                               dataset_arena, &dataset);
+        assert(!status.error, "schema parser: %s at byte %llu (record %llu).", status.error, status.offset,
+               status.record);
+
+        char *f64_filename = filename_with_extension(options->filename, ".f64");
+        reference = platform_file_map(f64_filename, &reference_size);
+        free(f64_filename);
+        assert(reference_size == dataset.count*sizeof(f64), ".f64 answers do not match the .json dataset.");
+    } else if(options->compressed) {
+        char *pairs_filename = filename_with_extension(options->filename, ".pairs.hvz");
+        bool mapped = pairs_file_map_compressed(pairs_filename, &mapping, /*verify_columns =*/false,
+                                                options->thread_count);
+        free(pairs_filename);
+        assert(mapped, "cannot load the .pairs.hvz dataset, compress it first.");
+        mapped_q32 = pairs_mapping_is_q32(&mapping);
+        if(!mapped_q32) dataset = pairs_f64_from_mapping(&mapping);
+
+        char *f64_filename = filename_with_extension(options->filename, ".f64.hvz");
+        reference = (f64 *)block_codec_decompress_file(f64_filename, options->thread_count, &reference_size);
+        free(f64_filename);
+        assert(reference_size == mapping.header->count*sizeof(f64), ".f64 answers do not match the .pairs dataset.");
+    } else {
+        char *pairs_filename = filename_with_extension(options->filename, ".pairs");
+        bool mapped = pairs_file_map(pairs_filename, &mapping, /*verify_columns =*/false);
+        free(pairs_filename);
+        assert(mapped, "cannot load the .pairs dataset, generate it first.");
+        mapped_q32 = pairs_mapping_is_q32(&mapping);
+        if(!mapped_q32) dataset = pairs_f64_from_mapping(&mapping);
 
-    u64 gen_start = platform_get_cpu_timer();
-    generate_haversine_json(number_pairs, num_clusters, filename);
-    u64 gen_elapsed = platform_get_cpu_timer() - gen_start;
+        char *f64_filename = filename_with_extension(options->filename, ".f64");
+        reference = platform_file_map(f64_filename, &reference_size);
+        free(f64_filename);
+        assert(reference_size == mapping.header->count*sizeof(f64), ".f64 answers do not match the .pairs dataset.");
+    }
+    u64 load_elapsed = platform_get_cpu_timer() - load_start;
 
-    u64 parse_start = platform_get_cpu_timer();
-    haversine_files loaded_files = load_json_f64_files(filename);
-    u64 parse_elapsed = platform_get_cpu_timer() - parse_start;
+    u64 extract_start = platform_get_cpu_timer();
+    u64 pair_count = dataset.count;
+    if(from_tree) pair_count = (jp_get_dict_value(loaded_files.json, "pairs", json_list))->count;
+    bool fixed_in_place = mapped_q32 && options->precision == pp_q32;
+    if(mapped_q32) {
+        pair_count = mapping.header->count;
+        if(!fixed_in_place) dataset = pairs_f64_from_mapping(&mapping);
+    }
+    /* NOTE(abid): Mapped columns of the requested precision are used in place, nothing to allocate. */
+    usize column_bytes = 4*sizeof(f64)*pairs_padded_count(pair_count) + 4*PAIRS_ALIGNMENT;
+    if(!from_tree && (options->precision == pp_f64 || fixed_in_place)) column_bytes = kilobyte(4);
+    mem_arena *pairs_arena = arena_create(column_bytes, 2*column_bytes);
+    pairs_f64 pairs_wide = {0};
+    pairs_f32 pairs_narrow = {0};
+    pairs_q32 pairs_fixed = {0};
+    switch(options->precision) {
+        case pp_f64: {
+            pairs_wide = from_tree ? pairs_f64_from_json(loaded_files.json, pairs_arena) : dataset;
+        } break;
+        case pp_f32:
+        case pp_mixed: {
+            pairs_narrow = from_tree ? pairs_f32_from_json(loaded_files.json, pairs_arena)
+                                     : pairs_f32_from_f64(&dataset, pairs_arena);
+        } break;
+        case pp_q32: {
+            if(from_tree) pairs_fixed = pairs_q32_from_json(loaded_files.json, pairs_arena);
+            else if(fixed_in_place) pairs_fixed = pairs_q32_from_mapping(&mapping);
+            else pairs_fixed = pairs_q32_from_f64(&dataset, pairs_arena);
+        } break;
+        default: assert(0, "invalid code path");
+    }
+    u64 extract_elapsed = platform_get_cpu_timer() - extract_start;
 
     u64 iterate_start = platform_get_cpu_timer();
-    json_list *pairs = jp_get_dict_value(loaded_files.json, "pairs", json_list);
     f64 sum = 0;
-    for(u64 idx = 0; idx < pairs->count; ++idx) {
-        json_dict *elem = jp_get_list_elem(pairs, idx, json_dict);
-        f64 x0 = *jp_get_dict_value(elem, "x0", f64);
-        f64 x1 = *jp_get_dict_value(elem, "x1", f64);
-        f64 y0 = *jp_get_dict_value(elem, "y0", f64);
-        f64 y1 = *jp_get_dict_value(elem, "y1", f64);
-        f64 value = haversine(x0, y0, x1, y1, EARTH_RAIDUS);
-        sum += value;
+    switch(options->precision) {
+        case pp_f64: { sum = haversine_sum_f64(&pairs_wide, EARTH_RAIDUS, NULL); } break;
+        case pp_f32: { sum = haversine_sum_f32(&pairs_narrow, EARTH_RAIDUS, NULL); } break;
+        case pp_mixed: { sum = haversine_sum_mixed(&pairs_narrow, EARTH_RAIDUS, NULL); } break;
+        case pp_q32: { sum = haversine_sum_q32(&pairs_fixed, EARTH_RAIDUS, NULL); } break;
+        default: assert(0, "invalid code path");
     }
     u64 iterate_elapsed = platform_get_cpu_timer() - iterate_start;
-    u64 total_elapsed = gen_elapsed + parse_elapsed + iterate_elapsed;
+    u64 total_elapsed = gen_elapsed + load_elapsed + extract_elapsed + iterate_elapsed;
 
     printf("Total time: %fms (CPU freq: %llu)\n", 1000.0*(f64)total_elapsed/(f64)cpu_freq, cpu_freq);
-    printf("  Generation: %llu (%.4f%%)\n", gen_elapsed, 100.0*(f64)gen_elapsed/(f64)total_elapsed);
-    printf("  Read JSON: %llu (%.4f%%)\n", parse_elapsed, 100.0*(f64)parse_elapsed/(f64)total_elapsed);
-    printf("  Iterate JSON: %llu (%.4f%%)\n", iterate_elapsed, 100.0*(f64)iterate_elapsed/(f64)total_elapsed);
+    if(from_json) {
+        printf("  Generation: %llu (%.4f%%)\n", gen_elapsed, 100.0*(f64)gen_elapsed/(f64)total_elapsed);
+        printf("  Read JSON [%s]: %llu (%.4f%%)\n", json_parser_str[options->parser], load_elapsed,
+               100.0*(f64)load_elapsed/(f64)total_elapsed);
+    } else if(options->compressed) {
+        printf("  Decode .pairs.hvz: %llu (%.4f%%)\n", load_elapsed, 100.0*(f64)load_elapsed/(f64)total_elapsed);
+    } else printf("  Map .pairs: %llu (%.4f%%)\n", load_elapsed, 100.0*(f64)load_elapsed/(f64)total_elapsed);
+    printf("  Extract pairs [%s]: %llu (%.4f%%)\n", pair_precision_str[options->precision],
+           extract_elapsed, 100.0*(f64)extract_elapsed/(f64)total_elapsed);
+    printf("  Haversine sum [%s]: %llu (%.4f%%)\n", pair_precision_str[options->precision],
+           iterate_elapsed, 100.0*(f64)iterate_elapsed/(f64)total_elapsed);
+    if(pair_count) printf("Average: %.12f\n\n", sum/(f64)pair_count);
+
+    char stage[64];
+    if(from_json) results_add_single("benchmark", "generation", 0, gen_elapsed);
+    snprintf(stage, sizeof(stage), "load [%s%s]", dataset_format_str[options->input],
+             from_json ? (from_tree ? ", tree" : ", schema") : (options->compressed ? ", hvz" : ""));
+    results_add_single("benchmark", stage, 0, load_elapsed);
+    snprintf(stage, sizeof(stage), "extract [%s]", pair_precision_str[options->precision]);
+    results_add_single("benchmark", stage, 0, extract_elapsed);
+    snprintf(stage, sizeof(stage), "haversine sum [%s]", pair_precision_str[options->precision]);
+    results_add_single("benchmark", stage, 0, iterate_elapsed);
+
+    /* NOTE(abid): Error report against the .f64 reference answers, outside of the timed region. */
+    f64 *computed = malloc(pairs_padded_count(pair_count)*sizeof(f64));
+    switch(options->precision) {
+        case pp_f64: { haversine_sum_f64(&pairs_wide, EARTH_RAIDUS, computed); } break;
+        case pp_f32: { haversine_sum_f32(&pairs_narrow, EARTH_RAIDUS, computed); } break;
+        case pp_mixed: { haversine_sum_mixed(&pairs_narrow, EARTH_RAIDUS, computed); } break;
+        case pp_q32: { haversine_sum_q32(&pairs_fixed, EARTH_RAIDUS, computed); } break;
+        default: assert(0, "invalid code path");
+    }
+    precision_report report = haversine_precision_report(computed, reference, pair_count);
+    precision_report_print(&report, options->precision);
+    if(options->precision == pp_q32) {
+        printf("  Quantization bound: %.1e km per pair (exact for --quantize datasets)\n",
+               COORD_Q32_MAX_DISTANCE_ERROR_KM);
+    }
+    free(computed);
+
+    if(from_tree) dataset = (options->precision == pp_f64) ? pairs_wide
+                                                           : pairs_f64_from_json(loaded_files.json, pairs_arena);
+    if(fixed_in_place) dataset = pairs_f64_from_mapping(&mapping);
+
+    printf("\n");
+    benchmark_distance_formulas(&dataset, reference, cpu_freq);
+
+    if(options->matrix_k >= 0) {
+        printf("\n");
+        benchmark_distance_matrix(options, &dataset);
+    }
+
+    arena_free(pairs_arena);
+    if(dataset_arena) arena_free(dataset_arena);
+    if(json_data) platform_file_unmap(json_data, json_size);
+    if(!from_tree) {
+        pairs_file_unmap(&mapping);
+        if(reference && options->compressed) platform_free(reference, reference_size);
+        else if(reference) platform_file_unmap(reference, reference_size);
+    }
+}
+
+/* NOTE(abid): Converts `filename`.json to `filename`.pairs or back, the JSON written from a .pairs
+ * file uses the generator's formatting (shortest round-trip digits). */
+internal void
+convert_dataset(char *filename, dataset_format to) {
+    char *json_filename = filename_with_extension(filename, ".json");
+    char *pairs_filename = filename_with_extension(filename, ".pairs");
+    u64 cpu_freq = platform_get_cpu_timer_freq_estimate(/*ms_to_wait =*/0);
+    u64 start = platform_get_cpu_timer();
+
+    u64 count = 0;
+    if(to == dsf_pairs) {
+        json_dict *json = jp_load(json_filename);
+        count = (jp_get_dict_value(json, "pairs", json_list))->count;
+        usize column_bytes = 4*sizeof(f64)*pairs_padded_count(count) + 4*PAIRS_ALIGNMENT;
+        mem_arena *pairs_arena = arena_create(column_bytes, column_bytes);
+        pairs_f64 pairs = pairs_f64_from_json(json, pairs_arena);
+        pairs_f64_write_file(pairs_filename, &pairs, /*seed =*/0, /*num_clusters =*/0, PAIRS_FILE_FLAG_CONVERTED);
+        arena_free(pairs_arena);
+    } else {
+        pairs_file_mapping mapping;
+        bool mapped = pairs_file_map(pairs_filename, &mapping, /*verify_columns =*/true);
+        assert(mapped, "cannot convert %s.", pairs_filename);
+        pairs_f64 pairs = pairs_f64_from_mapping(&mapping);
+        count = pairs.count;
+
+        file_writer *json_writer = file_writer_open(json_filename, fwm_buffered);
+        char *prefix = "{\"pairs\":[\n";
+        file_writer_write(json_writer, prefix, strlen(prefix));
+        if(count == 0) file_writer_write(json_writer, "]}", 2);
+        for(u64 idx = 0; idx < count; ++idx) {
+            char *dest = file_writer_reserve(json_writer, GENERATOR_MAX_PAIR_LEN);
+            usize len = generator_format_pair(dest, pairs.y0[idx], pairs.y1[idx], pairs.x0[idx], pairs.x1[idx],
+                                              FLOAT_FORMAT_SHORTEST, idx + 1 == count);
+            file_writer_commit(json_writer, len);
+        }
+        file_writer_close(json_writer);
+        pairs_file_unmap(&mapping);
+    }
+
+    u64 elapsed = platform_get_cpu_timer() - start;
+    printf("Converted %llu pairs to %s in %fms\n", count, (to == dsf_pairs) ? pairs_filename : json_filename,
+           1000.0*(f64)elapsed/(f64)cpu_freq);
+    free(json_filename);
+    free(pairs_filename);
+}
+
+/* NOTE(abid): Re-formats `filename`.json into `filename`.min.json or `filename`.pretty.json. */
+internal void
+transcode_dataset(char *filename, json_transcode_mode mode) {
+    char *json_filename = filename_with_extension(filename, ".json");
+    char *output_filename = filename_with_extension(filename, (mode == jtm_minify) ? ".min.json" : ".pretty.json");
+    u64 cpu_freq = platform_get_cpu_timer_freq_estimate(/*ms_to_wait =*/0);
+
+    u64 start = platform_get_cpu_timer();
+    json_transcode_stats stats = json_transcode_file(json_filename, output_filename, mode);
+    u64 elapsed = platform_get_cpu_timer() - start;
+
+    f64 seconds = (f64)elapsed/(f64)cpu_freq;
+    printf("%s -> %s [%s]: %llu -> %llu bytes (%.2f%%) in %fms, %.1f MB/s\n", json_filename, output_filename,
+           json_transcode_mode_str[mode], stats.bytes_in, stats.bytes_out,
+           stats.bytes_in ? 100.0*(f64)stats.bytes_out/(f64)stats.bytes_in : 0.0, 1000.0*seconds,
+           (f64)stats.bytes_in/(1024.0*1024.0)/seconds);
+    free(json_filename);
+    free(output_filename);
+}
+
+/* NOTE(abid): Writes block compressed copies (.hvz, see block_codec.h) of the binary dataset files,
+ * then decodes them again to time the loader side. */
+internal void
+compress_dataset(char *filename, u32 thread_count) {
+    char *extensions[] = {".pairs", ".f64"};
+    u64 cpu_freq = platform_get_cpu_timer_freq_estimate(/*ms_to_wait =*/0);
+
+    for(u32 idx = 0; idx < array_size(extensions); ++idx) {
+        char *raw_filename = filename_with_extension(filename, extensions[idx]);
+        usize compressed_len = strlen(raw_filename) + 5;
+        char *compressed_filename = malloc(compressed_len);
+        snprintf(compressed_filename, compressed_len, "%s.hvz", raw_filename);
+
+        u64 start = platform_get_cpu_timer();
+        u64 stored_size = block_codec_compress_file(raw_filename, compressed_filename, thread_count);
+        u64 encode_elapsed = platform_get_cpu_timer() - start;
+
+        start = platform_get_cpu_timer();
+        usize raw_size = 0;
+        u8 *decoded = block_codec_decompress_file(compressed_filename, thread_count, &raw_size);
+        u64 decode_elapsed = platform_get_cpu_timer() - start;
+        assert(decoded || raw_size == 0, "cannot decode %s.", compressed_filename);
+
+        usize original_size = 0;
+        u8 *original = platform_file_map(raw_filename, &original_size);
+        assert(original_size == raw_size && (raw_size == 0 || memcmp(original, decoded, raw_size) == 0),
+               "%s does not round-trip.", compressed_filename);
+        if(original) platform_file_unmap(original, original_size);
+        if(decoded) platform_free(decoded, raw_size);
+
+        f64 encode_s = (f64)encode_elapsed/(f64)cpu_freq;
+        f64 decode_s = (f64)decode_elapsed/(f64)cpu_freq;
+        printf("%s: %llu -> %llu bytes (%.3fx), encode %.1f MB/s, decode %.1f MB/s\n", compressed_filename,
+               (u64)raw_size, stored_size, stored_size ? (f64)raw_size/(f64)stored_size : 0.0,
+               (f64)raw_size/(1024.0*1024.0)/encode_s, (f64)raw_size/(1024.0*1024.0)/decode_s);
+
+        free(compressed_filename);
+        free(raw_filename);
+    }
+}
+
+typedef struct {
+    bool ok;
+    char *error;
+    f64 sum;
+    u64 cycles;
+    bool retried;
+} shard_result;
+
+typedef struct {
+    char *filename;
+    dataset_format input;
+    shard_manifest *manifest;
+    shard_result *results;
+    volatile u64 next_shard;
+} shard_load_job;
+
+/* NOTE(abid): Loads one shard from its .json or .pairs file, checks every file against the
+ * manifest (size and checksum) and the haversine sum of its pairs against the expected sum. */
+internal shard_result
+shard_load(char *filename, shard_manifest *manifest, u32 shard, dataset_format input) {
+    shard_entry *entry = manifest->shards + shard;
+    shard_result result = {0};
+    u64 start = platform_get_cpu_timer();
+
+    u64 size = 0, checksum = 0;
+    char *f64_filename = shard_filename(filename, manifest->shard_count, shard, ".f64");
+    if(!stream_checksum_file(f64_filename, &size, &checksum)) result.error = "missing .f64";
+    else if(size != entry->f64_bytes || checksum != entry->f64_checksum) result.error = ".f64 checksum mismatch";
+    free(f64_filename);
+
+    if(!result.error && input == dsf_json) {
+        char *json_filename = shard_filename(filename, manifest->shard_count, shard, ".json");
+        if(!stream_checksum_file(json_filename, &size, &checksum)) result.error = "missing .json";
+        else if(size != entry->json_bytes || checksum != entry->json_checksum) result.error = ".json checksum mismatch";
+
+        if(!result.error) {
+            json_dict *json = jp_load(json_filename);
+            u64 count = (jp_get_dict_value(json, "pairs", json_list))->count;
+            usize column_bytes = 4*sizeof(f64)*pairs_padded_count(count) + 4*PAIRS_ALIGNMENT;
+            mem_arena *pairs_arena = arena_create(column_bytes, column_bytes);
+            pairs_f64 pairs = pairs_f64_from_json(json, pairs_arena);
+            if(count != entry->count) result.error = "pair count mismatch";
+            else result.sum = haversine_sum_f64(&pairs, EARTH_RAIDUS, NULL);
+            arena_free(pairs_arena);
+        }
+        free(json_filename);
+    } else if(!result.error) {
+        char *pairs_filename = shard_filename(filename, manifest->shard_count, shard, ".pairs");
+        pairs_file_mapping mapping;
+        if(!pairs_file_map(pairs_filename, &mapping, /*verify_columns =*/true)) result.error = "bad .pairs";
+        else if(mapping.size != entry->pairs_bytes || mapping.header->header_checksum != entry->pairs_checksum ||
+                mapping.header->count != entry->count) {
+            result.error = ".pairs checksum mismatch";
+        } else if(pairs_mapping_is_q32(&mapping)) {
+            pairs_q32 pairs = pairs_q32_from_mapping(&mapping);
+            result.sum = haversine_sum_q32(&pairs, EARTH_RAIDUS, NULL);
+        } else {
+            pairs_f64 pairs = pairs_f64_from_mapping(&mapping);
+            result.sum = haversine_sum_f64(&pairs, EARTH_RAIDUS, NULL);
+        }
+        pairs_file_unmap(&mapping);
+        free(pairs_filename);
+    }
+
+    if(!result.error && fabs(result.sum - entry->expected_sum) > SHARD_SUM_TOLERANCE*fabs(entry->expected_sum)) {
+        result.error = "partial sum mismatch";
+    }
+    result.ok = result.error == NULL;
+    result.cycles = platform_get_cpu_timer() - start;
+
+    return result;
+}
+
+internal THREAD_PROC(shard_load_worker) {
+    shard_load_job *job = (shard_load_job *)param;
+    while(true) {
+        u64 shard = platform_atomic_add_u64(&job->next_shard, 1);
+        if(shard >= job->manifest->shard_count) break;
+        job->results[shard] = shard_load(job->filename, job->manifest, (u32)shard, job->input);
+    }
+
+    return 0;
+}
+
+/* NOTE(abid): Generates the shards (json input) and loads them concurrently, one shard per
+ * worker at a time. A failed shard is retried once on its own, if it fails again it has to be
+ * regenerated with --regenerate-shard. Returns the number of failed shards. */
+internal u32
+benchmark_shards(run_options *options) {
+    u64 cpu_freq = platform_get_cpu_timer_freq_estimate(/*ms_to_wait =*/0);
+
+    u64 gen_elapsed = 0;
+    if(options->input == dsf_json && !options->no_generate) {
+        generator_config gen_config = {
+            .number_pairs = options->num_pairs,
+            .num_clusters = options->num_clusters,
+            .filename = options->filename,
+            .quantize_q32 = options->quantize_q32,
+            .distribution = options->distribution,
+            .output_mode = options->output_mode,
+            .seed = options->seed,
+            .thread_count = options->thread_count,
+            .shard_count = options->shard_count,
+        };
+
+        u64 gen_start = platform_get_cpu_timer();
+        generate_haversine_json(&gen_config);
+        gen_elapsed = platform_get_cpu_timer() - gen_start;
+    }
+
+    shard_manifest manifest;
+    bool read = shard_manifest_read(options->filename, &manifest);
+    assert(read, "cannot load the shard manifest, generate the shards first.");
+
+    shard_load_job job = {
+        .filename = options->filename,
+        .input = options->input,
+        .manifest = &manifest,
+        .results = calloc(manifest.shard_count + 1, sizeof(shard_result)),
+    };
+    u32 thread_count = options->thread_count ? options->thread_count : platform_cpu_count();
+    if(thread_count > manifest.shard_count) thread_count = manifest.shard_count ? manifest.shard_count : 1;
+
+    /* NOTE(abid): The calling thread is worker zero. */
+    u64 load_start = platform_get_cpu_timer();
+    platform_thread *threads = malloc(sizeof(platform_thread)*thread_count);
+    for(u32 idx = 0; idx < thread_count - 1; ++idx) threads[idx] = platform_thread_create(shard_load_worker, &job);
+    shard_load_worker(&job);
+    for(u32 idx = 0; idx < thread_count - 1; ++idx) platform_thread_join(threads[idx]);
+    free(threads);
+    u64 load_elapsed = platform_get_cpu_timer() - load_start;
+
+    u32 failed = 0;
+    f64 sum = 0, expected_sum = 0;
+    for(u32 shard = 0; shard < manifest.shard_count; ++shard) {
+        shard_result *result = job.results + shard;
+        if(!result->ok) {
+            *result = shard_load(options->filename, &manifest, shard, options->input);
+            result->retried = true;
+        }
+        failed += !result->ok;
+        sum += result->sum;
+        expected_sum += manifest.shards[shard].expected_sum;
+    }
+
+    char stage[64];
+    if(gen_elapsed) results_add_single("benchmark", "shard generation", 0, gen_elapsed);
+    snprintf(stage, sizeof(stage), "shard load and sum [%s, %u threads]", dataset_format_str[options->input],
+             thread_count);
+    results_add_single("benchmark", stage, 0, load_elapsed);
+
+    printf("Total time: %fms (CPU freq: %llu)\n", 1000.0*(f64)(gen_elapsed + load_elapsed)/(f64)cpu_freq, cpu_freq);
+    if(gen_elapsed) printf("  Generation [%u shards]: %llu\n", manifest.shard_count, gen_elapsed);
+    printf("  Load and sum [%s, %u threads]: %llu\n", dataset_format_str[options->input], thread_count, load_elapsed);
+    for(u32 shard = 0; shard < manifest.shard_count; ++shard) {
+        shard_result *result = job.results + shard;
+        shard_entry *entry = manifest.shards + shard;
+        printf("  shard %u: pairs [%llu, %llu) %fms %s%s%s\n", shard, entry->first_pair, entry->first_pair + entry->count,
+               1000.0*(f64)result->cycles/(f64)cpu_freq, result->ok ? "ok" : "FAILED: ", result->ok ? "" : result->error,
+               result->retried ? (result->ok ? " (after retry)" : ", regenerate with --regenerate-shard") : "");
+    }
+    if(manifest.number_pairs) {
+        printf("Average: %.12f (expected %.12f)\n", sum/(f64)manifest.number_pairs,
+               expected_sum/(f64)manifest.number_pairs);
+    }
+    printf("%u of %u shards failed\n", failed, manifest.shard_count);
+
+    free(job.results);
+    free(manifest.shards);
+    return failed;
+}
+
+/* NOTE(abid): Rewrites one shard with the settings recorded in the manifest and checks both of its
+ * formats against the manifest entry. */
+internal bool
+regenerate_shard(run_options *options) {
+    shard_manifest manifest;
+    bool read = shard_manifest_read(options->filename, &manifest);
+    assert(read, "cannot regenerate without the shard manifest.");
+    assert(options->regenerate_shard < manifest.shard_count, "the manifest has %u shards.", manifest.shard_count);
+
+    generator_config gen_config = {
+        .number_pairs = manifest.number_pairs,
+        .num_clusters = manifest.num_clusters,
+        .filename = options->filename,
+        .quantize_q32 = manifest.quantize_q32,
+        .distribution = (generator_distribution)manifest.distribution,
+        .output_mode = options->output_mode,
+        .seed = manifest.seed,
+        .thread_count = options->thread_count,
+        .shard_count = manifest.shard_count,
+        .regenerate_one = true,
+        .regenerate_shard = options->regenerate_shard,
+    };
+    generate_haversine_json(&gen_config);
+
+    shard_result json_result = shard_load(options->filename, &manifest, options->regenerate_shard, dsf_json);
+    shard_result pairs_result = shard_load(options->filename, &manifest, options->regenerate_shard, dsf_pairs);
+    printf("Regenerated shard %u: json %s, pairs %s\n", options->regenerate_shard,
+           json_result.ok ? "ok" : json_result.error, pairs_result.ok ? "ok" : pairs_result.error);
+    free(manifest.shards);
+
+    return json_result.ok && pairs_result.ok;
+}
+
+/* NOTE(abid): Repetition test targets, see repetition_tester.h. `fresh` runs get new buffers
+ * every time, so their page faults land inside the timed region, otherwise the buffers are
+ * allocated and touched once up front. */
+internal void
+reptest_read(repetition_tester *tester, char *filename, u64 cpu_freq, u32 seconds, bool fresh,
+             perf_counters *counters) {
+    usize size = platform_file_64bit_get_size(filename);
+    char *buffer = NULL;
+    if(!fresh) {
+        buffer = platform_allocate(size + 1);
+        memset(buffer, 0, size + 1);
+    }
+
+    repetition_new_wave(tester, size, cpu_freq, seconds, counters);
+    while(repetition_is_testing(tester)) {
+        char *dest = fresh ? platform_allocate(size + 1) : buffer;
+        FILE *handle = fopen(filename, "rb");
+        if(!handle) {
+            repetition_error(tester, "cannot open the file");
+        } else {
+            repetition_begin_time(tester);
+            usize read = fread(dest, 1, size, handle);
+            repetition_end_time(tester);
+            fclose(handle);
+
+            if(read == size) repetition_count_bytes(tester, read);
+            else repetition_error(tester, "short read");
+        }
+        if(fresh) platform_free(dest, size + 1);
+    }
+
+    if(buffer) platform_free(buffer, size + 1);
+}
+
+/* NOTE(abid): Lexer and parser run over the file read once. The parser consumes the lexer's
+ * scopes, so every parser run is lexed again first, untimed. */
+internal void
+reptest_json(repetition_tester *tester, char *filename, bool parse, u64 cpu_freq, u32 seconds, bool fresh,
+             perf_counters *counters) {
+    usize size = platform_file_64bit_get_size(filename);
+    char *json_data = platform_allocate(size + 1);
+    FILE *handle = fopen(filename, "rb");
+    assert(handle && fread(json_data, 1, size, handle) == size, "cannot read %s.", filename);
+    fclose(handle);
+
+    mem_arena *temp_arena = fresh ? NULL : arena_create(megabyte(10), (u64)(platform_ram_get_size()/2));
+    repetition_new_wave(tester, size, cpu_freq, seconds, counters);
+    while(repetition_is_testing(tester)) {
+        mem_arena *arena = fresh ? arena_create(megabyte(10), (u64)(platform_ram_get_size()/2)) : temp_arena;
+        temp_memory temp = mem_temp_begin(arena);
+        buffer json_buffer = { .str = json_data };
+        parser_state state = { .temp_arena = arena };
+
+        if(!parse) repetition_begin_time(tester);
+        jp_lexer(&json_buffer, &state);
+        if(!parse) repetition_end_time(tester);
+
+        if(parse) {
+            repetition_begin_time(tester);
+            jp_parser(&state);
+            repetition_end_time(tester);
+            arena_free(state.json_arena);
+        }
+        repetition_count_bytes(tester, size);
+
+        mem_temp_end(temp);
+        if(fresh) arena_free(arena);
+    }
+
+    if(temp_arena) arena_free(temp_arena);
+    platform_free(json_data, size + 1);
+}
+
+/* NOTE(abid): Parses the mapped .json straight into columns, the json is read through once before
+ * the wave so its pages are in. */
+internal void
+reptest_schema(repetition_tester *tester, char *filename, u64 cpu_freq, u32 seconds, bool fresh,
+               perf_counters *counters) {
+    usize size = 0;
+    char *json_data = platform_file_map(filename, &size);
+    assert(json_data, "cannot map %s.", filename);
+    u64 capacity = pairs_json_capacity(json_data, size);
+    usize dataset_bytes = 4*sizeof(f64)*pairs_padded_count(capacity) + 4*PAIRS_ALIGNMENT;
+
+    mem_arena *dataset_arena = fresh ? NULL : arena_create(dataset_bytes, dataset_bytes);
+    repetition_new_wave(tester, size, cpu_freq, seconds, counters);
+    while(repetition_is_testing(tester)) {
+        mem_arena *arena = fresh ? arena_create(kilobyte(4), dataset_bytes + kilobyte(4)) : dataset_arena;
+        temp_memory temp = mem_temp_begin(arena);
+        pairs_f64 pairs;
+
+        repetition_begin_time(tester);
+        json_schema_status status = pairs_f64_from_json_schema(json_data, size, capacity, arena, &pairs);
+        repetition_end_time(tester);
+
+        if(status.error) repetition_error(tester, status.error);
+        else repetition_count_bytes(tester, size);
+        mem_temp_end(temp);
+        if(fresh) arena_free(arena);
+    }
+
+    if(dataset_arena) arena_free(dataset_arena);
+    platform_file_unmap(json_data, size);
+}
+
+/* NOTE(abid): More than one thread splits the columns with `haversine_sum_f64_parallel`, the
+ * threads are created inside the timed region. A quantized file runs the q32 kernel on its mapped
+ * i32 columns, so it moves half the bytes. */
+internal void
+reptest_haversine(repetition_tester *tester, char *filename, u64 cpu_freq, u32 seconds, bool fresh,
+                  u32 thread_count, perf_counters *counters) {
+    char *pairs_filename = filename_with_extension(filename, ".pairs");
+    pairs_file_mapping mapping = {0};
+    bool mapped = pairs_file_map(pairs_filename, &mapping, /*verify_columns =*/false);
+    assert(mapped, "cannot map %s, generate it first.", pairs_filename);
+    bool quantized = pairs_mapping_is_q32(&mapping);
+    pairs_f64 pairs = {0};
+    pairs_q32 fixed = {0};
+    if(quantized) fixed = pairs_q32_from_mapping(&mapping);
+    else pairs = pairs_f64_from_mapping(&mapping);
+    u64 bytes = 4*pairs_file_element_size(mapping.header->flags)*mapping.header->count;
+
+    /* NOTE(abid): Keeps the sums alive. */
+    volatile f64 sink = quantized ? haversine_sum_q32(&fixed, EARTH_RAIDUS, NULL)
+                                  : haversine_sum_f64(&pairs, EARTH_RAIDUS, NULL);
+    repetition_new_wave(tester, bytes, cpu_freq, seconds, counters);
+    while(repetition_is_testing(tester)) {
+        if(fresh) {
+            pairs_file_unmap(&mapping);
+            mapped = pairs_file_map(pairs_filename, &mapping, /*verify_columns =*/false);
+            if(!mapped) {
+                repetition_error(tester, "cannot map the .pairs file");
+                break;
+            }
+            if(quantized) fixed = pairs_q32_from_mapping(&mapping);
+            else pairs = pairs_f64_from_mapping(&mapping);
+        }
+        repetition_begin_time(tester);
+        if(quantized) sink += haversine_sum_q32_parallel(&fixed, EARTH_RAIDUS, thread_count);
+        else sink += haversine_sum_f64_parallel(&pairs, EARTH_RAIDUS, thread_count);
+        repetition_end_time(tester);
+        repetition_count_bytes(tester, bytes);
+    }
+
+    pairs_file_unmap(&mapping);
+    free(pairs_filename);
+}
+
+internal bool
+reptest_dataset(run_options *options, perf_counters *counters) {
+    if(options->pin_core >= 0 && !platform_thread_pin_to_core((u32)options->pin_core)) {
+        printf("Cannot pin to core %d, running unpinned.\n", options->pin_core);
+    }
+    u64 cpu_freq = platform_get_cpu_timer_freq_estimate(/*ms_to_wait =*/0);
+    char *json_filename = filename_with_extension(options->filename, ".json");
+    memory_limits limits;
+    char *limits_filename = memory_probe_filename();
+    memory_probe_load(&limits, limits_filename);
+    free(limits_filename);
+
+    bool ok = true;
+    for(u32 target = 0; target < rtt_count; ++target) {
+        if(!(options->reptest_targets & (1u << target))) continue;
+
+        repetition_tester tester = {0};
+        f64 cached = platform_file_cached_fraction(json_filename);
+        switch(target) {
+            case rtt_read: {
+                reptest_read(&tester, json_filename, cpu_freq, options->reptest_seconds, options->fresh, counters);
+            } break;
+            case rtt_lexer:
+            case rtt_parser: {
+                reptest_json(&tester, json_filename, target == rtt_parser, cpu_freq, options->reptest_seconds,
+                             options->fresh, counters);
+            } break;
+            case rtt_schema: {
+                reptest_schema(&tester, json_filename, cpu_freq, options->reptest_seconds, options->fresh, counters);
+            } break;
+            case rtt_haversine: {
+                reptest_haversine(&tester, options->filename, cpu_freq, options->reptest_seconds, options->fresh,
+                                  /*thread_count =*/1, counters);
+            } break;
+            default: assert(0, "invalid code path");
+        }
+
+        char label[64];
+        snprintf(label, sizeof(label), "%s (%s)", repetition_target_str[target],
+                 options->fresh ? "fresh" : "pre-touched");
+        repetition_print_results(&tester, label);
+        if(target == rtt_read && cached >= 0.0) {
+            printf("  Page cache: %.1f%% of the file resident before the first run (--iotest for cold reads)\n",
+                   100.0*cached);
+        }
+        repetition_add_result(&tester, "reptest", label);
+        /* NOTE(abid): fread copies out of the page cache, the others stream their input. */
+        memory_limits_print_share(&limits, target == rtt_read ? mpo_copy : mpo_read, &tester);
+        ok &= tester.state != rts_error;
+        repetition_release(&tester);
+    }
+    free(json_filename);
+
+    return ok;
+}
+
+/* NOTE(abid): Every selected read method under every selected cache mode (see file_reader.h) on
+ * the dataset's .json, one repetition test each. The first run is the first-load latency (for
+ * warm the file was read once before it), the cached column is how much of the file was in the
+ * page cache when the first run started, which says whether cold really was cold. */
+internal bool
+reptest_io(run_options *options, perf_counters *counters) {
+    if(options->pin_core >= 0 && !platform_thread_pin_to_core((u32)options->pin_core)) {
+        printf("Cannot pin to core %d, running unpinned.\n", options->pin_core);
+    }
+    u64 cpu_freq = platform_get_cpu_timer_freq_estimate(/*ms_to_wait =*/0);
+    char *json_filename = filename_with_extension(options->filename, ".json");
+    u32 methods = options->iotest_methods ? options->iotest_methods : (1u << frm_count) - 1;
+    f64 ms_per_cycle = 1000.0/(f64)cpu_freq;
+
+    bool ok = true;
+    char size_label[32];
+    memory_probe_size_label(size_label, sizeof(size_label), platform_file_64bit_get_size(json_filename));
+    printf("I/O: %s (%s)\n%-14s %-7s %7s %11s %11s %11s %9s %9s\n", json_filename, size_label, "method", "cache",
+           "cached", "first ms", "min ms", "p50 ms", "min GB/s", "p50 GB/s");
+    for(u32 cache = 0; cache < frc_count; ++cache) {
+        if(!(options->iotest_caches & (1u << cache))) continue;
+        for(u32 method = 0; method < frm_count; ++method) {
+            if(!(methods & (1u << method))) continue;
+
+            file_reader reader = file_reader_create(json_filename, (file_read_method)method, (file_read_cache)cache);
+            if(reader.error) {
+                printf("%-14s %-7s   n/a (%s)\n", file_read_method_str[method], file_read_cache_str[cache], reader.error);
+                continue;
+            }
+
+            repetition_tester tester = {0};
+            f64 cached = -1.0;
+            u64 first_run = 0;
+            repetition_new_wave(&tester, reader.size, cpu_freq, options->reptest_seconds, counters);
+            while(repetition_is_testing(&tester)) {
+                if(!file_reader_prepare(&reader)) {
+                    repetition_error(&tester, reader.error);
+                    break;
+                }
+                if(cached < 0.0) cached = platform_file_cached_fraction(json_filename);
+
+                repetition_begin_time(&tester);
+                usize read = file_reader_read(&reader);
+                repetition_end_time(&tester);
+                file_reader_finish(&reader);
+
+                if(!first_run) first_run = tester.time_accumulated;
+                if(read == reader.size) repetition_count_bytes(&tester, read);
+                else repetition_error(&tester, "short read");
+            }
+            file_reader_finish(&reader);
+
+            printf("\r%-14s %-7s ", file_read_method_str[method], file_read_cache_str[cache]);
+            if(tester.state == rts_error) {
+                printf("  ERROR (%s)                                                   \n", tester.error);
+                ok = false;
+            } else {
+                repetition_results *results = &tester.results;
+                f64 p50 = (f64)stat_histogram_percentile(results->histogram, 50.0);
+                f64 gigabytes = (f64)reader.size/(f64)gigabyte(1);
+                if(cached >= 0.0) printf("%6.1f%% ", 100.0*cached);
+                else printf("%7s ", "?");
+                printf("%11.3f %11.3f %11.3f %9.3f %9.3f                    \n", ms_per_cycle*(f64)first_run,
+                       ms_per_cycle*(f64)results->min_time, ms_per_cycle*p50,
+                       gigabytes/((f64)results->min_time/(f64)cpu_freq), gigabytes/(p50/(f64)cpu_freq));
+
+                char label[64];
+                snprintf(label, sizeof(label), "%s %s", file_read_method_str[method], file_read_cache_str[cache]);
+                repetition_add_result(&tester, "iotest", label);
+            }
+            repetition_release(&tester);
+            file_reader_destroy(&reader);
+        }
+    }
+    free(json_filename);
+
+    return ok;
+}
+
+/* NOTE(abid): One line of the sweep, also a results row. Returns the GB/s of the fastest run. */
+internal f64
+sweep_report(repetition_tester *tester, char *stage, u64 pairs, u64 clusters, u32 threads, u64 working_set,
+             u64 *cache_sizes, f64 baseline) {
+    f64 seconds = memory_probe_min_seconds(tester);
+    f64 throughput = (seconds > 0.0) ? (f64)tester->target_bytes/(f64)gigabyte(1)/seconds : 0.0;
+
+    char *level = "DRAM";
+    for(i32 cache = CPU_CACHE_LEVELS - 1; cache >= 0; --cache) {
+        if(cache_sizes[cache] && working_set <= cache_sizes[cache]) level = cache == 0 ? "L1" : cache == 1 ? "L2" : "L3";
+    }
+    char size_label[32];
+    memory_probe_size_label(size_label, sizeof(size_label), working_set);
+    printf("\r%12llu %9llu  %-10s %7u %10s %5s %11.3f %9.3f %9.2f", pairs, clusters, stage, threads, size_label,
+           level, 1000.0*seconds, throughput, pairs ? 1e9*seconds/(f64)pairs : 0.0);
+    if(baseline > 0.0) printf(" %7.2fx", throughput/baseline);
+    printf("%s\n", tester->state == rts_error ? "  ERROR" : "                    ");
+
+    char label[128];
+    snprintf(label, sizeof(label), "%s p=%llu c=%llu t=%u", stage, pairs, clusters, threads);
+    repetition_add_result(tester, "sweep", label);
+
+    return throughput;
+}
+
+/* NOTE(abid): Runs the pipeline stages over every (pair count, cluster count) and the haversine
+ * kernel over every thread count. Datasets are generated once and cached under
+ * `<filename>_<distribution>_s<seed>_p<pairs>_c<clusters>`, later sweeps reuse them. Each stage is
+ * a repetition test, so the curves are minimums. Defaults: pair counts in decades from 1e3 up to
+ * the pair count argument, the cluster count argument, and thread counts in powers of two up to
+ * the core count. The working set column says which cache level the stage's data fits in, the
+ * summary at the end has one throughput curve per stage (and per thread count). */
+internal void
+sweep_datasets(run_options *options) {
+    if(!options->sweep_pairs_count) {
+        for(u64 pairs = SWEEP_FIRST_PAIRS; pairs < options->num_pairs && options->sweep_pairs_count < SWEEP_MAX_VALUES - 1;
+            pairs *= 10) {
+            options->sweep_pairs[options->sweep_pairs_count++] = pairs;
+        }
+        options->sweep_pairs[options->sweep_pairs_count++] = options->num_pairs;
+    }
+    if(!options->sweep_clusters_count) options->sweep_clusters[options->sweep_clusters_count++] = options->num_clusters;
+    if(!options->sweep_threads_count) {
+        u32 cpu_count = platform_cpu_count();
+        for(u32 threads = 1; threads < cpu_count && options->sweep_threads_count < SWEEP_MAX_VALUES - 1; threads *= 2) {
+            options->sweep_threads[options->sweep_threads_count++] = threads;
+        }
+        options->sweep_threads[options->sweep_threads_count++] = cpu_count;
+    }
+
+    u64 cache_sizes[CPU_CACHE_LEVELS];
+    platform_cache_sizes(cache_sizes);
+    u64 cpu_freq = platform_get_cpu_timer_freq_estimate(/*ms_to_wait =*/0);
+    u32 columns = 2 + options->sweep_threads_count;
+    u32 pairs_count = options->sweep_pairs_count, clusters_count = options->sweep_clusters_count;
+    f64 *throughput = calloc((usize)pairs_count*clusters_count*columns, sizeof(f64));
+
+    printf("Sweep: %u pair counts x %u cluster counts, %u thread counts, caches", pairs_count, clusters_count,
+           options->sweep_threads_count);
+    for(u32 cache = 0; cache < CPU_CACHE_LEVELS; ++cache) {
+        char size_label[32];
+        memory_probe_size_label(size_label, sizeof(size_label), cache_sizes[cache]);
+        printf(" L%u %s", cache + 1, size_label);
+    }
+    printf("\n%12s %9s  %-10s %7s %10s %5s %11s %9s %9s %8s\n", "pairs", "clusters", "stage", "threads", "working",
+           "fits", "min ms", "GB/s", "ns/pair", "speedup");
+
+    for(u32 clusters_idx = 0; clusters_idx < clusters_count; ++clusters_idx) {
+        for(u32 pairs_idx = 0; pairs_idx < pairs_count; ++pairs_idx) {
+            u64 pairs = options->sweep_pairs[pairs_idx];
+            u64 clusters = options->sweep_clusters[clusters_idx];
+            f64 *row = throughput + ((usize)clusters_idx*pairs_count + pairs_idx)*columns;
+
+            char dataset_name[512];
+            snprintf(dataset_name, sizeof(dataset_name), "%s_%s_s%llu_p%llu_c%llu%s", options->filename,
+                     generator_distribution_str[options->distribution], options->seed, pairs, clusters,
+                     options->quantize_q32 ? "_q32" : "");
+            char *json_filename = filename_with_extension(dataset_name, ".json");
+            char *pairs_filename = filename_with_extension(dataset_name, ".pairs");
+
+            bool cached = true;
+            char *cache_files[] = { json_filename, pairs_filename };
+            for(u32 file_idx = 0; file_idx < 2; ++file_idx) {
+                FILE *file = fopen(cache_files[file_idx], "rb");
+                if(file) fclose(file);
+                else cached = false;
+            }
+            pairs_file_mapping mapping = {0};
+            if(cached && (cached = pairs_file_map(pairs_filename, &mapping, /*verify_columns =*/false))) {
+                bool quantized = pairs_mapping_is_q32(&mapping);
+                cached = mapping.header->count == pairs && mapping.header->seed == options->seed &&
+                         mapping.header->num_clusters == clusters && quantized == options->quantize_q32;
+                pairs_file_unmap(&mapping);
+            }
+            if(!cached) {
+                generator_config gen_config = {
+                    .number_pairs = pairs,
+                    .num_clusters = clusters,
+                    .filename = dataset_name,
+                    .distribution = options->distribution,
+                    .quantize_q32 = options->quantize_q32,
+                    .output_mode = options->output_mode,
+                    .seed = options->seed,
+                    .thread_count = options->thread_count,
+                };
+                u64 gen_start = platform_get_cpu_timer();
+                generate_haversine_json(&gen_config);
+                u64 gen_elapsed = platform_get_cpu_timer() - gen_start;
+
+                char label[128];
+                snprintf(label, sizeof(label), "generate p=%llu c=%llu", pairs, clusters);
+                results_add_single("sweep", label, 0, gen_elapsed);
+                printf("%12llu %9llu  %-10s %7s %10s %5s %11.3f\n", pairs, clusters, "generate", "-", "-", "-",
+                       1000.0*(f64)gen_elapsed/(f64)cpu_freq);
+            }
+
+            usize json_size = platform_file_64bit_get_size(json_filename);
+            /* NOTE(abid): The schema parser always fills f64 columns, the kernel reads the file's. */
+            u64 column_bytes = 4*sizeof(f64)*pairs;
+            u64 file_column_bytes = 4*(options->quantize_q32 ? sizeof(i32) : sizeof(f64))*pairs;
+            repetition_tester tester = {0};
+            reptest_read(&tester, json_filename, cpu_freq, options->sweep_seconds, /*fresh =*/false, NULL);
+            row[0] = sweep_report(&tester, "read", pairs, clusters, 1, json_size, cache_sizes, 0.0);
+            reptest_schema(&tester, json_filename, cpu_freq, options->sweep_seconds, /*fresh =*/false, NULL);
+            row[1] = sweep_report(&tester, "schema", pairs, clusters, 1, json_size + column_bytes, cache_sizes, 0.0);
+            for(u32 threads_idx = 0; threads_idx < options->sweep_threads_count; ++threads_idx) {
+                u32 threads = (u32)options->sweep_threads[threads_idx];
+                reptest_haversine(&tester, dataset_name, cpu_freq, options->sweep_seconds, /*fresh =*/false, threads,
+                                  NULL);
+                row[2 + threads_idx] = sweep_report(&tester, "haversine", pairs, clusters, threads, file_column_bytes,
+                                                    cache_sizes, threads_idx ? row[2] : 0.0);
+            }
+            repetition_release(&tester);
+
+            free(json_filename);
+            free(pairs_filename);
+        }
+    }
+
+    /* NOTE(abid): The curves, GB/s against the dataset size. */
+    for(u32 clusters_idx = 0; clusters_idx < clusters_count; ++clusters_idx) {
+        printf("\nThroughput in GB/s, %llu clusters\n%12s %10s %10s", options->sweep_clusters[clusters_idx], "pairs",
+               "read", "schema");
+        for(u32 threads_idx = 0; threads_idx < options->sweep_threads_count; ++threads_idx) {
+            char header[32];
+            snprintf(header, sizeof(header), "hav t=%llu", options->sweep_threads[threads_idx]);
+            printf(" %10s", header);
+        }
+        printf("\n");
+        for(u32 pairs_idx = 0; pairs_idx < pairs_count; ++pairs_idx) {
+            f64 *row = throughput + ((usize)clusters_idx*pairs_count + pairs_idx)*columns;
+            printf("%12llu", options->sweep_pairs[pairs_idx]);
+            for(u32 column = 0; column < columns; ++column) printf(" %10.3f", row[column]);
+            printf("\n");
+        }
+    }
+    free(throughput);
 }
 
 internal void
 generate_and_check_difference(u64 num_pairs, u64 num_clusters, char *filename, u64 seed) {
-    stat_f64 generation_stat = generate_haversine_json(num_pairs, num_clusters, filename);
+    generator_config gen_config = {
+        .number_pairs = num_pairs,
+        .num_clusters = num_clusters,
+        .filename = filename,
+        .seed = seed,
+    };
+    stat_f64 generation_stat = generate_haversine_json(&gen_config);
     printf("Seed: %llu\nPair Count: %llu\nExpected Sum: %f\n\n",
             seed, num_pairs, generation_stat.Sum);
 
-    test_json_f64_difference(filename);
+    verify_json_f64_answers(filename, dsf_json, /*ulp_print_threshold =*/0);
+}
+
+internal bool
+option_match(char *arg, char *name, char **value) {
+    /* NOTE(abid): Matches `--name=value`, `value` points past the `=`. */
+    usize name_len = strlen(name);
+    if(strncmp(arg, name, name_len) != 0 || arg[name_len] != '=') return false;
+    *value = arg + name_len + 1;
+
+    return true;
 }
 
+/* NOTE(abid): Comma separated counts, exponents allowed (1e6), `a:b` expands to the decades from a
+ * to b (1e3:1e6 = 1e3,1e4,1e5,1e6). Returns how many were written. */
+internal u32
+option_parse_values(char *value, u64 *values, u32 max_count) {
+    u32 count = 0;
+    while(*value) {
+        char *end = NULL;
+        u64 first = (u64)strtod(value, &end);
+        u64 last = first;
+        if(*end == ':') last = (u64)strtod(end + 1, &end);
+        assert(end != value && (*end == ',' || *end == 0) && (first || last == first), "invalid list `%s`", value);
+        for(u64 current = first; current <= last; current *= 10) {
+            assert(count < max_count, "more than %u values in a list", max_count);
+            values[count++] = current;
+            if(!current) break;
+        }
+        value = end + (*end == ',');
+    }
+
+    return count;
+}
+
+/* NOTE(abid): Comma separated names out of `names`, as a bit per name, `all` sets them all. */
+internal u32
+option_parse_names(char *value, char **names, u32 name_count, char *what) {
+    u32 result = 0;
+    while(*value) {
+        usize length = strcspn(value, ",");
+        u32 name_idx;
+        for(name_idx = 0; name_idx < name_count; ++name_idx) {
+            if(strlen(names[name_idx]) == length && strncmp(value, names[name_idx], length) == 0) break;
+        }
+        if(length == 3 && strncmp(value, "all", 3) == 0) result = (1u << name_count) - 1;
+        else {
+            assert(name_idx < name_count, "unknown %s `%.*s`", what, (i32)length, value);
+            result |= 1u << name_idx;
+        }
+        value += length + (value[length] == ',');
+    }
+
+    return result;
+}
+
+internal run_options
+parse_run_options(i32 argc, char *argv[]) {
+    assert(argc >= 5, "[seed] [number of pairs] [number of clusters] [file name] [--options]\n"
+                      "  or --compare=old_results,new_results (flag regressions between two --results files)\n"
+                      "  --precision=f64|f32|mixed|q32\n"
+                      "  --quantize (generate coordinates on the q32 fixed point grid)\n"
+                      "  --distribution=box|gaussian|sphere (how the generator places points)\n"
+                      "  --output=buffered|direct|mmap (how the generator writes its files)\n"
+                      "  --input=json|pairs (pairs: skip generation and JSON, map the existing .pairs)\n"
+                      "  --parser=tree|schema (how json input is parsed, schema: generated pair record parser)\n"
+                      "  --convert=json|pairs (convert the existing dataset to that format and exit)\n"
+                      "  --transcode=minify|pretty (re-format the existing .json into .min.json / .pretty.json and exit)\n"
+                      "  --compress (write block compressed .hvz copies of the .pairs and .f64 files and exit)\n"
+                      "  --compressed (with --input=pairs, load the .hvz copies)\n"
+                      "  --matrix=k (distance matrix between origins and destinations, 0 = full)\n"
+                      "  --threads=n (generation, loader and matrix worker threads, 0 = one per core)\n"
+                      "  --shards=n (write n shards plus a manifest and load them concurrently)\n"
+                      "  --no-generate (with --shards, load the existing json shards as they are)\n"
+                      "  --regenerate-shard=i (rewrite shard i of the existing manifest and exit)\n"
+                      "  --reptest=read,lexer,parser,schema,haversine|all (repetition test the existing dataset and exit)\n"
+                      "  --iotest[=warm,cold,direct|all] (repetition test every way of reading the existing .json per cache mode and exit)\n"
+                      "  --iotest-methods=fread,read_4k,read_64k,read_1m,read_whole,mmap,mmap_populate,async|all (default all)\n"
+                      "  --reptest-seconds=n (stop after n seconds without a new minimum, default 10)\n"
+                      "  --fresh (repetition test with new buffers every run instead of pre-touched ones)\n"
+                      "  --pin=core (pin the main thread to a logical core)\n"
+                      "  --sample[=hz] (sampling profiler, collapsed stacks for flame graphs at exit, default 1000 Hz, Linux)\n"
+                      "  --sample-output=file (where --sample writes, default " SAMPLER_DEFAULT_FILENAME ")\n"
+                      "  --perf (hardware counters on profiler blocks and repetition tests, Linux)\n"
+                      "  --sweep (generate, cache and benchmark a range of datasets, [number of pairs] is the largest)\n"
+                      "  --sweep-pairs=1e3:1e9 / --sweep-clusters=a,b / --sweep-threads=1,2,4 (sweep lists, imply --sweep)\n"
+                      "  --sweep-seconds=n (repetition time of each sweep stage, default 1)\n"
+                      "  --results=file.csv|file.json (also write every timing as a row, see results.h)\n"
+                      "  --probe[=seconds] (measure this machine's memory bandwidth, latency and fault cost, save it and exit)\n"
+                      "  --verify[=ulp] (verify existing dataset, print pairs further than ulp)");
+    run_options options = {
+        .seed = atoll(argv[1]),
+        .num_pairs = atoll(argv[2]),
+        .num_clusters = atoll(argv[3]),
+        .filename = argv[4],
+        .precision = pp_f64,
+        .matrix_k = -1,
+        .convert_to = dsf_count,
+        .transcode = jtm_count,
+        .reptest_seconds = REPETITION_DEFAULT_SECONDS,
+        .pin_core = -1,
+        .probe_seconds = MEMORY_PROBE_DEFAULT_SECONDS,
+        .sweep_seconds = SWEEP_DEFAULT_SECONDS,
+        /* NOTE(abid): The lane kernels and libm disagree by up to ~150 ulp near antipodal pairs. */
+        .verify_ulp_threshold = 1024,
+    };
+
+    for(i32 arg_idx = 5; arg_idx < argc; ++arg_idx) {
+        char *arg = argv[arg_idx];
+        char *value = NULL;
+        if(option_match(arg, "--precision", &value)) {
+            u32 precision_idx;
+            for(precision_idx = 0; precision_idx < pp_count; ++precision_idx) {
+                if(strcmp(value, pair_precision_str[precision_idx]) == 0) break;
+            }
+            assert(precision_idx < pp_count, "unknown precision `%s`", value);
+            options.precision = (pair_precision)precision_idx;
+        } else if(option_match(arg, "--distribution", &value)) {
+            u32 distribution_idx;
+            for(distribution_idx = 0; distribution_idx < gd_count; ++distribution_idx) {
+                if(strcmp(value, generator_distribution_str[distribution_idx]) == 0) break;
+            }
+            assert(distribution_idx < gd_count, "unknown distribution `%s`", value);
+            options.distribution = (generator_distribution)distribution_idx;
+        } else if(option_match(arg, "--output", &value)) {
+            u32 mode_idx;
+            for(mode_idx = 0; mode_idx < fwm_count; ++mode_idx) {
+                if(strcmp(value, file_writer_mode_str[mode_idx]) == 0) break;
+            }
+            assert(mode_idx < fwm_count, "unknown output mode `%s`", value);
+            options.output_mode = (file_writer_mode)mode_idx;
+        } else if(option_match(arg, "--input", &value) || option_match(arg, "--convert", &value)) {
+            u32 format_idx;
+            for(format_idx = 0; format_idx < dsf_count; ++format_idx) {
+                if(strcmp(value, dataset_format_str[format_idx]) == 0) break;
+            }
+            assert(format_idx < dsf_count, "unknown dataset format `%s`", value);
+            if(arg[2] == 'i') options.input = (dataset_format)format_idx;
+            else options.convert_to = (dataset_format)format_idx;
+        } else if(option_match(arg, "--parser", &value)) {
+            u32 parser_idx;
+            for(parser_idx = 0; parser_idx < jsp_count; ++parser_idx) {
+                if(strcmp(value, json_parser_str[parser_idx]) == 0) break;
+            }
+            assert(parser_idx < jsp_count, "unknown json parser `%s`", value);
+            options.parser = (json_parser)parser_idx;
+        } else if(option_match(arg, "--transcode", &value)) {
+            u32 mode_idx;
+            for(mode_idx = 0; mode_idx < jtm_count; ++mode_idx) {
+                if(strcmp(value, json_transcode_mode_str[mode_idx]) == 0) break;
+            }
+            assert(mode_idx < jtm_count, "unknown transcode mode `%s`", value);
+            options.transcode = (json_transcode_mode)mode_idx;
+        } else if(strcmp(arg, "--compress") == 0) {
+            options.compress = true;
+        } else if(strcmp(arg, "--compressed") == 0) {
+            options.compressed = true;
+        } else if(strcmp(arg, "--quantize") == 0) {
+            options.quantize_q32 = true;
+        } else if(option_match(arg, "--matrix", &value)) {
+            options.matrix_k = atoll(value);
+        } else if(strcmp(arg, "--verify") == 0) {
+            options.verify = true;
+        } else if(option_match(arg, "--verify", &value)) {
+            options.verify = true;
+            options.verify_ulp_threshold = atoll(value);
+        } else if(option_match(arg, "--threads", &value)) {
+            options.thread_count = (u32)atoll(value);
+        } else if(option_match(arg, "--shards", &value)) {
+            options.shard_count = (u32)atoll(value);
+        } else if(option_match(arg, "--reptest", &value)) {
+            options.reptest_targets |= option_parse_names(value, repetition_target_str, rtt_count, "repetition test target");
+        } else if(strcmp(arg, "--iotest") == 0) {
+            options.iotest_caches = (1u << frc_count) - 1;
+        } else if(option_match(arg, "--iotest", &value)) {
+            options.iotest_caches |= option_parse_names(value, file_read_cache_str, frc_count, "cache mode");
+        } else if(option_match(arg, "--iotest-methods", &value)) {
+            options.iotest_methods |= option_parse_names(value, file_read_method_str, frm_count, "read method");
+        } else if(option_match(arg, "--reptest-seconds", &value)) {
+            options.reptest_seconds = (u32)atoll(value);
+        } else if(strcmp(arg, "--fresh") == 0) {
+            options.fresh = true;
+        } else if(strcmp(arg, "--sweep") == 0) {
+            options.sweep = true;
+        } else if(option_match(arg, "--sweep-pairs", &value)) {
+            options.sweep = true;
+            options.sweep_pairs_count = option_parse_values(value, options.sweep_pairs, SWEEP_MAX_VALUES);
+        } else if(option_match(arg, "--sweep-clusters", &value)) {
+            options.sweep = true;
+            options.sweep_clusters_count = option_parse_values(value, options.sweep_clusters, SWEEP_MAX_VALUES);
+        } else if(option_match(arg, "--sweep-threads", &value)) {
+            options.sweep = true;
+            options.sweep_threads_count = option_parse_values(value, options.sweep_threads, SWEEP_MAX_VALUES);
+        } else if(option_match(arg, "--sweep-seconds", &value)) {
+            options.sweep_seconds = (u32)atoll(value);
+        } else if(option_match(arg, "--results", &value)) {
+            options.results_filename = value;
+        } else if(strcmp(arg, "--probe") == 0) {
+            options.probe = true;
+        } else if(option_match(arg, "--probe", &value)) {
+            options.probe = true;
+            options.probe_seconds = (u32)atoll(value);
+        } else if(strcmp(arg, "--sample") == 0) {
+            options.sample_hz = SAMPLER_DEFAULT_HZ;
+        } else if(option_match(arg, "--sample", &value)) {
+            options.sample_hz = (u32)atoll(value);
+        } else if(option_match(arg, "--sample-output", &value)) {
+            options.sample_filename = value;
+            if(!options.sample_hz) options.sample_hz = SAMPLER_DEFAULT_HZ;
+        } else if(strcmp(arg, "--perf") == 0) {
+            options.perf = true;
+        } else if(option_match(arg, "--pin", &value)) {
+            options.pin_core = (i32)atoll(value);
+        } else if(strcmp(arg, "--no-generate") == 0) {
+            options.no_generate = true;
+        } else if(option_match(arg, "--regenerate-shard", &value)) {
+            options.regenerate_one = true;
+            options.regenerate_shard = (u32)atoll(value);
+        } else assert(0, "unknown option `%s`", arg);
+    }
+
+    return options;
+}
+
+PROFILER_END_OF_COMPILATION_UNIT;
+
 i32 main(i32 argc, char* argv[]) {
-    assert(argc == 5, "[seed] [number of pairs] [number of clusters] [file name]");
-    u64 seed = atoll(argv[1]);
-    u64 num_pairs = atoll(argv[2]);
-    u64 num_clusters = atoll(argv[3]);
-    char* filename = argv[4];
-
-    rand_seed(seed);
-    benchmark_haversine_gen_and_load(num_pairs, num_clusters, filename);
+    /* NOTE(abid): atexit handlers run in reverse, so the counters close after the profiler report. */
+    atexit(perf_main_counters_close);
+    profiler_begin();
+    /* NOTE(abid): Compares two results files, the dataset arguments do not apply. */
+    char *compare_value = NULL;
+    if(argc == 2 && option_match(argv[1], "--compare", &compare_value)) {
+        char *separator = strchr(compare_value, ',');
+        assert(separator, "--compare=old_results,new_results");
+        *separator = 0;
+        return results_compare(compare_value, separator + 1) ? 1 : 0;
+    }
+
+    run_options options = parse_run_options(argc, argv);
+    if(options.results_filename) {
+        assert(results_open(options.results_filename), "cannot write results to `%s`.", options.results_filename);
+    }
+    if(options.sample_hz && !sampler_begin(options.sample_hz, options.sample_filename)) {
+        printf("Sampling profiler unavailable (SIGPROF timers are Linux only), continuing without it.\n");
+    }
+    perf_counters *counters = &perf_main_counters;
+    if(options.perf) {
+        if(perf_counters_open(counters)) {
+            if(counters->available_count < pe_count) {
+                printf("Perf counters: %u of %u events available (%s).\n", counters->available_count, pe_count,
+                       counters->error);
+            }
+            profiler_attach_counters(counters);
+        } else {
+            printf("Perf counters unavailable (%s), continuing without them.\n", counters->error);
+            options.perf = false;
+        }
+    }
+
+    if(options.convert_to != dsf_count) {
+        convert_dataset(options.filename, options.convert_to);
+        return 0;
+    }
+    if(options.transcode != jtm_count) {
+        transcode_dataset(options.filename, options.transcode);
+        return 0;
+    }
+    if(options.compress) {
+        compress_dataset(options.filename, options.thread_count);
+        return 0;
+    }
+    if(options.probe) {
+        if(options.pin_core >= 0 && !platform_thread_pin_to_core((u32)options.pin_core)) {
+            printf("Cannot pin to core %d, running unpinned.\n", options.pin_core);
+        }
+        return memory_probe_run(options.probe_seconds) ? 0 : 1;
+    }
+    if(options.sweep) {
+        sweep_datasets(&options);
+        return 0;
+    }
+    if(options.iotest_caches) return reptest_io(&options, options.perf ? counters : NULL) ? 0 : 1;
+    if(options.reptest_targets) return reptest_dataset(&options, options.perf ? counters : NULL) ? 0 : 1;
+    if(options.verify) {
+        return verify_json_f64_answers(options.filename, options.input, options.verify_ulp_threshold) ? 0 : 1;
+    }
+    if(options.regenerate_one) return regenerate_shard(&options) ? 0 : 1;
+    if(options.shard_count) return benchmark_shards(&options) ? 1 : 0;
+
+    benchmark_haversine_gen_and_load(&options);
 
     return 0;
 }
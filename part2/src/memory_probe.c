@@ -0,0 +1,442 @@
+/*  +======| File Info |===============================================================+
+    |                                                                                  |
+    |     Subdirectory:  /src                                                          |
+    |    Creation date:  10/20/2026 7:48:02 AM                                         |
+    |    Last Modified:                                                                |
+    |                                                                                  |
+    +======================================| Copyright © Sayed Abid Hashimi |==========+  */
+
+#include "memory_probe.h"
+
+internal u64
+memory_probe_read_scalar(u8 *dest, u8 *source, u64 size, u64 passes) {
+    u64 a0 = 0, a1 = 0, a2 = 0, a3 = 0;
+    for(u64 pass = 0; pass < passes; ++pass) {
+        volatile u64 *at = (volatile u64 *)source;
+        volatile u64 *end = (volatile u64 *)(source + size);
+        for(; at < end; at += 4) {
+            a0 |= at[0];
+            a1 |= at[1];
+            a2 |= at[2];
+            a3 |= at[3];
+        }
+    }
+
+    return a0 | a1 | a2 | a3;
+}
+
+internal u64
+memory_probe_write_scalar(u8 *dest, u8 *source, u64 size, u64 passes) {
+    for(u64 pass = 0; pass < passes; ++pass) {
+        volatile u64 *at = (volatile u64 *)dest;
+        volatile u64 *end = (volatile u64 *)(dest + size);
+        for(; at < end; at += 4) {
+            at[0] = pass;
+            at[1] = pass;
+            at[2] = pass;
+            at[3] = pass;
+        }
+    }
+
+    return passes;
+}
+
+internal u64
+memory_probe_copy_scalar(u8 *dest, u8 *source, u64 size, u64 passes) {
+    for(u64 pass = 0; pass < passes; ++pass) {
+        volatile u64 *to = (volatile u64 *)dest;
+        volatile u64 *from = (volatile u64 *)source;
+        volatile u64 *end = (volatile u64 *)(source + size);
+        for(; from < end; from += 4, to += 4) {
+            to[0] = from[0];
+            to[1] = from[1];
+            to[2] = from[2];
+            to[3] = from[3];
+        }
+    }
+
+    return passes;
+}
+
+/* NOTE(abid): The vector kernels, four independent registers per iteration so the loop is bound
+ * by the memory and not by the dependency chain. Buffers are page aligned, sizes a multiple of
+ * 4 registers. */
+#define MEMORY_PROBE_VECTOR_KERNELS(name, type, load, store, or, set1)                          \
+internal u64                                                                                    \
+memory_probe_read_ ## name(u8 *dest, u8 *source, u64 size, u64 passes) {                        \
+    type a0 = set1(0), a1 = set1(0), a2 = set1(0), a3 = set1(0);                                \
+    for(u64 pass = 0; pass < passes; ++pass) {                                                  \
+        for(u64 offset = 0; offset < size; offset += 4*sizeof(type)) {                          \
+            a0 = or(a0, load((type *)(source + offset)));                                       \
+            a1 = or(a1, load((type *)(source + offset + sizeof(type))));                        \
+            a2 = or(a2, load((type *)(source + offset + 2*sizeof(type))));                      \
+            a3 = or(a3, load((type *)(source + offset + 3*sizeof(type))));                      \
+        }                                                                                       \
+    }                                                                                           \
+    u64 lanes[sizeof(type)/sizeof(u64)];                                                        \
+    store((type *)lanes, or(or(a0, a1), or(a2, a3)));                                           \
+                                                                                                \
+    return lanes[0];                                                                            \
+}                                                                                               \
+                                                                                                \
+internal u64                                                                                    \
+memory_probe_write_ ## name(u8 *dest, u8 *source, u64 size, u64 passes) {                       \
+    for(u64 pass = 0; pass < passes; ++pass) {                                                  \
+        type value = set1((long long)pass);                                                     \
+        for(u64 offset = 0; offset < size; offset += 4*sizeof(type)) {                          \
+            store((type *)(dest + offset), value);                                              \
+            store((type *)(dest + offset + sizeof(type)), value);                               \
+            store((type *)(dest + offset + 2*sizeof(type)), value);                             \
+            store((type *)(dest + offset + 3*sizeof(type)), value);                             \
+        }                                                                                       \
+    }                                                                                           \
+                                                                                                \
+    return passes;                                                                              \
+}                                                                                               \
+                                                                                                \
+internal u64                                                                                    \
+memory_probe_copy_ ## name(u8 *dest, u8 *source, u64 size, u64 passes) {                        \
+    for(u64 pass = 0; pass < passes; ++pass) {                                                  \
+        for(u64 offset = 0; offset < size; offset += 4*sizeof(type)) {                          \
+            type v0 = load((type *)(source + offset));                                          \
+            type v1 = load((type *)(source + offset + sizeof(type)));                           \
+            type v2 = load((type *)(source + offset + 2*sizeof(type)));                         \
+            type v3 = load((type *)(source + offset + 3*sizeof(type)));                         \
+            store((type *)(dest + offset), v0);                                                 \
+            store((type *)(dest + offset + sizeof(type)), v1);                                  \
+            store((type *)(dest + offset + 2*sizeof(type)), v2);                                \
+            store((type *)(dest + offset + 3*sizeof(type)), v3);                                \
+        }                                                                                       \
+    }                                                                                           \
+                                                                                                \
+    return passes;                                                                              \
+}
+
+MEMORY_PROBE_VECTOR_KERNELS(sse, __m128i, _mm_load_si128, _mm_store_si128, _mm_or_si128, _mm_set1_epi64x)
+#if defined(__AVX2__)
+MEMORY_PROBE_VECTOR_KERNELS(avx2, __m256i, _mm256_load_si256, _mm256_store_si256, _mm256_or_si256,
+                            _mm256_set1_epi64x)
+#endif
+#if defined(__AVX512F__)
+MEMORY_PROBE_VECTOR_KERNELS(avx512, __m512i, _mm512_load_si512, _mm512_store_si512, _mm512_or_si512,
+                            _mm512_set1_epi64)
+#endif
+
+global_var memory_probe_kernel *memory_probe_kernels[mpo_count][mpw_count] = {
+    [mpo_read] = { [mpw_scalar] = memory_probe_read_scalar, [mpw_sse] = memory_probe_read_sse },
+    [mpo_write] = { [mpw_scalar] = memory_probe_write_scalar, [mpw_sse] = memory_probe_write_sse },
+    [mpo_copy] = { [mpw_scalar] = memory_probe_copy_scalar, [mpw_sse] = memory_probe_copy_sse },
+};
+
+internal void
+memory_probe_init_kernels() {
+#if defined(__AVX2__)
+    memory_probe_kernels[mpo_read][mpw_avx2] = memory_probe_read_avx2;
+    memory_probe_kernels[mpo_write][mpw_avx2] = memory_probe_write_avx2;
+    memory_probe_kernels[mpo_copy][mpw_avx2] = memory_probe_copy_avx2;
+#endif
+#if defined(__AVX512F__)
+    memory_probe_kernels[mpo_read][mpw_avx512] = memory_probe_read_avx512;
+    memory_probe_kernels[mpo_write][mpw_avx512] = memory_probe_write_avx512;
+    memory_probe_kernels[mpo_copy][mpw_avx512] = memory_probe_copy_avx512;
+#endif
+}
+
+internal void
+memory_probe_size_label(char *label, usize label_size, u64 bytes) {
+    if(bytes >= gigabyte(1)) snprintf(label, label_size, "%llu GB", bytes/gigabyte(1));
+    else if(bytes >= megabyte(1)) snprintf(label, label_size, "%llu MB", bytes/megabyte(1));
+    else snprintf(label, label_size, "%llu KB", bytes/kilobyte(1));
+}
+
+/* NOTE(abid): Minimum time of the wave in seconds. */
+internal f64
+memory_probe_min_seconds(repetition_tester *tester) {
+    if(tester->state == rts_error || !tester->results.test_count || !tester->cpu_freq) return 0.0;
+    return (f64)tester->results.min_time/(f64)tester->cpu_freq;
+}
+
+internal void
+memory_probe_bandwidth(memory_limits *limits, u8 *dest, u8 *source, u64 cpu_freq, u32 seconds) {
+    for(u32 op = 0; op < mpo_count; ++op) {
+        printf("--- %s bandwidth (GB/s) ---\n%10s", memory_probe_op_str[op], "size");
+        for(u32 width = 0; width < mpw_count; ++width) printf("%10s", memory_probe_width_str[width]);
+        printf("\n");
+
+        for(u32 size_idx = 0; size_idx < MEMORY_PROBE_SIZE_COUNT; ++size_idx) {
+            u64 size = memory_probe_sizes[size_idx];
+            u64 passes = size < MEMORY_PROBE_BYTES_PER_RUN ? MEMORY_PROBE_BYTES_PER_RUN/size : 1;
+            char label[32];
+
+            for(u32 width = 0; width < mpw_count; ++width) {
+                memory_probe_kernel *kernel = memory_probe_kernels[op][width];
+                if(!kernel) continue;
+
+                repetition_tester tester = {0};
+                volatile u64 sink = 0;
+                repetition_new_wave(&tester, size*passes, cpu_freq, seconds, NULL);
+                while(repetition_is_testing(&tester)) {
+                    repetition_begin_time(&tester);
+                    sink += kernel(dest, source, size, passes);
+                    repetition_end_time(&tester);
+                    repetition_count_bytes(&tester, size*passes);
+                }
+
+                f64 min_seconds = memory_probe_min_seconds(&tester);
+                if(min_seconds > 0.0) {
+                    limits->bandwidth[op][width][size_idx] = (f64)(size*passes)/(f64)gigabyte(1)/min_seconds;
+                }
+
+                char stage[64];
+                memory_probe_size_label(label, sizeof(label), size);
+                snprintf(stage, sizeof(stage), "%s %s %s", memory_probe_op_str[op], memory_probe_width_str[width],
+                         label);
+                repetition_add_result(&tester, "probe", stage);
+                repetition_release(&tester);
+            }
+
+            memory_probe_size_label(label, sizeof(label), size);
+            printf("\r%10s", label);
+            for(u32 width = 0; width < mpw_count; ++width) {
+                f64 bandwidth = limits->bandwidth[op][width][size_idx];
+                if(bandwidth > 0.0) printf("%10.2f", bandwidth);
+                else printf("%10s", "-");
+            }
+            printf("                              \n");
+        }
+    }
+}
+
+/* NOTE(abid): Every cache line of the buffer points to the next one of a single random cycle
+ * (Sattolo), so each load depends on the previous one and the prefetchers cannot guess. */
+internal u8 *
+memory_probe_chase(u8 *start, u64 loads) {
+    u8 *at = start;
+    for(u64 load_idx = 0; load_idx < loads; ++load_idx) at = *(u8 **)at;
+
+    return at;
+}
+
+internal void
+memory_probe_latency(memory_limits *limits, u8 *buffer, u64 cpu_freq, u32 seconds) {
+    printf("--- load latency (ns) ---\n");
+    u64 line_size = 64;
+    u64 max_lines = memory_probe_sizes[MEMORY_PROBE_SIZE_COUNT - 1]/line_size;
+    u64 *order = platform_allocate(max_lines*sizeof(u64));
+    rand_stream stream = rand_stream_create(0x6D656D70726F6265ULL, 0);
+
+    for(u32 size_idx = 0; size_idx < MEMORY_PROBE_SIZE_COUNT; ++size_idx) {
+        u64 size = memory_probe_sizes[size_idx];
+        u64 lines = size/line_size;
+        for(u64 line = 0; line < lines; ++line) order[line] = line;
+        for(u64 line = lines - 1; line > 0; --line) {
+            u64 other = rand_stream_u64(&stream) % line;
+            u64 temp = order[line];
+            order[line] = order[other];
+            order[other] = temp;
+        }
+        for(u64 line = 0; line < lines; ++line) {
+            *(u8 **)(buffer + line*line_size) = buffer + order[line]*line_size;
+        }
+
+        repetition_tester tester = {0};
+        volatile u64 sink = 0;
+        repetition_new_wave(&tester, 0, cpu_freq, seconds, NULL);
+        while(repetition_is_testing(&tester)) {
+            repetition_begin_time(&tester);
+            sink += (u64)memory_probe_chase(buffer, MEMORY_PROBE_CHASE_LOADS);
+            repetition_end_time(&tester);
+        }
+
+        f64 min_seconds = memory_probe_min_seconds(&tester);
+        limits->latency_ns[size_idx] = 1e9*min_seconds/(f64)MEMORY_PROBE_CHASE_LOADS;
+
+        char label[32], stage[64];
+        memory_probe_size_label(label, sizeof(label), size);
+        snprintf(stage, sizeof(stage), "latency %s", label);
+        repetition_add_result(&tester, "probe", stage);
+        repetition_release(&tester);
+        printf("\r%10s%10.2f                                                            \n", label,
+               limits->latency_ns[size_idx]);
+    }
+
+    platform_free(order, max_lines*sizeof(u64));
+}
+
+/* NOTE(abid): Fresh arena, commit `MEMORY_PROBE_FAULT_BYTES` and touch one byte per page. */
+internal void
+memory_probe_faults(memory_limits *limits, u64 cpu_freq, u32 seconds) {
+    usize page_size = platform_page_get_size();
+    repetition_tester tester = {0};
+    repetition_new_wave(&tester, MEMORY_PROBE_FAULT_BYTES, cpu_freq, seconds, NULL);
+    while(repetition_is_testing(&tester)) {
+        mem_arena *arena = arena_create(page_size, MEMORY_PROBE_FAULT_BYTES + page_size);
+        repetition_begin_time(&tester);
+        u8 *bytes = push_size(MEMORY_PROBE_FAULT_BYTES, arena);
+        for(u64 offset = 0; offset < MEMORY_PROBE_FAULT_BYTES; offset += page_size) bytes[offset] = 1;
+        repetition_end_time(&tester);
+        repetition_count_bytes(&tester, MEMORY_PROBE_FAULT_BYTES);
+        arena_free(arena);
+    }
+
+    repetition_add_result(&tester, "probe", "arena commit faults");
+    repetition_release(&tester);
+    u64 faults = tester.results.min_time_faults;
+    f64 min_seconds = memory_probe_min_seconds(&tester);
+    if(faults && min_seconds > 0.0) {
+        limits->fault_ns = 1e9*min_seconds/(f64)faults;
+        limits->fault_bytes = (f64)MEMORY_PROBE_FAULT_BYTES/(f64)faults;
+    }
+    printf("\r--- arena commit faults ---                                                      \n"
+           "  %.1f ns per fault, %.1f KB per fault, %.3f GB/s\n", limits->fault_ns,
+           limits->fault_bytes/1024.0, min_seconds > 0.0 ? (f64)MEMORY_PROBE_FAULT_BYTES/(f64)gigabyte(1)/min_seconds : 0.0);
+}
+
+/* NOTE(abid): Probe file of this machine, allocated, the caller frees it. */
+internal char *
+memory_probe_filename() {
+    char machine[256];
+    platform_machine_name(machine, sizeof(machine));
+
+    usize size = strlen(MEMORY_PROBE_FILE_PREFIX) + strlen(machine) + sizeof(".txt");
+    char *result = malloc(size);
+    snprintf(result, size, MEMORY_PROBE_FILE_PREFIX "%s.txt", machine);
+
+    return result;
+}
+
+internal bool
+memory_probe_save(memory_limits *limits, char *filename) {
+    FILE *file = fopen(filename, "w");
+    if(!file) return false;
+
+    char brand[49];
+    platform_cpu_brand(brand);
+    fprintf(file, "# haversine memory probe: %s, TSC %llu Hz\n", brand,
+            platform_get_cpu_timer_freq_estimate(/*ms_to_wait =*/0));
+    for(u32 op = 0; op < mpo_count; ++op) {
+        for(u32 width = 0; width < mpw_count; ++width) {
+            for(u32 size_idx = 0; size_idx < MEMORY_PROBE_SIZE_COUNT; ++size_idx) {
+                f64 bandwidth = limits->bandwidth[op][width][size_idx];
+                if(bandwidth <= 0.0) continue;
+                fprintf(file, "bandwidth %s %s %llu %f\n", memory_probe_op_str[op], memory_probe_width_str[width],
+                        memory_probe_sizes[size_idx], bandwidth);
+            }
+        }
+    }
+    for(u32 size_idx = 0; size_idx < MEMORY_PROBE_SIZE_COUNT; ++size_idx) {
+        fprintf(file, "latency %llu %f\n", memory_probe_sizes[size_idx], limits->latency_ns[size_idx]);
+    }
+    fprintf(file, "fault %f %f\n", limits->fault_ns, limits->fault_bytes);
+
+    return fclose(file) == 0;
+}
+
+internal i32
+memory_probe_size_index(u64 bytes) {
+    for(u32 size_idx = 0; size_idx < MEMORY_PROBE_SIZE_COUNT; ++size_idx) {
+        if(memory_probe_sizes[size_idx] == bytes) return (i32)size_idx;
+    }
+
+    return -1;
+}
+
+/* NOTE(abid): Lines this build does not know (other sizes, widths) are skipped. */
+internal bool
+memory_probe_load(memory_limits *limits, char *filename) {
+    *limits = (memory_limits) {0};
+    FILE *file = fopen(filename, "r");
+    if(!file) return false;
+
+    char line[256];
+    while(fgets(line, sizeof(line), file)) {
+        char op_name[16], width_name[16];
+        unsigned long long bytes;
+        f64 first, second;
+        if(sscanf(line, "bandwidth %15s %15s %llu %lf", op_name, width_name, &bytes, &first) == 4) {
+            u32 op, width;
+            for(op = 0; op < mpo_count && strcmp(op_name, memory_probe_op_str[op]) != 0; ++op);
+            for(width = 0; width < mpw_count && strcmp(width_name, memory_probe_width_str[width]) != 0; ++width);
+            i32 size_idx = memory_probe_size_index(bytes);
+            if(op < mpo_count && width < mpw_count && size_idx >= 0) {
+                limits->bandwidth[op][width][size_idx] = first;
+                limits->loaded = true;
+            }
+        } else if(sscanf(line, "latency %llu %lf", &bytes, &first) == 2) {
+            i32 size_idx = memory_probe_size_index(bytes);
+            if(size_idx >= 0) limits->latency_ns[size_idx] = first;
+        } else if(sscanf(line, "fault %lf %lf", &first, &second) == 2) {
+            limits->fault_ns = first;
+            limits->fault_bytes = second;
+        }
+    }
+    fclose(file);
+
+    return limits->loaded;
+}
+
+internal bool
+memory_probe_run(u32 seconds) {
+    memory_probe_init_kernels();
+    u64 cpu_freq = platform_get_cpu_timer_freq_estimate(/*ms_to_wait =*/0);
+    u64 max_size = memory_probe_sizes[MEMORY_PROBE_SIZE_COUNT - 1];
+    u8 *source = platform_allocate(max_size);
+    u8 *dest = platform_allocate(max_size);
+    memset(source, 1, max_size);
+    memset(dest, 0, max_size);
+
+    char brand[49];
+    platform_cpu_brand(brand);
+    printf("Memory probe: %s, %u second(s) without a new minimum per test\n", brand, seconds);
+
+    memory_limits limits = {0};
+    memory_probe_bandwidth(&limits, dest, source, cpu_freq, seconds);
+    memory_probe_latency(&limits, source, cpu_freq, seconds);
+    memory_probe_faults(&limits, cpu_freq, seconds);
+    platform_free(source, max_size);
+    platform_free(dest, max_size);
+
+    char *filename = memory_probe_filename();
+    bool saved = memory_probe_save(&limits, filename);
+    printf("%s %s\n", saved ? "Saved to" : "Cannot write", filename);
+    free(filename);
+
+    return saved;
+}
+
+/* NOTE(abid): Best bandwidth of `op` over all widths, for the smallest probed buffer that holds
+ * `working_set` (the largest one past that), 0 when nothing was probed. */
+internal f64
+memory_limits_attainable(memory_limits *limits, memory_probe_op op, u64 working_set, u32 *width_out,
+                         u32 *size_idx_out) {
+    u32 size_idx = 0;
+    while(size_idx + 1 < MEMORY_PROBE_SIZE_COUNT && memory_probe_sizes[size_idx] < working_set) ++size_idx;
+
+    f64 result = 0.0;
+    for(u32 width = 0; width < mpw_count; ++width) {
+        if(limits->bandwidth[op][width][size_idx] > result) {
+            result = limits->bandwidth[op][width][size_idx];
+            *width_out = width;
+        }
+    }
+    *size_idx_out = size_idx;
+
+    return result;
+}
+
+/* NOTE(abid): One line under a repetition test's results, its minimum as a share of the probe. */
+internal void
+memory_limits_print_share(memory_limits *limits, memory_probe_op op, repetition_tester *tester) {
+    f64 min_seconds = memory_probe_min_seconds(tester);
+    if(!limits->loaded || min_seconds <= 0.0 || !tester->target_bytes) return;
+
+    u32 width = 0, size_idx = 0;
+    f64 attainable = memory_limits_attainable(limits, op, tester->target_bytes, &width, &size_idx);
+    if(attainable <= 0.0) return;
+
+    char label[32];
+    memory_probe_size_label(label, sizeof(label), memory_probe_sizes[size_idx]);
+    f64 achieved = (f64)tester->target_bytes/(f64)gigabyte(1)/min_seconds;
+    printf("  Roofline: %.1f%% of %.3f GB/s (%s %s, %s)\n", 100.0*achieved/attainable, attainable,
+           memory_probe_op_str[op], memory_probe_width_str[width], label);
+}
@@ -0,0 +1,96 @@
+/*  +======| File Info |===============================================================+
+    |                                                                                  |
+    |     Subdirectory:  /src                                                          |
+    |    Creation date:  10/20/2026 7:48:02 AM                                         |
+    |    Last Modified:                                                                |
+    |                                                                                  |
+    +======================================| Copyright © Sayed Abid Hashimi |==========+  */
+
+#if !defined(MEMORY_PROBE_H)
+
+#include <immintrin.h>
+
+/* NOTE(abid): What the machine can do, so the stages have something to be compared against.
+ * `--probe` measures read, write and copy bandwidth for every buffer size in
+ * `MEMORY_PROBE_SIZES` (L1 up to DRAM) and every access width compiled in, dependent load
+ * latency (a random pointer chase, one cache line per hop) and the cost of faulting in freshly
+ * committed arena pages. Everything is a repetition test minimum. The results go to a per-machine
+ * file that the repetition tests load to print what share of the attainable bandwidth they reach.
+ *
+ * Copy counts the bytes copied, not read + written, so it is directly comparable to a memcpy. */
+#define MEMORY_PROBE_OPS \
+    X(read)              \
+    X(write)             \
+    X(copy)
+
+typedef enum {
+#define X(value) mpo_ ## value,
+    MEMORY_PROBE_OPS
+#undef X
+    mpo_count
+} memory_probe_op;
+
+char *memory_probe_op_str[] = {
+#define X(value) #value,
+    MEMORY_PROBE_OPS
+#undef X
+};
+
+/* NOTE(abid): Widths are compiled in with the instruction set (/arch:AVX2, -mavx512f, ...), a
+ * width the build does not target is skipped. Scalar goes through volatile pointers so the
+ * compiler cannot widen it. */
+#define MEMORY_PROBE_WIDTHS \
+    X(scalar, 8)            \
+    X(sse, 16)              \
+    X(avx2, 32)             \
+    X(avx512, 64)
+
+typedef enum {
+#define X(value, bytes) mpw_ ## value,
+    MEMORY_PROBE_WIDTHS
+#undef X
+    mpw_count
+} memory_probe_width;
+
+char *memory_probe_width_str[] = {
+#define X(value, bytes) #value,
+    MEMORY_PROBE_WIDTHS
+#undef X
+};
+
+#define MEMORY_PROBE_SIZES                                                                     \
+    X(kilobyte(16)) X(kilobyte(32)) X(kilobyte(64)) X(kilobyte(128)) X(kilobyte(256))         \
+    X(kilobyte(512)) X(megabyte(1)) X(megabyte(2)) X(megabyte(4)) X(megabyte(8))              \
+    X(megabyte(16)) X(megabyte(32)) X(megabyte(64)) X(megabyte(256))
+
+u64 memory_probe_sizes[] = {
+#define X(bytes) (u64)(bytes),
+    MEMORY_PROBE_SIZES
+#undef X
+};
+#define MEMORY_PROBE_SIZE_COUNT (sizeof(memory_probe_sizes)/sizeof(memory_probe_sizes[0]))
+
+/* NOTE(abid): Small buffers are swept several times per run so every run moves at least this
+ * much, otherwise the timer overhead shows up in L1 numbers. */
+#define MEMORY_PROBE_BYTES_PER_RUN megabyte(64)
+#define MEMORY_PROBE_CHASE_LOADS (1 << 20)
+#define MEMORY_PROBE_FAULT_BYTES megabyte(64)
+#define MEMORY_PROBE_DEFAULT_SECONDS 1
+#define MEMORY_PROBE_FILE_PREFIX "haversine_machine_"
+
+/* NOTE(abid): Sweeps `size` bytes `passes` times, returns something derived from the loaded data
+ * so reads cannot be dropped. */
+typedef u64 memory_probe_kernel(u8 *dest, u8 *source, u64 size, u64 passes);
+
+/* NOTE(abid): Probe results, GB/s and ns. 0 = not measured (width not compiled in, or the probe
+ * file has no such line). */
+typedef struct {
+    bool loaded;
+    f64 bandwidth[mpo_count][mpw_count][MEMORY_PROBE_SIZE_COUNT];
+    f64 latency_ns[MEMORY_PROBE_SIZE_COUNT];
+    f64 fault_ns;
+    f64 fault_bytes; /* NOTE(abid): Average bytes brought in per fault (huge pages make it > 4K). */
+} memory_limits;
+
+#define MEMORY_PROBE_H
+#endif
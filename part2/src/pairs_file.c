@@ -0,0 +1,203 @@
+/*  +======| File Info |===============================================================+
+    |                                                                                  |
+    |     Subdirectory:  /src                                                          |
+    |    Creation date:  10/19/2026 9:03:52 PM                                         |
+    |    Last Modified:                                                                |
+    |                                                                                  |
+    +======================================| Copyright © Sayed Abid Hashimi |==========+  */
+
+#include "pairs_file.h"
+
+#define PAIRS_CHECKSUM_SEED 0x9E3779B97F4A7C15ULL
+
+/* NOTE(abid): Streaming 64-bit checksum, order dependent, so columns have to be fed in order. */
+inline internal u64
+pairs_checksum_update(u64 hash, void *data, u64 word_count) {
+    u64 *words = (u64 *)data;
+    for(u64 idx = 0; idx < word_count; ++idx) {
+        hash ^= words[idx]*0xFF51AFD7ED558CCDULL;
+        hash = ((hash << 29) | (hash >> 35))*0xC4CEB9FE1A85EC53ULL;
+    }
+
+    return hash;
+}
+
+/* NOTE(abid): Same checksum over i32 columns, one element per word, so a chunk can end on any
+ * element. */
+inline internal u64
+pairs_checksum_update_u32(u64 hash, void *data, u64 count) {
+    u32 *elems = (u32 *)data;
+    for(u64 idx = 0; idx < count; ++idx) {
+        hash ^= (u64)elems[idx]*0xFF51AFD7ED558CCDULL;
+        hash = ((hash << 29) | (hash >> 35))*0xC4CEB9FE1A85EC53ULL;
+    }
+
+    return hash;
+}
+
+inline internal u64
+pairs_file_element_size(u32 flags) { return (flags & PAIRS_FILE_FLAG_QUANTIZED_Q32) ? sizeof(i32) : sizeof(f64); }
+
+inline internal u64
+pairs_checksum_update_column(u64 hash, void *data, u64 count, u32 flags) {
+    return (flags & PAIRS_FILE_FLAG_QUANTIZED_Q32) ? pairs_checksum_update_u32(hash, data, count)
+                                                   : pairs_checksum_update(hash, data, count);
+}
+
+inline internal u64
+pairs_checksum_finalize(u64 hash, u64 word_count) { return rand_mix64(hash ^ word_count); }
+
+inline internal u64
+pairs_file_header_checksum(pairs_file_header *header) {
+    usize checked_words = offsetof(pairs_file_header, header_checksum)/sizeof(u64);
+    return pairs_checksum_finalize(pairs_checksum_update(PAIRS_CHECKSUM_SEED, header, checked_words),
+                                   checked_words);
+}
+
+/* NOTE(abid): Creates (or truncates) the file at its final size, the padding is already zero. */
+internal pairs_file_writer *
+pairs_file_create(char *filename, u64 count, u64 column_stride, u64 seed, u64 num_clusters, u32 flags) {
+    pairs_file_writer *writer = calloc(1, sizeof(pairs_file_writer));
+    writer->file = platform_file_open_write(filename, /*unbuffered =*/false, NULL);
+    assert(writer->file != PLATFORM_FILE_INVALID, "cannot open %s for writing.", filename);
+
+    pairs_file_header *header = &writer->header;
+    header->magic = PAIRS_FILE_MAGIC;
+    header->version = PAIRS_FILE_VERSION;
+    header->header_size = PAIRS_FILE_HEADER_SIZE;
+    header->count = count;
+    header->column_stride = column_stride;
+    header->seed = seed;
+    header->num_clusters = num_clusters;
+    header->flags = flags;
+    header->column_count = PAIRS_FILE_COLUMNS;
+
+    u64 column_bytes = column_stride*pairs_file_element_size(flags);
+    column_bytes = (column_bytes + PAIRS_FILE_COLUMN_ALIGNMENT - 1) & ~(u64)(PAIRS_FILE_COLUMN_ALIGNMENT - 1);
+    for(u32 column = 0; column < PAIRS_FILE_COLUMNS; ++column) {
+        header->column_offset[column] = PAIRS_FILE_HEADER_SIZE + column*column_bytes;
+        writer->checksum_state[column] = PAIRS_CHECKSUM_SEED;
+    }
+    bool sized = platform_file_set_size(writer->file, PAIRS_FILE_HEADER_SIZE + PAIRS_FILE_COLUMNS*column_bytes);
+    assert(sized, "cannot size %s.", filename);
+
+    return writer;
+}
+
+/* NOTE(abid): Appends the next `count` pairs, `columns` holds x0, y0, x1, y1 in the file's element
+ * type (f64, or i32 for a quantized file). */
+internal void
+pairs_file_append(pairs_file_writer *writer, void **columns, u64 count) {
+    assert(writer->written + count <= writer->header.count, "more pairs than the file was created for.");
+    u32 flags = writer->header.flags;
+    u64 element_size = pairs_file_element_size(flags);
+    for(u32 column = 0; column < PAIRS_FILE_COLUMNS; ++column) {
+        u64 offset = writer->header.column_offset[column] + writer->written*element_size;
+        bool written = platform_file_write_at(writer->file, columns[column], count*element_size, offset);
+        assert(written, "cannot write .pairs column.");
+        writer->checksum_state[column] = pairs_checksum_update_column(writer->checksum_state[column], columns[column],
+                                                                      count, flags);
+    }
+    writer->written += count;
+}
+
+/* NOTE(abid): The header goes in last, a file that was not closed properly has no magic. Returns
+ * the header checksum, which covers the column checksums. */
+internal u64
+pairs_file_close(pairs_file_writer *writer) {
+    pairs_file_header *header = &writer->header;
+    assert(writer->written == header->count, "%llu of %llu pairs written.", writer->written, header->count);
+    for(u32 column = 0; column < PAIRS_FILE_COLUMNS; ++column) {
+        header->column_checksum[column] = pairs_checksum_finalize(writer->checksum_state[column], header->count);
+    }
+    header->header_checksum = pairs_file_header_checksum(header);
+
+    bool written = platform_file_write_at(writer->file, header, sizeof(pairs_file_header), 0);
+    assert(written, "cannot write .pairs header.");
+    platform_file_close(writer->file);
+    u64 result = header->header_checksum;
+    free(writer);
+
+    return result;
+}
+
+/* NOTE(abid): Validates the header of a .pairs image already in memory and points the columns
+ * into it, `verify_columns` also recomputes the column checksums (reads every byte, so off for the
+ * fast path). Returns false on any mismatch, `mapping` keeps base/size so the caller can release. */
+internal bool
+pairs_file_open_memory(void *base, usize size, pairs_file_mapping *mapping, bool verify_columns, char *filename) {
+    *mapping = (pairs_file_mapping) {0};
+    mapping->base = base;
+    mapping->size = size;
+    char *error = NULL;
+    if(mapping->base == NULL || mapping->size < PAIRS_FILE_HEADER_SIZE) error = "missing or truncated";
+
+    pairs_file_header *header = (pairs_file_header *)mapping->base;
+    mapping->header = header;
+    if(!error && (header->magic != PAIRS_FILE_MAGIC || header->version != PAIRS_FILE_VERSION ||
+                  header->column_count != PAIRS_FILE_COLUMNS ||
+                  header->header_checksum != pairs_file_header_checksum(header))) {
+        error = "bad header";
+    }
+
+    for(u32 column = 0; !error && column < PAIRS_FILE_COLUMNS; ++column) {
+        u64 offset = header->column_offset[column];
+        u64 column_bytes = header->column_stride*pairs_file_element_size(header->flags);
+        if(offset % PAIRS_FILE_COLUMN_ALIGNMENT || offset + column_bytes > mapping->size ||
+           header->column_stride < header->count) {
+            error = "column out of bounds";
+            break;
+        }
+        mapping->columns[column] = (u8 *)mapping->base + offset;
+
+        if(verify_columns) {
+            u64 checksum = pairs_checksum_update_column(PAIRS_CHECKSUM_SEED, mapping->columns[column], header->count,
+                                                        header->flags);
+            if(pairs_checksum_finalize(checksum, header->count) != header->column_checksum[column]) {
+                error = "column checksum mismatch";
+            }
+        }
+    }
+
+    if(error) {
+        printf("%s: %s\n", filename, error);
+        return false;
+    }
+
+    return true;
+}
+
+internal void
+pairs_file_unmap(pairs_file_mapping *mapping) {
+    if(mapping->converted) arena_free(mapping->converted);
+    if(mapping->base) {
+        if(mapping->decoded) platform_free(mapping->base, mapping->size);
+        else platform_file_unmap(mapping->base, mapping->size);
+    }
+    *mapping = (pairs_file_mapping) {0};
+}
+
+/* NOTE(abid): Maps the file read-only and validates it, see `pairs_file_open_memory`. Returns
+ * false, with nothing mapped, on any mismatch. */
+internal bool
+pairs_file_map(char *filename, pairs_file_mapping *mapping, bool verify_columns) {
+    usize size = 0;
+    void *base = platform_file_map(filename, &size);
+    bool result = pairs_file_open_memory(base, size, mapping, verify_columns, filename);
+    if(!result) pairs_file_unmap(mapping);
+
+    return result;
+}
+
+/* NOTE(abid): Same as `pairs_file_map` for a block compressed .pairs.hvz, the blocks are decoded
+ * in parallel into one buffer, the columns keep their page alignment. */
+internal bool
+pairs_file_map_compressed(char *filename, pairs_file_mapping *mapping, bool verify_columns, u32 thread_count) {
+    usize size = 0;
+    void *base = block_codec_decompress_file(filename, thread_count, &size);
+    bool result = pairs_file_open_memory(base, size, mapping, verify_columns, filename);
+    mapping->decoded = true;
+    if(!result) pairs_file_unmap(mapping);
+
+    return result;
+}
@@ -0,0 +1,80 @@
+/*  +======| File Info |===============================================================+
+    |                                                                                  |
+    |     Subdirectory:  /src                                                          |
+    |    Creation date:  10/19/2026 9:03:17 PM                                         |
+    |    Last Modified:                                                                |
+    |                                                                                  |
+    +======================================| Copyright © Sayed Abid Hashimi |==========+  */
+
+#if !defined(PAIRS_FILE_H)
+
+/* NOTE(abid): Binary pair file (.pairs), a fixed header in the first page followed by the x0, y0,
+ * x1 and y1 columns as little-endian f64, or as i32 on the q32 grid (see haversine.h) when the
+ * file has PAIRS_FILE_FLAG_QUANTIZED_Q32, half the bytes for the same coordinates. Each column is
+ * `column_stride` elements (the count padded with zero pairs the way the kernels want it) and
+ * starts on a page boundary, so a read-only mapping of the file hands the kernels their columns
+ * without a copy.
+ * Checksums cover the `count` real elements of a column, the header checksum covers every header
+ * byte before it. */
+#define PAIRS_FILE_MAGIC 0x5352494150564148ULL /* NOTE(abid): "HAVPAIRS" */
+#define PAIRS_FILE_VERSION 2
+#define PAIRS_FILE_HEADER_SIZE 4096
+#define PAIRS_FILE_COLUMN_ALIGNMENT 4096
+#define PAIRS_FILE_COLUMNS 4
+
+/* NOTE(abid): Header flags. */
+#define PAIRS_FILE_FLAG_QUANTIZED_Q32 0x1 /* NOTE(abid): i32 columns on the q32 grid. */
+#define PAIRS_FILE_FLAG_CONVERTED     0x2 /* NOTE(abid): Converted from JSON, seed/clusters unknown. */
+
+typedef struct {
+    u64 magic;
+    u32 version;
+    u32 header_size;
+    u64 count;
+    u64 column_stride;
+    u64 seed;
+    u64 num_clusters;
+    u32 flags;
+    u32 column_count;
+    u64 column_offset[PAIRS_FILE_COLUMNS];
+    u64 column_checksum[PAIRS_FILE_COLUMNS];
+    u64 header_checksum;
+} pairs_file_header;
+
+/* NOTE(abid): Columns are appended in pair order, each column at its own offset. */
+typedef struct {
+    platform_file file;
+    pairs_file_header header;
+    u64 written;
+    u64 checksum_state[PAIRS_FILE_COLUMNS];
+} pairs_file_writer;
+
+typedef struct {
+    void *base;
+    usize size;
+    bool decoded; /* NOTE(abid): `base` is a decoded .hvz buffer, not a file mapping. */
+    pairs_file_header *header;
+    void *columns[PAIRS_FILE_COLUMNS]; /* NOTE(abid): f64, or i32 for a quantized file. */
+    mem_arena *converted; /* NOTE(abid): f64 copy of i32 columns, see `pairs_f64_from_mapping`. */
+} pairs_file_mapping;
+
+/* NOTE(abid): Where a run reads its dataset from. */
+#define DATASET_FORMATS \
+    X(json)             \
+    X(pairs)
+
+typedef enum {
+#define X(value) dsf_ ## value,
+    DATASET_FORMATS
+#undef X
+    dsf_count
+} dataset_format;
+
+char *dataset_format_str[] = {
+#define X(value) #value,
+    DATASET_FORMATS
+#undef X
+};
+
+#define PAIRS_FILE_H
+#endif
@@ -0,0 +1,112 @@
+/*  +======| File Info |===============================================================+
+    |                                                                                  |
+    |     Subdirectory:  /src                                                          |
+    |    Creation date:  10/20/2026 4:37:15 AM                                         |
+    |    Last Modified:                                                                |
+    |                                                                                  |
+    +======================================| Copyright © Sayed Abid Hashimi |==========+  */
+
+#if PLT_LINUX
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <errno.h>
+#endif
+
+#include "perf_counters.h"
+
+/* NOTE(abid): True if at least one event counts. */
+internal bool
+perf_counters_open(perf_counters *counters) {
+    *counters = (perf_counters) {0};
+    for(u32 event = 0; event < pe_count; ++event) counters->fds[event] = -1;
+
+#if PLT_LINUX
+    u32 types[pe_count] = {
+#define X(name, type, config) type,
+        PERF_EVENTS
+#undef X
+    };
+    u64 configs[pe_count] = {
+#define X(name, type, config) config,
+        PERF_EVENTS
+#undef X
+    };
+    for(u32 event = 0; event < pe_count; ++event) {
+        struct perf_event_attr attr = {
+            .size = sizeof(attr),
+            .type = types[event],
+            .config = configs[event],
+            .read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING,
+            .exclude_kernel = 1,
+            .exclude_hv = 1,
+        };
+        i32 fd = (i32)syscall(SYS_perf_event_open, &attr, /*pid =*/0, /*cpu =*/-1, /*group_fd =*/-1,
+                              /*flags =*/0);
+        if(fd >= 0) {
+            counters->fds[event] = fd;
+            ++counters->available_count;
+        } else if(!counters->error) counters->error = strerror(errno);
+    }
+#else
+    counters->error = "perf_event_open is Linux only";
+#endif
+
+    return counters->available_count > 0;
+}
+
+internal void
+perf_counters_close(perf_counters *counters) {
+#if PLT_LINUX
+    for(u32 event = 0; event < pe_count; ++event) {
+        if(counters->fds[event] >= 0) close(counters->fds[event]);
+    }
+#endif
+    *counters = (perf_counters) {0};
+}
+
+/* NOTE(abid): The main thread's counters (`--perf`). Global, the profiler report still reads them
+ * from atexit, after main has returned. */
+global_var perf_counters perf_main_counters;
+
+internal void
+perf_main_counters_close() {
+    /* NOTE(abid): Never opened = zeroed, fd 0 is stdin then. */
+    if(perf_main_counters.available_count) perf_counters_close(&perf_main_counters);
+}
+
+/* NOTE(abid): Running totals, unavailable events read as 0. */
+internal void
+perf_counters_read(perf_counters *counters, perf_sample *sample) {
+    for(u32 event = 0; event < pe_count; ++event) {
+        sample->values[event] = 0;
+#if PLT_LINUX
+        if(counters->fds[event] < 0) continue;
+        u64 data[3]; /* NOTE(abid): value, time enabled, time running. */
+        if(read(counters->fds[event], data, sizeof(data)) != sizeof(data)) continue;
+        if(data[2] && data[2] < data[1]) data[0] = (u64)((f64)data[0]*(f64)data[1]/(f64)data[2]);
+        sample->values[event] = data[0];
+#endif
+    }
+}
+
+inline internal void
+perf_sample_add_delta(perf_sample *dest, perf_sample *start, perf_sample *end) {
+    for(u32 event = 0; event < pe_count; ++event) dest->values[event] += end->values[event] - start->values[event];
+}
+
+/* NOTE(abid): IPC and the misses per KB processed of whatever was counted, `bytes` = 0 prints
+ * the absolute counts instead. `divisor` averages over that many runs. */
+internal void
+perf_sample_print(perf_counters *counters, perf_sample *sample, u64 bytes, u64 divisor) {
+    f64 scale = divisor ? 1.0/(f64)divisor : 1.0;
+    u64 *values = sample->values;
+    if(counters->fds[pe_cycles] >= 0 && counters->fds[pe_instructions] >= 0 && values[pe_cycles]) {
+        printf("  IPC %.2f", (f64)values[pe_instructions]/(f64)values[pe_cycles]);
+    }
+    for(u32 event = pe_branch_misses; event < pe_count; ++event) {
+        if(counters->fds[event] < 0) continue;
+        f64 value = (f64)values[event]*scale;
+        if(bytes) printf("  %s/KB %.3f", perf_event_str[event], value*1024.0/(f64)bytes);
+        else printf("  %s %.0f", perf_event_str[event], value);
+    }
+}
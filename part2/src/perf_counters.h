@@ -0,0 +1,52 @@
+/*  +======| File Info |===============================================================+
+    |                                                                                  |
+    |     Subdirectory:  /src                                                          |
+    |    Creation date:  10/20/2026 4:37:15 AM                                         |
+    |    Last Modified:                                                                |
+    |                                                                                  |
+    +======================================| Copyright © Sayed Abid Hashimi |==========+  */
+
+#if !defined(PERF_COUNTERS_H)
+
+/* NOTE(abid): Hardware counters through perf_event_open (Linux only), counting the calling
+ * thread in user space. Every event is opened on its own, so whatever the machine, kernel or
+ * container refuses is left out and the rest still counts, with nothing available at all the
+ * counters are simply off. Counts are scaled by enabled/running time when the kernel had to
+ * multiplex them. */
+#define PERF_EVENTS                                                              \
+    X(cycles, PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES)                      \
+    X(instructions, PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS)              \
+    X(branch_misses, PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES)            \
+    X(l1d_misses, PERF_TYPE_HW_CACHE, PERF_CACHE_READ_MISS(PERF_COUNT_HW_CACHE_L1D))   \
+    X(llc_misses, PERF_TYPE_HW_CACHE, PERF_CACHE_READ_MISS(PERF_COUNT_HW_CACHE_LL))    \
+    X(dtlb_misses, PERF_TYPE_HW_CACHE, PERF_CACHE_READ_MISS(PERF_COUNT_HW_CACHE_DTLB)) \
+    X(page_faults, PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS)
+
+#define PERF_CACHE_READ_MISS(Cache) \
+    ((Cache) | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16))
+
+typedef enum {
+#define X(name, type, config) pe_ ## name,
+    PERF_EVENTS
+#undef X
+    pe_count
+} perf_event;
+
+char *perf_event_str[] = {
+#define X(name, type, config) #name,
+    PERF_EVENTS
+#undef X
+};
+
+typedef struct {
+    u64 values[pe_count];
+} perf_sample;
+
+typedef struct {
+    i32 fds[pe_count]; /* NOTE(abid): -1 = not available. */
+    u32 available_count;
+    char *error; /* NOTE(abid): Why the first unavailable event failed. */
+} perf_counters;
+
+#define PERF_COUNTERS_H
+#endif
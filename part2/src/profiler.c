@@ -0,0 +1,205 @@
+/*  +======| File Info |===============================================================+
+    |                                                                                  |
+    |     Subdirectory:  /src                                                          |
+    |    Creation date:  10/20/2026 2:04:41 AM                                         |
+    |    Last Modified:                                                                |
+    |                                                                                  |
+    +======================================| Copyright © Sayed Abid Hashimi |==========+  */
+
+#include "profiler.h"
+
+#if PROFILER
+
+global_var profile_anchor profiler_anchors[PROFILER_MAX_THREADS][PROFILER_MAX_ANCHORS];
+/* NOTE(abid): One bit per slot, held by a running thread / ever held by one (the report). */
+global_var volatile u64 profiler_slots_busy;
+global_var volatile u64 profiler_slots_used;
+global_var volatile u64 profiler_shared_slot;
+global_var platform_thread_exit_key profiler_exit_key;
+global_var bool profiler_exit_key_valid;
+global_var u64 profiler_start_tsc;
+
+/* NOTE(abid): Slot + 1 of this thread (0 = none yet) and the anchor of its innermost open block. */
+global_var thread_local_var u32 profiler_thread_slot;
+global_var thread_local_var u32 profiler_parent;
+global_var thread_local_var perf_counters *profiler_perf;
+
+internal void
+profiler_slot_release(void *slot_plus_one) {
+    u64 bit = 1ULL << ((u64)slot_plus_one - 1);
+    u64 busy;
+    do {
+        busy = platform_atomic_load_u64(&profiler_slots_busy);
+    } while(!platform_atomic_compare_exchange_u64(&profiler_slots_busy, busy, busy & ~bit));
+}
+
+internal u32
+profiler_slot_get() {
+    if(!profiler_thread_slot) {
+        u32 slot;
+        u64 busy;
+        do {
+            busy = platform_atomic_load_u64(&profiler_slots_busy);
+            if(busy == ~0ULL) break;
+            slot = u64_trailing_zeros(~busy);
+        } while(!platform_atomic_compare_exchange_u64(&profiler_slots_busy, busy, busy | (1ULL << slot)));
+
+        if(busy == ~0ULL) {
+            /* NOTE(abid): Every slot taken, share one of 1..63 (not held, nothing to give back). */
+            slot = 1 + (u32)(platform_atomic_add_u64(&profiler_shared_slot, 1) % (PROFILER_MAX_THREADS - 1));
+        } else if(slot && profiler_exit_key_valid) {
+            platform_thread_exit_set(profiler_exit_key, (void *)(u64)(slot + 1));
+        }
+        u64 used;
+        do {
+            used = platform_atomic_load_u64(&profiler_slots_used);
+        } while(!platform_atomic_compare_exchange_u64(&profiler_slots_used, used, used | (1ULL << slot)));
+        profiler_thread_slot = slot + 1;
+    }
+
+    return profiler_thread_slot - 1;
+}
+
+inline internal profile_block
+profile_block_begin(char *label, u32 anchor_index, u64 processed_bytes) {
+    profile_block result = {
+        .label = label,
+        .anchor_index = anchor_index,
+        .parent_index = profiler_parent,
+        .thread_slot = profiler_slot_get(),
+        .open = true,
+    };
+    profile_anchor *anchor = profiler_anchors[result.thread_slot] + anchor_index;
+    result.old_tsc_elapsed_inclusive = anchor->tsc_elapsed_inclusive;
+    anchor->processed_bytes += processed_bytes;
+    if(profiler_perf) {
+        result.old_counters = anchor->counters;
+        perf_counters_read(profiler_perf, &result.start_counters);
+    }
+
+    profiler_parent = anchor_index;
+    result.start_tsc = platform_get_cpu_timer();
+    return result;
+}
+
+inline internal void
+profile_block_end(profile_block *block) {
+    u64 elapsed = platform_get_cpu_timer() - block->start_tsc;
+    profiler_parent = block->parent_index;
+
+    profile_anchor *anchors = profiler_anchors[block->thread_slot];
+    profile_anchor *anchor = anchors + block->anchor_index;
+    if(profiler_perf) {
+        perf_sample end_counters;
+        perf_counters_read(profiler_perf, &end_counters);
+        anchor->counters = block->old_counters;
+        perf_sample_add_delta(&anchor->counters, &block->start_counters, &end_counters);
+    }
+    /* NOTE(abid): Overwriting the inclusive time with the value from before this block counts an
+     * outer recursive call once, the exclusive time of the parent loses what we spent. */
+    anchors[block->parent_index].tsc_elapsed_exclusive -= elapsed;
+    anchor->tsc_elapsed_exclusive += elapsed;
+    anchor->tsc_elapsed_inclusive = block->old_tsc_elapsed_inclusive + elapsed;
+    ++anchor->hit_count;
+    anchor->label = block->label;
+
+    block->open = false;
+}
+
+/* NOTE(abid): Cycles one empty block costs, measured on anchor 0 and cleared again. */
+internal f64
+profiler_measure_overhead() {
+    u32 slot = profiler_slot_get();
+    profile_anchor saved_root = profiler_anchors[slot][0];
+
+    u64 best = ~0ULL;
+    for(u32 round = 0; round < 8; ++round) {
+        u64 start = platform_get_cpu_timer();
+        for(u32 idx = 0; idx < PROFILER_OVERHEAD_SAMPLES/8; ++idx) {
+            profile_block block = profile_block_begin("overhead", 0, 0);
+            profile_block_end(&block);
+        }
+        u64 elapsed = platform_get_cpu_timer() - start;
+        if(elapsed < best) best = elapsed;
+    }
+    profiler_anchors[slot][0] = saved_root;
+
+    return (f64)best/(f64)(PROFILER_OVERHEAD_SAMPLES/8);
+}
+
+internal void
+profiler_report() {
+    u64 total_tsc = platform_get_cpu_timer() - profiler_start_tsc;
+    u64 cpu_freq = platform_get_cpu_timer_freq_estimate(/*ms_to_wait =*/0);
+    if(!total_tsc || !cpu_freq) return;
+
+    /* NOTE(abid): Nothing to report when no block ran. */
+    u64 used = platform_atomic_load_u64(&profiler_slots_used);
+    if(!used) return;
+    u32 slot_count = u64_popcount(used);
+
+    printf("\nProfile: %fms (CPU freq: %llu, %u thread slots, parallel blocks can exceed 100%%)\n",
+           1000.0*(f64)total_tsc/(f64)cpu_freq, cpu_freq, slot_count);
+    u64 hits = 0;
+    for(u32 anchor_idx = 1; anchor_idx < PROFILER_MAX_ANCHORS; ++anchor_idx) {
+        profile_anchor sum = {0};
+        for(u32 slot = 0; slot < PROFILER_MAX_THREADS; ++slot) {
+            profile_anchor *anchor = profiler_anchors[slot] + anchor_idx;
+            sum.tsc_elapsed_exclusive += anchor->tsc_elapsed_exclusive;
+            sum.tsc_elapsed_inclusive += anchor->tsc_elapsed_inclusive;
+            sum.hit_count += anchor->hit_count;
+            sum.processed_bytes += anchor->processed_bytes;
+            perf_sample_add_delta(&sum.counters, &(perf_sample) {0}, &anchor->counters);
+            if(anchor->label) sum.label = anchor->label;
+        }
+        if(!sum.hit_count) continue;
+        hits += sum.hit_count;
+
+        printf("  %s[%llu]: %llu (%.2f%%", sum.label, sum.hit_count, sum.tsc_elapsed_exclusive,
+               100.0*(f64)sum.tsc_elapsed_exclusive/(f64)total_tsc);
+        if(sum.tsc_elapsed_inclusive != sum.tsc_elapsed_exclusive) {
+            printf(", %.2f%% w/children", 100.0*(f64)sum.tsc_elapsed_inclusive/(f64)total_tsc);
+        }
+        printf(")");
+        if(sum.processed_bytes && sum.tsc_elapsed_inclusive) {
+            f64 seconds = (f64)sum.tsc_elapsed_inclusive/(f64)cpu_freq;
+            printf("  %.3f MB at %.2f GB/s", (f64)sum.processed_bytes/(f64)megabyte(1),
+                   (f64)sum.processed_bytes/(f64)gigabyte(1)/seconds);
+        }
+        printf("\n");
+        results_add(&(result_row) {
+            .source = "profiler",
+            .stage = sum.label,
+            .bytes = sum.processed_bytes,
+            .repetitions = sum.hit_count,
+            .total_cycles = sum.tsc_elapsed_inclusive,
+            .cpu_freq = cpu_freq,
+        });
+        if(profiler_perf) {
+            printf("   ");
+            perf_sample_print(profiler_perf, &sum.counters, sum.processed_bytes, /*divisor =*/0);
+            printf("\n");
+        }
+    }
+
+    f64 overhead = profiler_measure_overhead();
+    printf("  Overhead: %.1f cycles per block, %llu blocks, ~%.4f%% of the run\n", overhead, hits,
+           100.0*overhead*(f64)hits/(f64)total_tsc);
+}
+
+/* NOTE(abid): Counters only count the thread that opened them, so they go with its blocks. */
+internal void
+profiler_attach_counters(perf_counters *counters) {
+    profiler_perf = counters;
+}
+
+/* NOTE(abid): Starts the clock the report is relative to, the report prints at exit. */
+internal void
+profiler_begin() {
+    profiler_exit_key = platform_thread_exit_key_create(profiler_slot_release);
+    profiler_exit_key_valid = true;
+    profiler_start_tsc = platform_get_cpu_timer();
+    atexit(profiler_report);
+}
+
+#endif
@@ -0,0 +1,92 @@
+/*  +======| File Info |===============================================================+
+    |                                                                                  |
+    |     Subdirectory:  /src                                                          |
+    |    Creation date:  10/20/2026 2:04:41 AM                                         |
+    |    Last Modified:                                                                |
+    |                                                                                  |
+    +======================================| Copyright © Sayed Abid Hashimi |==========+  */
+
+#if !defined(PROFILER_H)
+
+/* NOTE(abid): Instrumentation profiler. A block is the statement (or braced block) following
+ * the macro, it is a for loop underneath, so it must be left by falling off its end, never by
+ * return, break or goto:
+ *
+ *   TIME_BLOCK("sum") { ... }
+ *   TIME_BANDWIDTH("read", size) fread(...);
+ *   TIME_FUNCTION { ... }
+ *
+ * Every block site gets its own anchor (__COUNTER__), that records hits, inclusive cycles (with
+ * children, counted once for recursive blocks), exclusive cycles (without children) and the bytes
+ * it processed. Anchors are per thread slot, so blocks on worker threads neither race nor get
+ * attributed to the wrong parent, the report sums the slots. With a results file open (results.h)
+ * the report also writes one row per block. `profiler_begin` registers the report to be printed at
+ * exit. `profiler_attach_counters` adds perf counters (perf_counters.h) to the blocks of the
+ * calling thread, every block then costs a read syscall per event. Compiling with PROFILER=0
+ * removes all of it, the macros expand to nothing and the blocks become plain statements. */
+#if !defined(PROFILER)
+#define PROFILER 1
+#endif
+
+#define PROFILER_MAX_ANCHORS 256
+/* NOTE(abid): Slot 0 is the first thread to open a block (normally main) and stays its own. The
+ * other threads take the lowest free slot and give it back when they exit, so only more than
+ * PROFILER_MAX_THREADS - 1 of them running at once share slots (1..63, never 0). Slots are bits
+ * of a u64, so 64 at most. */
+#define PROFILER_MAX_THREADS 64
+#define PROFILER_OVERHEAD_SAMPLES 100000
+
+#if PROFILER
+
+typedef struct {
+    u64 tsc_elapsed_exclusive;
+    u64 tsc_elapsed_inclusive;
+    u64 hit_count;
+    u64 processed_bytes;
+    char *label;
+    perf_sample counters; /* NOTE(abid): Inclusive, like tsc_elapsed_inclusive. */
+} profile_anchor;
+
+typedef struct {
+    char *label;
+    u64 old_tsc_elapsed_inclusive;
+    u64 start_tsc;
+    u32 parent_index;
+    u32 anchor_index;
+    u32 thread_slot;
+    bool open;
+    perf_sample old_counters;
+    perf_sample start_counters;
+} profile_block;
+
+#define PROFILER_GLUE_(A, B) A ## B
+#define PROFILER_GLUE(A, B) PROFILER_GLUE_(A, B)
+#define PROFILER_BLOCK_VAR PROFILER_GLUE(profile_block_, __LINE__)
+
+/* NOTE(abid): Anchor 0 is the root every top level block reports its exclusive time to. */
+#define TIME_BANDWIDTH(Name, Bytes)                                                                \
+    for(profile_block PROFILER_BLOCK_VAR = profile_block_begin((char *)(Name), __COUNTER__ + 1, (Bytes)); \
+        PROFILER_BLOCK_VAR.open; profile_block_end(&PROFILER_BLOCK_VAR))
+#define TIME_BLOCK(Name) TIME_BANDWIDTH(Name, 0)
+#define TIME_FUNCTION TIME_BLOCK(__func__)
+#define TIME_FUNCTION_BANDWIDTH(Bytes) TIME_BANDWIDTH(__func__, Bytes)
+
+/* NOTE(abid): Placed once after the last instrumented block, fails to compile when the block
+ * sites outgrow the anchor table. */
+#define PROFILER_END_OF_COMPILATION_UNIT \
+    typedef char profiler_anchor_limit[(__COUNTER__ < PROFILER_MAX_ANCHORS) ? 1 : -1]
+
+#else
+
+#define TIME_BANDWIDTH(Name, Bytes)
+#define TIME_BLOCK(Name)
+#define TIME_FUNCTION
+#define TIME_FUNCTION_BANDWIDTH(Bytes)
+#define PROFILER_END_OF_COMPILATION_UNIT
+#define profiler_begin()
+#define profiler_attach_counters(Counters)
+
+#endif
+
+#define PROFILER_H
+#endif
@@ -7,6 +7,10 @@
     +======================================| Copyright © Sayed Abid Hashimi |==========+  */
 
 #include "random.h"
+#include "simd.h"
+
+/* NOTE(abid): A seed draws the same numbers whatever the target ISA. */
+FP_CONTRACT_OFF_BEGIN
 
 global_var rand_state __GLOBALRandState = {
         .V = 4101842887655102017LL,
@@ -36,10 +40,33 @@ RandU64() {
     return __GLOBALRandState.V * 2685821657736338717LL;
 }
 
-/* NOTE(abid): Range in [Min, Max) */
-/* TODO(abid): Get rid of modulus in here (faster). */
+/* NOTE(abid): Maps a 64-bit draw onto [0, Range) without bias (Lemire, "Fast Random Integer
+ * Generation in an Interval", 2019). The high half of Value*Range is the result, draws whose low
+ * half falls below 2^64 mod Range are rejected. The modulus is only computed when the low half is
+ * below Range, that is with probability Range/2^64. */
+#define RAND_REDUCE_RANGE(Result, Value, Range, NextValue) do { \
+    u128 Product = u128_mul_u64(Value, Range);                  \
+    if(Product.lo < (Range)) {                                  \
+        u64 Threshold = (0 - (Range)) % (Range);                \
+        while(Product.lo < Threshold) {                         \
+            Value = NextValue;                                  \
+            Product = u128_mul_u64(Value, Range);               \
+        }                                                       \
+    }                                                           \
+    Result = Product.hi;                                        \
+} while(0)
+
+/* NOTE(abid): Range in [Min, Max), Min == Max is the full 64-bit range. */
 inline internal u64
-rand_range_u64(u64 Min, u64 Max) { return Min + RandU64() % (Max-Min); }
+rand_range_u64(u64 Min, u64 Max) {
+    u64 Range = Max - Min;
+    u64 Value = RandU64();
+    if(Range == 0) return Value;
+    u64 Result;
+    RAND_REDUCE_RANGE(Result, Value, Range, RandU64());
+
+    return Min + Result;
+}
 
 inline internal u32 RandU32() { return (u32)RandU64(); }
 
@@ -66,3 +93,92 @@ RandF64() { return 5.42101086242752217e-20 * (f64)RandU64(); }
 /* NOTE(abid): Range [Min, Max] */
 inline internal f64
 rand_range_f64(f64 Min, f64 Max) { return Min + RandF64() * (Max - Min); }
+
+/* NOTE(abid): splitmix64 finalizer. */
+inline internal u64
+rand_mix64(u64 Value) {
+    Value = (Value ^ (Value >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    Value = (Value ^ (Value >> 27)) * 0x94D049BB133111EBULL;
+    return Value ^ (Value >> 31);
+}
+
+inline internal rand_stream
+rand_stream_create(u64 Seed, u64 StreamIdx) {
+    rand_stream Result = { .V = rand_mix64(Seed ^ rand_mix64(StreamIdx + 0x9E3779B97F4A7C15ULL)) };
+    return Result;
+}
+
+inline internal u64
+rand_stream_u64(rand_stream *Stream) {
+    Stream->V += 0x9E3779B97F4A7C15ULL;
+    return rand_mix64(Stream->V);
+}
+
+/* NOTE(abid): Range [Min, Max), 53 random bits. */
+inline internal f64
+rand_stream_range_f64(rand_stream *Stream, f64 Min, f64 Max) {
+    f64 Unit = (f64)(rand_stream_u64(Stream) >> 11) * (1.0/9007199254740992.0);
+    return Min + Unit * (Max - Min);
+}
+
+inline internal void
+rand_batch_seed(rand_batch_state *State, u64 Seed, u64 StreamIdx) {
+    /* NOTE(abid): xoshiro wants its state seeded from splitmix64. */
+    rand_stream Stream = rand_stream_create(Seed, StreamIdx);
+    for(u32 Word = 0; Word < 4; ++Word) {
+        for(u32 Lane = 0; Lane < RAND_BATCH_LANES; ++Lane) State->S[Word][Lane] = rand_stream_u64(&Stream);
+    }
+}
+
+/* NOTE(abid): One xoshiro256++ step of the lanes held in s0..s3, result in `Result`. */
+#define RAND_BATCH_STEP(Result, s0, s1, s2, s3) do {                                     \
+    Result = lane_u64_add(lane_u64_rotl(lane_u64_add(s0, s3), 23), s0);                 \
+    lane_u64 T = lane_u64_shl(s1, 17);                                                  \
+    s2 = lane_u64_xor(s2, s0);                                                          \
+    s3 = lane_u64_xor(s3, s1);                                                          \
+    s1 = lane_u64_xor(s1, s2);                                                          \
+    s0 = lane_u64_xor(s0, s3);                                                          \
+    s2 = lane_u64_xor(s2, T);                                                           \
+    s3 = lane_u64_rotl(s3, 45);                                                         \
+} while(0)
+
+/* NOTE(abid): Range [Min, Max). The top 52 bits go straight into the mantissa of a double in
+ * [1, 2), so every value is a multiple of 2^-52 with equal probability, no conversion needed. */
+internal void
+rand_fill_f64(rand_batch_state *State, f64 *Out, u64 Count, f64 Min, f64 Max) {
+    u64 Rounds = (Count + RAND_BATCH_LANES - 1)/RAND_BATCH_LANES;
+    u64 FullRounds = Count/RAND_BATCH_LANES;
+    lane_u64 OneBits = lane_u64_set1(0x3FF0000000000000ULL);
+    lane_f64 One = lane_f64_set1(1.0);
+    lane_f64 Scale = lane_f64_set1(Max - Min);
+    lane_f64 Offset = lane_f64_set1(Min);
+
+    for(u32 Group = 0; Group < RAND_BATCH_LANES; Group += LANE_U64_WIDTH) {
+        lane_u64 s0 = lane_u64_load(State->S[0] + Group);
+        lane_u64 s1 = lane_u64_load(State->S[1] + Group);
+        lane_u64 s2 = lane_u64_load(State->S[2] + Group);
+        lane_u64 s3 = lane_u64_load(State->S[3] + Group);
+        f64 *Dest = Out + Group;
+        for(u64 Round = 0; Round < Rounds; ++Round, Dest += RAND_BATCH_LANES) {
+            lane_u64 Value;
+            RAND_BATCH_STEP(Value, s0, s1, s2, s3);
+            /* NOTE(abid): Bits in [1, 2), the subtraction of 1 is exact. */
+            lane_f64 Unit = lane_f64_sub(lane_u64_as_f64(lane_u64_or(lane_u64_shr(Value, 12), OneBits)), One);
+            lane_f64 Result = lane_f64_add(lane_f64_mul(Unit, Scale), Offset);
+            if(Round < FullRounds) lane_f64_store(Dest, Result);
+            else {
+                f64 Tail[LANE_U64_WIDTH];
+                lane_f64_store(Tail, Result);
+                for(u32 Lane = 0; Lane < LANE_U64_WIDTH && FullRounds*RAND_BATCH_LANES + Group + Lane < Count; ++Lane) {
+                    Dest[Lane] = Tail[Lane];
+                }
+            }
+        }
+        lane_u64_store(State->S[0] + Group, s0);
+        lane_u64_store(State->S[1] + Group, s1);
+        lane_u64_store(State->S[2] + Group, s2);
+        lane_u64_store(State->S[3] + Group, s3);
+    }
+}
+
+FP_CONTRACT_OFF_END
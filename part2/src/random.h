@@ -17,5 +17,23 @@ typedef struct {
     u64 U16Reserves;
 } rand_state;
 
+/* NOTE(abid): Explicit state for code that cannot share the global one (threads). splitmix64, the
+ * start of stream `idx` is a hash of (seed, idx), so any stream can be recreated on its own, in
+ * any order, on any thread. */
+typedef struct {
+    u64 V;
+} rand_stream;
+
+/* NOTE(abid): Batch generator, RAND_BATCH_LANES independent xoshiro256++ streams stepped together
+ * in SIMD lanes. The lane count is fixed (not the SIMD width) so AVX2 and SSE2 builds produce the
+ * same numbers, SSE2 simply steps the lanes in two halves (the f64 fills as well, random.c is
+ * compiled without FMA contraction). Value i of a fill comes from lane i % RAND_BATCH_LANES, a
+ * fill always consumes whole rounds of RAND_BATCH_LANES values. */
+#define RAND_BATCH_LANES 4
+
+typedef struct {
+    u64 S[4][RAND_BATCH_LANES]; /* NOTE(abid): [state word][lane] */
+} rand_batch_state;
+
 #define RANDOM_H
 #endif
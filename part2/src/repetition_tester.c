@@ -0,0 +1,201 @@
+/*  +======| File Info |===============================================================+
+    |                                                                                  |
+    |     Subdirectory:  /src                                                          |
+    |    Creation date:  10/20/2026 3:12:50 AM                                         |
+    |    Last Modified:                                                                |
+    |                                                                                  |
+    +======================================| Copyright © Sayed Abid Hashimi |==========+  */
+
+#include "repetition_tester.h"
+
+internal void
+repetition_print_time(char *label, f64 cpu_time, u64 cpu_freq, u64 bytes) {
+    printf("%s: %.0f", label, cpu_time);
+    if(cpu_freq) {
+        f64 seconds = cpu_time/(f64)cpu_freq;
+        printf(" (%fms)", 1000.0*seconds);
+        if(bytes && seconds > 0.0) printf(" %.3f GB/s", (f64)bytes/(f64)gigabyte(1)/seconds);
+    }
+}
+
+/* NOTE(abid): Every run has to process exactly `target_bytes`, the wave ends after
+ * `seconds_to_try` seconds without a new minimum. */
+internal void
+repetition_new_wave(repetition_tester *tester, u64 target_bytes, u64 cpu_freq, u32 seconds_to_try,
+                    perf_counters *counters) {
+    u64 *samples = tester->results.samples;
+    if(!samples) samples = malloc(REPETITION_MAX_SAMPLES*sizeof(u64));
+    stat_histogram *histogram = tester->results.histogram;
+    if(!histogram) histogram = malloc(sizeof(stat_histogram));
+    stat_histogram_reset(histogram);
+    *tester = (repetition_tester) {
+        .state = rts_testing,
+        .target_bytes = target_bytes,
+        .cpu_freq = cpu_freq,
+        .counters = counters,
+        .try_for_time = seconds_to_try*cpu_freq,
+        .tests_started_at = platform_get_cpu_timer(),
+    };
+    tester->results.min_time = ~0ULL;
+    tester->results.samples = samples;
+    tester->results.histogram = histogram;
+}
+
+internal void
+repetition_release(repetition_tester *tester) {
+    free(tester->results.samples);
+    free(tester->results.histogram);
+    tester->results.samples = NULL;
+    tester->results.histogram = NULL;
+}
+
+internal u64
+repetition_sample_count(repetition_tester *tester) {
+    u64 count = tester->results.test_count;
+    return count < REPETITION_MAX_SAMPLES ? count : REPETITION_MAX_SAMPLES;
+}
+
+internal void
+repetition_error(repetition_tester *tester, char *message) {
+    tester->state = rts_error;
+    tester->error = message;
+}
+
+inline internal void
+repetition_begin_time(repetition_tester *tester) {
+    ++tester->open_block_count;
+    if(tester->counters) perf_counters_read(tester->counters, &tester->counters_start);
+    tester->faults_accumulated -= platform_page_fault_count();
+    tester->time_accumulated -= platform_get_cpu_timer_begin();
+}
+
+inline internal void
+repetition_end_time(repetition_tester *tester) {
+    tester->time_accumulated += platform_get_cpu_timer_end();
+    tester->faults_accumulated += platform_page_fault_count();
+    if(tester->counters) {
+        perf_sample end;
+        perf_counters_read(tester->counters, &end);
+        perf_sample_add_delta(&tester->counters_accumulated, &tester->counters_start, &end);
+    }
+    ++tester->close_block_count;
+}
+
+inline internal void
+repetition_count_bytes(repetition_tester *tester, u64 bytes) {
+    tester->bytes_accumulated += bytes;
+}
+
+/* NOTE(abid): Closes the run that just finished (if any) and says whether to do another one. */
+internal bool
+repetition_is_testing(repetition_tester *tester) {
+    if(tester->state != rts_testing) return false;
+
+    u64 now = platform_get_cpu_timer();
+    if(tester->open_block_count) {
+        if(tester->open_block_count != tester->close_block_count) {
+            repetition_error(tester, "unbalanced begin/end time");
+        } else if(tester->bytes_accumulated != tester->target_bytes) {
+            repetition_error(tester, "processed byte count mismatch");
+        }
+
+        if(tester->state == rts_testing) {
+            repetition_results *results = &tester->results;
+            u64 elapsed = tester->time_accumulated;
+            u64 faults = tester->faults_accumulated;
+            results->samples[results->test_count % REPETITION_MAX_SAMPLES] = elapsed;
+            stat_f64_accumulate((f64)elapsed, &results->time_stat);
+            stat_histogram_add(results->histogram, elapsed);
+            ++results->test_count;
+            results->total_time += elapsed;
+            results->total_faults += faults;
+            perf_sample_add_delta(&results->total_counters, &(perf_sample) {0}, &tester->counters_accumulated);
+            if(faults > results->max_faults) results->max_faults = faults;
+            if(elapsed > results->max_time) results->max_time = elapsed;
+            if(elapsed < results->min_time) {
+                results->min_time = elapsed;
+                results->min_time_faults = faults;
+                results->min_time_counters = tester->counters_accumulated;
+                /* NOTE(abid): A new minimum restarts the clock. */
+                tester->tests_started_at = now;
+
+                repetition_print_time("Min", (f64)elapsed, tester->cpu_freq, tester->bytes_accumulated);
+                printf(" %llu faults               \r", faults);
+                fflush(stdout);
+            }
+        }
+
+        tester->open_block_count = tester->close_block_count = 0;
+        tester->time_accumulated = tester->faults_accumulated = tester->bytes_accumulated = 0;
+        tester->counters_accumulated = (perf_sample) {0};
+    }
+
+    if(tester->state == rts_testing && now - tester->tests_started_at > tester->try_for_time) {
+        tester->state = rts_completed;
+    }
+
+    return tester->state == rts_testing;
+}
+
+internal void
+repetition_print_results(repetition_tester *tester, char *label) {
+    repetition_results *results = &tester->results;
+    printf("--- %s ---                                                  \n", label);
+    if(tester->state == rts_error) {
+        printf("ERROR: %s\n", tester->error);
+        return;
+    }
+    if(!results->test_count) return;
+
+    printf("  ");
+    repetition_print_time("Min", (f64)results->min_time, tester->cpu_freq, tester->target_bytes);
+    printf(", %llu faults\n  ", results->min_time_faults);
+    repetition_print_time("Max", (f64)results->max_time, tester->cpu_freq, tester->target_bytes);
+    printf(", %llu faults\n  ", results->max_faults);
+    repetition_print_time("Avg", (f64)results->total_time/(f64)results->test_count, tester->cpu_freq,
+                          tester->target_bytes);
+    printf(", %.1f faults", (f64)results->total_faults/(f64)results->test_count);
+    if(tester->target_bytes && results->total_faults) {
+        printf(" (%.2f KB per fault)",
+               (f64)tester->target_bytes*(f64)results->test_count/(f64)results->total_faults/1024.0);
+    }
+    printf("\n  ");
+    repetition_print_time("P50", (f64)stat_histogram_percentile(results->histogram, 50.0), tester->cpu_freq,
+                          tester->target_bytes);
+    f64 ms_per_cycle = tester->cpu_freq ? 1000.0/(f64)tester->cpu_freq : 1.0;
+    printf(", P99 %.6fms, P99.9 %.6fms, stddev %.6fms (%.1f%% of the mean)\n",
+           ms_per_cycle*(f64)stat_histogram_percentile(results->histogram, 99.0),
+           ms_per_cycle*(f64)stat_histogram_percentile(results->histogram, 99.9),
+           ms_per_cycle*stat_f64_stddev(&results->time_stat),
+           100.0*stat_f64_stddev(&results->time_stat)/stat_f64_mean(&results->time_stat));
+    if(tester->counters) {
+        printf("  Min run:");
+        perf_sample_print(tester->counters, &results->min_time_counters, tester->target_bytes, /*divisor =*/0);
+        printf("\n  Avg run:");
+        perf_sample_print(tester->counters, &results->total_counters, tester->target_bytes, results->test_count);
+        printf("\n");
+    }
+    printf("  Runs: %llu\n", results->test_count);
+}
+
+/* NOTE(abid): The wave as a row of the results file (see results.h), nothing when there is none. */
+internal void
+repetition_add_result(repetition_tester *tester, char *source, char *stage) {
+    repetition_results *results = &tester->results;
+    if(!results_output.file || tester->state == rts_error || !results->test_count) return;
+
+    u64 sample_count = repetition_sample_count(tester);
+    result_row row = {
+        .source = source,
+        .stage = stage,
+        .bytes = tester->target_bytes,
+        .repetitions = results->test_count,
+        .total_cycles = results->total_time,
+        .min_cycles = results->min_time,
+        .median_cycles = results_median(results->samples, sample_count),
+        .cpu_freq = tester->cpu_freq,
+        .sample_count = sample_count,
+        .samples = results->samples,
+    };
+    results_add(&row);
+}
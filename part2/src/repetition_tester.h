@@ -0,0 +1,104 @@
+/*  +======| File Info |===============================================================+
+    |                                                                                  |
+    |     Subdirectory:  /src                                                          |
+    |    Creation date:  10/20/2026 3:12:50 AM                                         |
+    |    Last Modified:                                                                |
+    |                                                                                  |
+    +======================================| Copyright © Sayed Abid Hashimi |==========+  */
+
+#if !defined(REPETITION_TESTER_H)
+
+/* NOTE(abid): Repetition testing. A target runs over and over, each run timed between
+ * `repetition_begin_time` and `repetition_end_time` (possibly several spans per run), until no
+ * new minimum has shown up for a while. The minimum is the number to compare, it is the run
+ * with the fewest page faults, cache misses and interrupts in it:
+ *
+ *   repetition_new_wave(&tester, bytes, cpu_freq, seconds);
+ *   while(repetition_is_testing(&tester)) {
+ *       repetition_begin_time(&tester);
+ *       ...
+ *       repetition_end_time(&tester);
+ *       repetition_count_bytes(&tester, bytes);
+ *   }
+ *   repetition_print_results(&tester, "label");
+ *   repetition_release(&tester);
+ */
+typedef enum {
+    rts_idle,
+    rts_testing,
+    rts_completed,
+    rts_error,
+} repetition_state;
+
+typedef struct {
+    u64 test_count;
+    u64 total_time;
+    u64 max_time;
+    u64 min_time;
+    u64 total_faults;
+    u64 min_time_faults; /* NOTE(abid): Page faults of the fastest run. */
+    u64 max_faults;
+    perf_sample min_time_counters;
+    perf_sample total_counters;
+
+    /* NOTE(abid): Cycles of the last `REPETITION_MAX_SAMPLES` runs (a ring once it is full), for
+     * the median and the results file. Kept across waves, `repetition_release` frees it. */
+    u64 *samples;
+    /* NOTE(abid): Every run of the wave, for the spread and the percentiles (see stat.h). The
+     * histogram is kept across waves like the samples. */
+    stat_f64 time_stat;
+    stat_histogram *histogram;
+} repetition_results;
+
+typedef struct {
+    repetition_state state;
+    u64 target_bytes;
+    u64 cpu_freq;
+    u64 try_for_time;
+    u64 tests_started_at;
+    char *error;
+
+    /* NOTE(abid): Current run. */
+    u32 open_block_count;
+    u32 close_block_count;
+    u64 time_accumulated;
+    u64 faults_accumulated;
+    u64 bytes_accumulated;
+    perf_counters *counters; /* NOTE(abid): NULL = no perf counters. */
+    perf_sample counters_start;
+    perf_sample counters_accumulated;
+
+    repetition_results results;
+} repetition_tester;
+
+/* NOTE(abid): What `--reptest` can run on an existing dataset:
+ * - read:      fread of the .json into a buffer.
+ * - lexer:     jp_lexer over the .json in memory.
+ * - parser:    jp_parser over the lexer's tokens (lexed again, untimed, before every run).
+ * - schema:    the generated pair record parser from the mapped .json into f64 columns.
+ * - haversine: the f64 lane kernel over the mapped .pairs columns. */
+#define REPETITION_TARGETS \
+    X(read)                \
+    X(lexer)               \
+    X(parser)              \
+    X(schema)              \
+    X(haversine)
+
+typedef enum {
+#define X(value) rtt_ ## value,
+    REPETITION_TARGETS
+#undef X
+    rtt_count
+} repetition_target;
+
+char *repetition_target_str[] = {
+#define X(value) #value,
+    REPETITION_TARGETS
+#undef X
+};
+
+#define REPETITION_DEFAULT_SECONDS 10
+#define REPETITION_MAX_SAMPLES 65536
+
+#define REPETITION_TESTER_H
+#endif
@@ -0,0 +1,390 @@
+/*  +======| File Info |===============================================================+
+    |                                                                                  |
+    |     Subdirectory:  /src                                                          |
+    |    Creation date:  10/20/2026 9:26:14 AM                                         |
+    |    Last Modified:                                                                |
+    |                                                                                  |
+    +======================================| Copyright © Sayed Abid Hashimi |==========+  */
+
+#include "results.h"
+
+/* NOTE(abid): The run's output file, `file` is NULL when results are not written. */
+global_var results_writer results_output;
+
+internal i32
+results_compare_u64(const void *a, const void *b) {
+    u64 left = *(u64 *)a, right = *(u64 *)b;
+    return (left > right) - (left < right);
+}
+
+internal u64
+results_median(u64 *samples, u64 count) {
+    if(!count) return 0;
+
+    u64 *sorted = malloc(count*sizeof(u64));
+    memcpy(sorted, samples, count*sizeof(u64));
+    qsort(sorted, count, sizeof(u64), results_compare_u64);
+    u64 result = (count & 1) ? sorted[count/2] : (sorted[count/2 - 1] + sorted[count/2])/2;
+    free(sorted);
+
+    return result;
+}
+
+internal bool
+results_open(char *filename) {
+    usize length = strlen(filename);
+    bool json = (length >= 5 && strcmp(filename + length - 5, ".json") == 0) ||
+                (length >= 6 && strcmp(filename + length - 6, ".jsonl") == 0);
+    results_output.format = json ? rf_json : rf_csv;
+    results_output.file = fopen(filename, "w");
+    if(!results_output.file) return false;
+
+    platform_cpu_brand(results_output.cpu);
+    if(results_output.format == rf_csv) {
+        fprintf(results_output.file, "git,cpu,source,stage,bytes,repetitions,total_cycles,min_cycles,median_cycles,"
+                                     "cpu_freq,samples\n");
+    }
+
+    return true;
+}
+
+/* NOTE(abid): Quotes and backslashes are dropped, so a string needs no escaping in either format. */
+internal void
+results_write_string(FILE *file, char *string) {
+    fputc('"', file);
+    for(char *at = string; *at; ++at) {
+        if(*at != '"' && *at != '\\') fputc(*at, file);
+    }
+    fputc('"', file);
+}
+
+internal void
+results_add(result_row *row) {
+    FILE *file = results_output.file;
+    if(!file) return;
+
+    char *cpu = results_output.cpu;
+    while(*cpu == ' ') ++cpu;
+    if(results_output.format == rf_csv) {
+        results_write_string(file, GIT_HASH);
+        fputc(',', file);
+        results_write_string(file, cpu);
+        fputc(',', file);
+        results_write_string(file, row->source);
+        fputc(',', file);
+        results_write_string(file, row->stage);
+        fprintf(file, ",%llu,%llu,%llu,%llu,%llu,%llu,", row->bytes, row->repetitions, row->total_cycles,
+                row->min_cycles, row->median_cycles, row->cpu_freq);
+        for(u64 idx = 0; idx < row->sample_count; ++idx) {
+            fprintf(file, idx ? ";%llu" : "%llu", row->samples[idx]);
+        }
+    } else {
+        fprintf(file, "{\"git\": ");
+        results_write_string(file, GIT_HASH);
+        fprintf(file, ", \"cpu\": ");
+        results_write_string(file, cpu);
+        fprintf(file, ", \"source\": ");
+        results_write_string(file, row->source);
+        fprintf(file, ", \"stage\": ");
+        results_write_string(file, row->stage);
+        fprintf(file, ", \"bytes\": %llu, \"repetitions\": %llu, \"total_cycles\": %llu, \"min_cycles\": %llu, "
+                      "\"median_cycles\": %llu, \"cpu_freq\": %llu, \"samples\": [", row->bytes, row->repetitions,
+                row->total_cycles, row->min_cycles, row->median_cycles, row->cpu_freq);
+        for(u64 idx = 0; idx < row->sample_count; ++idx) {
+            fprintf(file, idx ? ", %llu" : "%llu", row->samples[idx]);
+        }
+        fprintf(file, "]}");
+    }
+    fputc('\n', file);
+    fflush(file);
+}
+
+/* NOTE(abid): A row of a single timed span, for the stages that run once. */
+internal void
+results_add_single(char *source, char *stage, u64 bytes, u64 cycles) {
+    result_row row = {
+        .source = source,
+        .stage = stage,
+        .bytes = bytes,
+        .repetitions = 1,
+        .total_cycles = cycles,
+        .min_cycles = cycles,
+        .median_cycles = cycles,
+        .cpu_freq = platform_get_cpu_timer_freq_estimate(/*ms_to_wait =*/0),
+        .sample_count = 1,
+        .samples = &cycles,
+    };
+    results_add(&row);
+}
+
+/* NOTE(abid): `at` points at the first sample, the list ends at `end`, the result is malloc'd. */
+internal u64 *
+results_parse_samples(char *at, char end, u64 *count_out) {
+    u64 capacity = 1;
+    for(char *scan = at; *scan && *scan != end; ++scan) capacity += (*scan == ';' || *scan == ',');
+
+    u64 *result = malloc(capacity*sizeof(u64));
+    u64 count = 0;
+    while(*at && *at != end && count < capacity) {
+        while(*at == ' ' || *at == ';' || *at == ',') ++at;
+        if(*at < '0' || *at > '9') break;
+        result[count++] = strtoull(at, &at, 10);
+    }
+    *count_out = count;
+
+    return result;
+}
+
+/* NOTE(abid): Splits a CSV line in place, fields may be quoted (and then contain commas). */
+internal u32
+results_split_csv(char *line, char **fields, u32 max_fields) {
+    u32 count = 0;
+    char *at = line;
+    while(count < max_fields) {
+        if(*at == '"') {
+            fields[count++] = ++at;
+            while(*at && *at != '"') ++at;
+            if(*at) *at++ = 0;
+        } else {
+            fields[count++] = at;
+            while(*at && *at != ',') ++at;
+        }
+        if(*at != ',') break;
+        *at++ = 0;
+    }
+    *at = 0;
+
+    return count;
+}
+
+/* NOTE(abid): Value of `"key": ...` in a JSON line. */
+internal char *
+results_json_value(char *line, char *key) {
+    char pattern[64];
+    snprintf(pattern, sizeof(pattern), "\"%s\":", key);
+    char *at = strstr(line, pattern);
+    if(!at) return NULL;
+    at += strlen(pattern);
+    while(*at == ' ') ++at;
+
+    return at;
+}
+
+/* NOTE(abid): `at` from `results_json_value`, terminating it cuts the line, so every value of
+ * the line is looked up before the first string is taken. */
+internal char *
+results_json_string(char *at) {
+    if(!at || *at != '"') return "";
+    char *end = strchr(++at, '"');
+    if(end) *end = 0;
+
+    return at;
+}
+
+internal u64
+results_json_u64(char *line, char *key) {
+    char *at = results_json_value(line, key);
+    return at ? strtoull(at, NULL, 10) : 0;
+}
+
+internal bool
+results_load(char *filename, result_set *set) {
+    *set = (result_set) {0};
+    FILE *file = fopen(filename, "rb");
+    if(!file) return false;
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    set->data = malloc((usize)size + 1);
+    bool read = fread(set->data, 1, (usize)size, file) == (usize)size;
+    fclose(file);
+    if(!read) return false;
+    set->data[size] = 0;
+
+    u64 line_count = 0;
+    for(char *at = set->data; *at; ++at) line_count += (*at == '\n');
+    set->rows = malloc((line_count + 1)*sizeof(result_row));
+
+    char *line = set->data;
+    while(*line) {
+        char *line_end = strchr(line, '\n');
+        char *next = line_end ? line_end + 1 : line + strlen(line);
+        if(line_end) *line_end = 0;
+        if(line_end > line && line_end[-1] == '\r') line_end[-1] = 0;
+
+        result_row row = {0};
+        char *git = NULL, *cpu = NULL;
+        if(*line == '{') {
+            char *git_at = results_json_value(line, "git");
+            char *cpu_at = results_json_value(line, "cpu");
+            char *source_at = results_json_value(line, "source");
+            char *stage_at = results_json_value(line, "stage");
+            row.bytes = results_json_u64(line, "bytes");
+            row.repetitions = results_json_u64(line, "repetitions");
+            row.total_cycles = results_json_u64(line, "total_cycles");
+            row.min_cycles = results_json_u64(line, "min_cycles");
+            row.median_cycles = results_json_u64(line, "median_cycles");
+            row.cpu_freq = results_json_u64(line, "cpu_freq");
+            char *samples = results_json_value(line, "samples");
+            if(samples && *samples == '[') row.samples = results_parse_samples(samples + 1, ']', &row.sample_count);
+            git = results_json_string(git_at);
+            cpu = results_json_string(cpu_at);
+            row.source = results_json_string(source_at);
+            row.stage = results_json_string(stage_at);
+        } else if(*line && strncmp(line, "git,", 4) != 0) {
+            char *fields[RESULTS_CSV_COLUMNS];
+            if(results_split_csv(line, fields, RESULTS_CSV_COLUMNS) == RESULTS_CSV_COLUMNS) {
+                git = fields[0];
+                cpu = fields[1];
+                row.source = fields[2];
+                row.stage = fields[3];
+                row.bytes = strtoull(fields[4], NULL, 10);
+                row.repetitions = strtoull(fields[5], NULL, 10);
+                row.total_cycles = strtoull(fields[6], NULL, 10);
+                row.min_cycles = strtoull(fields[7], NULL, 10);
+                row.median_cycles = strtoull(fields[8], NULL, 10);
+                row.cpu_freq = strtoull(fields[9], NULL, 10);
+                row.samples = results_parse_samples(fields[10], 0, &row.sample_count);
+            }
+        }
+        if(row.source && row.stage) {
+            if(!set->count) {
+                snprintf(set->git_hash, sizeof(set->git_hash), "%s", git);
+                snprintf(set->cpu, sizeof(set->cpu), "%s", cpu);
+            }
+            set->rows[set->count++] = row;
+        }
+        line = next;
+    }
+
+    return true;
+}
+
+internal void
+results_free(result_set *set) {
+    for(u64 idx = 0; idx < set->count; ++idx) free(set->rows[idx].samples);
+    free(set->rows);
+    free(set->data);
+    *set = (result_set) {0};
+}
+
+typedef struct {
+    u64 value;
+    bool second;
+} results_ranked_sample;
+
+internal i32
+results_compare_ranked(const void *a, const void *b) {
+    u64 left = ((results_ranked_sample *)a)->value, right = ((results_ranked_sample *)b)->value;
+    return (left > right) - (left < right);
+}
+
+/* NOTE(abid): Two-sided Mann-Whitney U (Wilcoxon rank-sum) test, normal approximation with the
+ * tie correction. Run times are far from normal (long right tail, often several modes) so the
+ * ranks are compared rather than the means. Samples are compared in seconds, so two result sets
+ * timed at different TSC frequencies still compare. */
+internal f64
+results_rank_sum_p_value(result_row *first, result_row *second) {
+    u64 n1 = first->sample_count, n2 = second->sample_count, n = n1 + n2;
+    results_ranked_sample *ranked = malloc(n*sizeof(results_ranked_sample));
+    f64 scale1 = first->cpu_freq ? 1e9/(f64)first->cpu_freq : 1.0;
+    f64 scale2 = second->cpu_freq ? 1e9/(f64)second->cpu_freq : 1.0;
+    for(u64 idx = 0; idx < n1; ++idx) {
+        ranked[idx] = (results_ranked_sample) { (u64)((f64)first->samples[idx]*scale1), false };
+    }
+    for(u64 idx = 0; idx < n2; ++idx) {
+        ranked[n1 + idx] = (results_ranked_sample) { (u64)((f64)second->samples[idx]*scale2), true };
+    }
+    qsort(ranked, n, sizeof(results_ranked_sample), results_compare_ranked);
+
+    f64 rank_sum1 = 0.0;
+    f64 tie_term = 0.0;
+    for(u64 start = 0; start < n;) {
+        u64 end = start + 1;
+        while(end < n && ranked[end].value == ranked[start].value) ++end;
+        f64 tied = (f64)(end - start);
+        f64 average_rank = 0.5*(f64)(start + 1 + end);
+        for(u64 idx = start; idx < end; ++idx) {
+            if(!ranked[idx].second) rank_sum1 += average_rank;
+        }
+        tie_term += tied*tied*tied - tied;
+        start = end;
+    }
+    free(ranked);
+
+    f64 u1 = rank_sum1 - (f64)n1*(f64)(n1 + 1)/2.0;
+    f64 mean = (f64)n1*(f64)n2/2.0;
+    f64 variance = (f64)n1*(f64)n2/12.0*((f64)(n + 1) - tie_term/((f64)n*(f64)(n - 1)));
+    if(variance <= 0.0) return 1.0;
+
+    f64 z = (fabs(u1 - mean) - 0.5)/sqrt(variance);
+    if(z < 0.0) z = 0.0;
+
+    return erfc(z/sqrt(2.0));
+}
+
+internal f64
+results_median_seconds(result_row *row) {
+    if(!row->cpu_freq) return 0.0;
+    u64 median = row->sample_count ? row->median_cycles : row->total_cycles/(row->repetitions ? row->repetitions : 1);
+
+    return (f64)median/(f64)row->cpu_freq;
+}
+
+/* NOTE(abid): Prints every (source, stage) of `new_filename` that `old_filename` also has, with
+ * the median change and the test's verdict. Returns the number of regressions. */
+internal u32
+results_compare(char *old_filename, char *new_filename) {
+    result_set old_set, new_set;
+    assert(results_load(old_filename, &old_set), "cannot read results `%s`.", old_filename);
+    assert(results_load(new_filename, &new_set), "cannot read results `%s`.", new_filename);
+
+    printf("Old: %s (git %s, %s, %llu rows)\n", old_filename, old_set.git_hash, old_set.cpu, old_set.count);
+    printf("New: %s (git %s, %s, %llu rows)\n", new_filename, new_set.git_hash, new_set.cpu, new_set.count);
+    if(strcmp(old_set.cpu, new_set.cpu) != 0) printf("Warning: the results come from different CPUs.\n");
+    printf("\n%-40s %12s %12s %9s %10s  %s\n", "stage", "old median", "new median", "change", "p-value", "verdict");
+
+    u32 regressions = 0;
+    u32 matched = 0;
+    for(u64 new_idx = 0; new_idx < new_set.count; ++new_idx) {
+        result_row *new_row = new_set.rows + new_idx;
+        result_row *old_row = NULL;
+        for(u64 old_idx = 0; old_idx < old_set.count && !old_row; ++old_idx) {
+            result_row *candidate = old_set.rows + old_idx;
+            if(strcmp(candidate->source, new_row->source) == 0 && strcmp(candidate->stage, new_row->stage) == 0) {
+                old_row = candidate;
+            }
+        }
+        if(!old_row) continue;
+        ++matched;
+
+        f64 old_seconds = results_median_seconds(old_row);
+        f64 new_seconds = results_median_seconds(new_row);
+        f64 change = (old_seconds > 0.0) ? new_seconds/old_seconds - 1.0 : 0.0;
+
+        char name[128];
+        snprintf(name, sizeof(name), "%s %s", new_row->source, new_row->stage);
+        printf("%-40s %10.4fms %10.4fms %+8.2f%%", name, 1000.0*old_seconds, 1000.0*new_seconds, 100.0*change);
+        if(old_row->sample_count < RESULTS_MIN_SAMPLES || new_row->sample_count < RESULTS_MIN_SAMPLES) {
+            printf(" %10s  too few samples\n", "-");
+            continue;
+        }
+
+        f64 p_value = results_rank_sum_p_value(old_row, new_row);
+        char *verdict = "same";
+        if(p_value < RESULTS_SIGNIFICANCE && change > RESULTS_REGRESSION_THRESHOLD) {
+            verdict = "REGRESSION";
+            ++regressions;
+        } else if(p_value < RESULTS_SIGNIFICANCE && change < -RESULTS_REGRESSION_THRESHOLD) {
+            verdict = "improvement";
+        }
+        printf(" %10.2e  %s\n", p_value, verdict);
+    }
+    printf("\n%u stages compared, %u regression(s) (median slower by more than %.0f%%, p < %.2f)\n", matched,
+           regressions, 100.0*RESULTS_REGRESSION_THRESHOLD, RESULTS_SIGNIFICANCE);
+
+    results_free(&old_set);
+    results_free(&new_set);
+
+    return regressions;
+}
@@ -0,0 +1,82 @@
+/*  +======| File Info |===============================================================+
+    |                                                                                  |
+    |     Subdirectory:  /src                                                          |
+    |    Creation date:  10/20/2026 9:26:14 AM                                         |
+    |    Last Modified:                                                                |
+    |                                                                                  |
+    +======================================| Copyright © Sayed Abid Hashimi |==========+  */
+
+#if !defined(RESULTS_H)
+
+/* NOTE(abid): Machine readable results. With `--results=file` every timed thing of the run
+ * (repetition tests, memory probe, profiler blocks, the benchmark stages) also goes to `file` as
+ * one row each, CSV or JSON lines (one object per line) depending on the extension. A row is
+ * keyed by (source, stage) and carries the git hash and CPU it ran on, the bytes it processed,
+ * cycle totals and the per-repetition cycle samples when there are any:
+ *
+ *   git,cpu,source,stage,bytes,repetitions,total_cycles,min_cycles,median_cycles,cpu_freq,samples
+ *
+ * Samples are `;` separated in CSV and an array in JSON. `--compare=old,new` reads two such files
+ * and tests every stage present in both for a change of the median, see `results_compare`. */
+#define RESULT_FORMATS \
+    X(csv)             \
+    X(json)
+
+typedef enum {
+#define X(value) rf_ ## value,
+    RESULT_FORMATS
+#undef X
+    rf_count
+} result_format;
+
+char *result_format_str[] = {
+#define X(value) #value,
+    RESULT_FORMATS
+#undef X
+};
+
+/* NOTE(abid): Passed on the command line by the build (see the Makefile). */
+#if !defined(GIT_HASH)
+#define GIT_HASH "unknown"
+#endif
+
+typedef struct {
+    char *source; /* NOTE(abid): reptest, probe, profiler or benchmark. */
+    char *stage;
+    u64 bytes;
+    u64 repetitions;
+    u64 total_cycles;
+    u64 min_cycles;
+    u64 median_cycles;
+    u64 cpu_freq;
+
+    /* NOTE(abid): Cycles of each repetition, NULL for rows that only have totals (profiler). */
+    u64 sample_count;
+    u64 *samples;
+} result_row;
+
+typedef struct {
+    FILE *file;
+    result_format format;
+    char cpu[49];
+} results_writer;
+
+/* NOTE(abid): A loaded results file, strings and samples point into `data`. */
+typedef struct {
+    char *data;
+    char git_hash[64];
+    char cpu[64];
+    u64 count;
+    result_row *rows;
+} result_set;
+
+#define RESULTS_CSV_COLUMNS 11
+/* NOTE(abid): A stage regresses when its median got slower by more than the threshold and the
+ * rank-sum test says the samples differ at the significance level. Fewer samples than
+ * `RESULTS_MIN_SAMPLES` on either side are reported but never flagged. */
+#define RESULTS_REGRESSION_THRESHOLD 0.02
+#define RESULTS_SIGNIFICANCE 0.01
+#define RESULTS_MIN_SAMPLES 8
+
+#define RESULTS_H
+#endif
@@ -0,0 +1,329 @@
+/*  +======| File Info |===============================================================+
+    |                                                                                  |
+    |     Subdirectory:  /src                                                          |
+    |    Creation date:  10/20/2026 11:12:40 AM                                        |
+    |    Last Modified:                                                                |
+    |                                                                                  |
+    +======================================| Copyright © Sayed Abid Hashimi |==========+  */
+
+#if PLT_LINUX
+#include <signal.h>
+#include <sys/time.h>
+#include <ucontext.h>
+#include <elf.h>
+#endif
+
+#include "sampler.h"
+
+global_var sampler_state sampler;
+global_var thread_local_var sampler_ring *sampler_thread_ring;
+
+#if PLT_LINUX
+/* NOTE(abid): Runs on the interrupted thread with SIGPROF blocked, so a ring never sees two
+ * writers. Only touches the ring and the ucontext, nothing that is not async-signal-safe. */
+internal void
+sampler_signal_handler(i32 signal, siginfo_t *info, void *context) {
+    (void)signal; (void)info;
+    u64 start = platform_get_cpu_timer();
+    sampler_ring *ring = sampler_thread_ring;
+    if(!ring) {
+        u64 ring_idx = platform_atomic_add_u64(&sampler.thread_count, 1);
+        if(ring_idx >= SAMPLER_MAX_THREADS) {
+            platform_atomic_add_u64(&sampler.lost, 1);
+            return;
+        }
+        ring = sampler_thread_ring = sampler.rings + ring_idx;
+    }
+
+    mcontext_t *registers = &((ucontext_t *)context)->uc_mcontext;
+    sampler_stack *stack = ring->stacks + (ring->write_count & (SAMPLER_RING_SAMPLES - 1));
+    u64 sp = (u64)registers->gregs[REG_RSP];
+    u64 fp = (u64)registers->gregs[REG_RBP];
+    stack->frames[0] = (u64)registers->gregs[REG_RIP];
+    stack->depth = 1;
+    /* NOTE(abid): [fp] = caller's fp, [fp + 8] = return address. Anything not above the previous
+     * frame, misaligned or outside the window is code without frame pointers using rbp. */
+    while(stack->depth < SAMPLER_MAX_DEPTH && fp >= sp && fp < sp + SAMPLER_STACK_WINDOW && !(fp & 7)) {
+        u64 *frame = (u64 *)fp;
+        if(!frame[1]) break;
+        stack->frames[stack->depth++] = frame[1];
+        if(frame[0] <= fp) break;
+        fp = frame[0];
+    }
+
+    ring->handler_cycles += platform_get_cpu_timer() - start;
+    __atomic_store_n(&ring->write_count, ring->write_count + 1, __ATOMIC_RELEASE);
+}
+#endif
+
+/* NOTE(abid): Rings are reserved up front, the handler cannot allocate. Pages are committed by
+ * the first stacks written into them. */
+internal bool
+sampler_start(u32 hz, char *filename) {
+#if PLT_LINUX
+    if(!hz) hz = SAMPLER_DEFAULT_HZ;
+    usize ring_bytes = SAMPLER_RING_SAMPLES*sizeof(sampler_stack);
+    usize reserve_size = SAMPLER_MAX_THREADS*(ring_bytes + sizeof(sampler_ring));
+    u8 *memory = platform_commit(platform_reserve(reserve_size), reserve_size);
+    sampler = (sampler_state) {
+        .hz = hz,
+        .filename = filename ? filename : SAMPLER_DEFAULT_FILENAME,
+        .rings = (sampler_ring *)memory,
+    };
+    for(u32 ring_idx = 0; ring_idx < SAMPLER_MAX_THREADS; ++ring_idx) {
+        sampler.rings[ring_idx].stacks = (sampler_stack *)(memory + SAMPLER_MAX_THREADS*sizeof(sampler_ring) +
+                                                           ring_idx*ring_bytes);
+    }
+
+    struct sigaction action = {0};
+    action.sa_sigaction = sampler_signal_handler;
+    action.sa_flags = SA_SIGINFO | SA_RESTART;
+    sigemptyset(&action.sa_mask);
+    if(sigaction(SIGPROF, &action, NULL) != 0) return false;
+
+    u64 interval_us = 1000000/hz ? 1000000/hz : 1;
+    struct itimerval timer = {
+        .it_interval = { .tv_sec = (time_t)(interval_us/1000000), .tv_usec = (suseconds_t)(interval_us%1000000) },
+        .it_value = { .tv_sec = (time_t)(interval_us/1000000), .tv_usec = (suseconds_t)(interval_us%1000000) },
+    };
+    if(setitimer(ITIMER_PROF, &timer, NULL) != 0) return false;
+    sampler.running = true;
+
+    return true;
+#else
+    (void)hz; (void)filename;
+    return false;
+#endif
+}
+
+#if PLT_LINUX
+internal i32
+sampler_compare_symbols(const void *a, const void *b) {
+    u64 address_a = ((sampler_symbol *)a)->address, address_b = ((sampler_symbol *)b)->address;
+    return (address_a > address_b) - (address_a < address_b);
+}
+
+internal i32
+sampler_compare_lines(const void *a, const void *b) {
+    return strcmp(*(char **)a, *(char **)b);
+}
+
+/* NOTE(abid): Maps the ELF file and collects its function symbols and PT_LOAD segments. A file
+ * that cannot be read leaves the module without symbols, its frames print as [name]. */
+internal void
+sampler_module_load(sampler_module *module) {
+    module->name = strrchr(module->path, '/') ? strrchr(module->path, '/') + 1 : module->path;
+    if(module->path[0] != '/') return;
+    module->file = platform_file_map(module->path, &module->file_size);
+    if(!module->file || module->file_size < sizeof(Elf64_Ehdr)) return;
+
+    u8 *file = (u8 *)module->file;
+    Elf64_Ehdr *header = (Elf64_Ehdr *)file;
+    if(memcmp(header->e_ident, ELFMAG, SELFMAG) != 0 || header->e_ident[EI_CLASS] != ELFCLASS64) return;
+    if(header->e_phoff + (u64)header->e_phnum*sizeof(Elf64_Phdr) > module->file_size ||
+       header->e_shoff + (u64)header->e_shnum*sizeof(Elf64_Shdr) > module->file_size) return;
+
+    Elf64_Phdr *segments = (Elf64_Phdr *)(file + header->e_phoff);
+    for(u32 idx = 0; idx < header->e_phnum && module->load_count < SAMPLER_MAX_LOADS; ++idx) {
+        if(segments[idx].p_type != PT_LOAD) continue;
+        module->load_offsets[module->load_count] = segments[idx].p_offset;
+        module->load_addresses[module->load_count] = segments[idx].p_vaddr;
+        module->load_sizes[module->load_count] = segments[idx].p_filesz;
+        ++module->load_count;
+    }
+
+    /* NOTE(abid): .symtab has the static functions too, .dynsym is all a stripped file keeps. */
+    Elf64_Shdr *sections = (Elf64_Shdr *)(file + header->e_shoff);
+    Elf64_Shdr *symbol_table = NULL;
+    for(u32 idx = 0; idx < header->e_shnum; ++idx) {
+        if(sections[idx].sh_type == SHT_SYMTAB) symbol_table = sections + idx;
+        if(sections[idx].sh_type == SHT_DYNSYM && !symbol_table) symbol_table = sections + idx;
+    }
+    if(!symbol_table || symbol_table->sh_link >= header->e_shnum) return;
+    Elf64_Shdr *string_table = sections + symbol_table->sh_link;
+    if(symbol_table->sh_offset + symbol_table->sh_size > module->file_size ||
+       string_table->sh_offset + string_table->sh_size > module->file_size) return;
+
+    Elf64_Sym *symbols = (Elf64_Sym *)(file + symbol_table->sh_offset);
+    u64 count = symbol_table->sh_size/sizeof(Elf64_Sym);
+    module->symbols = malloc(count*sizeof(sampler_symbol));
+    for(u64 idx = 0; idx < count; ++idx) {
+        u32 type = ELF64_ST_TYPE(symbols[idx].st_info);
+        if((type != STT_FUNC && type != STT_GNU_IFUNC) || symbols[idx].st_shndx == SHN_UNDEF ||
+           !symbols[idx].st_value || symbols[idx].st_name >= string_table->sh_size) continue;
+        module->symbols[module->symbol_count++] = (sampler_symbol) {
+            .address = symbols[idx].st_value,
+            .size = symbols[idx].st_size,
+            .name = (char *)file + string_table->sh_offset + symbols[idx].st_name,
+        };
+    }
+    qsort(module->symbols, module->symbol_count, sizeof(sampler_symbol), sampler_compare_symbols);
+}
+
+/* NOTE(abid): Executable mappings of the process, each pointing at the module of its file. */
+internal u32
+sampler_read_mappings(sampler_mapping *mappings, u32 max_mappings, sampler_module *modules, u32 *module_count,
+                      u32 max_modules) {
+    FILE *maps = fopen("/proc/self/maps", "r");
+    if(!maps) return 0;
+
+    u32 count = 0;
+    char line[512];
+    while(count < max_mappings && fgets(line, sizeof(line), maps)) {
+        u64 start, end, offset;
+        char permissions[8], path[256] = {0};
+        if(sscanf(line, "%llx-%llx %7s %llx %*s %*s %255[^\n]", &start, &end, permissions, &offset, path) < 4) continue;
+        if(permissions[2] != 'x') continue;
+
+        sampler_module *module = NULL;
+        for(u32 idx = 0; idx < *module_count && !module; ++idx) {
+            if(strcmp(modules[idx].path, path) == 0) module = modules + idx;
+        }
+        if(!module) {
+            if(*module_count == max_modules) continue;
+            module = modules + (*module_count)++;
+            snprintf(module->path, sizeof(module->path), "%s", path[0] ? path : "[anonymous]");
+            sampler_module_load(module);
+        }
+        mappings[count++] = (sampler_mapping) { .start = start, .end = end, .offset = offset, .module = module };
+    }
+    fclose(maps);
+
+    return count;
+}
+
+/* NOTE(abid): `address` is a return address for every frame but the first, one byte back is
+ * still inside the call, which matters for calls that are the last instruction of a function. */
+internal void
+sampler_symbolize(sampler_mapping *mappings, u32 mapping_count, u64 address, char *name, usize name_size) {
+    sampler_mapping *mapping = NULL;
+    for(u32 idx = 0; idx < mapping_count && !mapping; ++idx) {
+        if(address >= mappings[idx].start && address < mappings[idx].end) mapping = mappings + idx;
+    }
+    if(!mapping) {
+        snprintf(name, name_size, "[unknown]");
+        return;
+    }
+
+    sampler_module *module = mapping->module;
+    u64 file_offset = address - mapping->start + mapping->offset;
+    u64 elf_address = 0;
+    bool in_segment = false;
+    for(u32 idx = 0; idx < module->load_count && !in_segment; ++idx) {
+        if(file_offset >= module->load_offsets[idx] && file_offset < module->load_offsets[idx] + module->load_sizes[idx]) {
+            elf_address = file_offset - module->load_offsets[idx] + module->load_addresses[idx];
+            in_segment = true;
+        }
+    }
+
+    /* NOTE(abid): Last symbol starting at or before the address. */
+    u64 low = 0, high = module->symbol_count;
+    while(in_segment && low < high) {
+        u64 mid = low + (high - low)/2;
+        if(module->symbols[mid].address <= elf_address) low = mid + 1;
+        else high = mid;
+    }
+    sampler_symbol *symbol = (in_segment && low) ? module->symbols + low - 1 : NULL;
+    if(symbol && (elf_address < symbol->address + symbol->size || !symbol->size)) snprintf(name, name_size, "%s", symbol->name);
+    else snprintf(name, name_size, "[%s]", module->name);
+}
+#endif
+
+/* NOTE(abid): Stops the timer and writes the collapsed stacks, registered with atexit by
+ * `sampler_begin`. */
+internal void
+sampler_finish() {
+#if PLT_LINUX
+    if(!sampler.running) return;
+    struct itimerval stop = {0};
+    setitimer(ITIMER_PROF, &stop, NULL);
+    signal(SIGPROF, SIG_IGN);
+    sampler.running = false;
+
+    u64 claimed = platform_atomic_load_u64(&sampler.thread_count);
+    u32 thread_count = (u32)(claimed < SAMPLER_MAX_THREADS ? claimed : SAMPLER_MAX_THREADS);
+    u64 sample_count = 0, overwritten = 0, handler_cycles = 0;
+    for(u32 ring_idx = 0; ring_idx < thread_count; ++ring_idx) {
+        u64 written = platform_atomic_load_u64(&sampler.rings[ring_idx].write_count);
+        u64 kept = written < SAMPLER_RING_SAMPLES ? written : SAMPLER_RING_SAMPLES;
+        sample_count += kept;
+        overwritten += written - kept;
+        handler_cycles += sampler.rings[ring_idx].handler_cycles;
+    }
+
+    local_persist sampler_module modules[64];
+    local_persist sampler_mapping mappings[512];
+    u32 module_count = 0;
+    u32 mapping_count = sampler_read_mappings(mappings, 512, modules, &module_count, 64);
+
+    /* NOTE(abid): One line per sample, root first, then sorted so equal stacks are adjacent. */
+    usize text_size = megabyte(1), text_used = 0;
+    char *text = malloc(text_size);
+    u64 *line_offsets = malloc((sample_count + 1)*sizeof(u64));
+    u64 line_count = 0;
+    for(u32 ring_idx = 0; ring_idx < thread_count; ++ring_idx) {
+        sampler_ring *ring = sampler.rings + ring_idx;
+        u64 written = ring->write_count;
+        u64 kept = written < SAMPLER_RING_SAMPLES ? written : SAMPLER_RING_SAMPLES;
+        for(u64 sample = written - kept; sample < written; ++sample) {
+            sampler_stack *stack = ring->stacks + (sample & (SAMPLER_RING_SAMPLES - 1));
+            if(text_size - text_used < SAMPLER_MAX_DEPTH*256 + 1) {
+                text_size *= 2;
+                text = realloc(text, text_size);
+            }
+            line_offsets[line_count++] = text_used;
+            for(i32 frame = (i32)stack->depth - 1; frame >= 0; --frame) {
+                char name[256];
+                sampler_symbolize(mappings, mapping_count, stack->frames[frame] - (frame > 0), name, sizeof(name));
+                text_used += (usize)snprintf(text + text_used, text_size - text_used, "%s%s", name, frame ? ";" : "");
+            }
+            text[text_used++] = 0;
+        }
+    }
+    char **lines = malloc((line_count + 1)*sizeof(char *));
+    for(u64 idx = 0; idx < line_count; ++idx) lines[idx] = text + line_offsets[idx];
+    qsort(lines, line_count, sizeof(char *), sampler_compare_lines);
+
+    FILE *output = fopen(sampler.filename, "w");
+    u64 distinct = 0;
+    if(output) {
+        for(u64 idx = 0; idx < line_count;) {
+            u64 run = idx + 1;
+            while(run < line_count && strcmp(lines[run], lines[idx]) == 0) ++run;
+            fprintf(output, "%s %llu\n", lines[idx], run - idx);
+            ++distinct;
+            idx = run;
+        }
+        fclose(output);
+    }
+
+    /* NOTE(abid): The handler's share of the CPU time the samples stand for. Kernel signal
+     * delivery is not in it, it adds a few microseconds per sample. */
+    f64 sampled_cycles = (f64)(sample_count + overwritten)*(f64)platform_get_cpu_timer_freq_estimate(0)/(f64)sampler.hz;
+    printf("Sampler: %llu samples at %u Hz on %u threads, %llu distinct stacks -> %s%s\n", sample_count, sampler.hz,
+           thread_count, distinct, sampler.filename, output ? "" : " (cannot write)");
+    printf("  Handler: %.0f cycles per sample, %.3f%% of the sampled time", sample_count ?
+           (f64)handler_cycles/(f64)(sample_count + overwritten) : 0.0, sampled_cycles > 0.0 ?
+           100.0*(f64)handler_cycles/sampled_cycles : 0.0);
+    if(overwritten) printf(", %llu oldest samples overwritten", overwritten);
+    if(sampler.lost) printf(", %llu ticks on threads past %u lost", sampler.lost, SAMPLER_MAX_THREADS);
+    printf("\n");
+
+    free(lines);
+    free(line_offsets);
+    free(text);
+    for(u32 idx = 0; idx < module_count; ++idx) {
+        if(modules[idx].file) platform_file_unmap(modules[idx].file, modules[idx].file_size);
+        free(modules[idx].symbols);
+    }
+#endif
+}
+
+/* NOTE(abid): Starts sampling, the profile is written at exit. */
+internal bool
+sampler_begin(u32 hz, char *filename) {
+    if(!sampler_start(hz, filename)) return false;
+    atexit(sampler_finish);
+
+    return true;
+}
@@ -0,0 +1,84 @@
+/*  +======| File Info |===============================================================+
+    |                                                                                  |
+    |     Subdirectory:  /src                                                          |
+    |    Creation date:  10/20/2026 11:12:40 AM                                        |
+    |    Last Modified:                                                                |
+    |                                                                                  |
+    +======================================| Copyright © Sayed Abid Hashimi |==========+  */
+
+#if !defined(SAMPLER_H)
+
+/* NOTE(abid): Sampling profiler for what the instrumentation does not cover (libm, strtod, the
+ * blocks nobody annotated). `--sample[=hz]` arms ITIMER_PROF, every tick of consumed CPU time
+ * raises SIGPROF on the thread that consumed it and the handler stores the interrupted
+ * instruction pointer plus the return addresses of the frame pointer chain into that thread's
+ * ring. A ring has one writer (the handler of its thread, which cannot nest) and is only read
+ * once the timer is stopped, so there are no locks, a full ring overwrites its oldest stacks.
+ *
+ * At exit the stacks are symbolized from the ELF symbol tables of the executable and of the
+ * shared objects listed in /proc/self/maps (.symtab, or .dynsym when stripped, code without a
+ * symbol shows as [module]) and written as collapsed stacks, one `root;...;leaf count` line per
+ * distinct stack, which flamegraph.pl and speedscope read as they are.
+ *
+ * Frames are only followed through code built with frame pointers (the Makefile passes
+ * -fno-omit-frame-pointer), a leaf without them (libm) still shows with its caller's chain
+ * missing one frame at most. Linux x86-64 only. */
+#define SAMPLER_DEFAULT_HZ 1000
+#define SAMPLER_DEFAULT_FILENAME "haversine_samples.folded"
+#define SAMPLER_MAX_THREADS 64
+#define SAMPLER_MAX_DEPTH 48
+#define SAMPLER_RING_SAMPLES (1 << 16)
+/* NOTE(abid): A frame pointer further than this above the interrupted stack pointer ends the
+ * walk, it is not a frame of this thread's stack. */
+#define SAMPLER_STACK_WINDOW megabyte(8)
+#define SAMPLER_MAX_LOADS 16
+
+typedef struct {
+    u32 depth;
+    u64 frames[SAMPLER_MAX_DEPTH]; /* NOTE(abid): Interrupted ip first, then return addresses outwards. */
+} sampler_stack;
+
+typedef struct {
+    volatile u64 write_count; /* NOTE(abid): Stacks ever written, the ring keeps the last SAMPLER_RING_SAMPLES. */
+    u64 handler_cycles;
+    sampler_stack *stacks;
+} sampler_ring;
+
+typedef struct {
+    bool running;
+    u32 hz;
+    char *filename;
+    volatile u64 thread_count; /* NOTE(abid): Rings claimed, can pass SAMPLER_MAX_THREADS. */
+    volatile u64 lost; /* NOTE(abid): Ticks on threads beyond SAMPLER_MAX_THREADS. */
+    sampler_ring *rings;
+} sampler_state;
+
+/* NOTE(abid): Symbolization, one module per mapped file with code in it. */
+typedef struct {
+    u64 address;
+    u64 size;
+    char *name;
+} sampler_symbol;
+
+typedef struct {
+    char path[256];
+    char *name; /* NOTE(abid): Basename of `path`. */
+    void *file;
+    usize file_size;
+    u32 load_count;
+    u64 load_offsets[SAMPLER_MAX_LOADS];
+    u64 load_addresses[SAMPLER_MAX_LOADS];
+    u64 load_sizes[SAMPLER_MAX_LOADS];
+    u64 symbol_count;
+    sampler_symbol *symbols;
+} sampler_module;
+
+typedef struct {
+    u64 start;
+    u64 end;
+    u64 offset;
+    sampler_module *module;
+} sampler_mapping;
+
+#define SAMPLER_H
+#endif
@@ -0,0 +1,150 @@
+/*  +======| File Info |===============================================================+
+    |                                                                                  |
+    |     Subdirectory:  /src                                                          |
+    |    Creation date:  10/19/2026 11:12:05 PM                                        |
+    |    Last Modified:                                                                |
+    |                                                                                  |
+    +======================================| Copyright © Sayed Abid Hashimi |==========+  */
+
+#include "shards.h"
+
+inline internal stream_checksum
+stream_checksum_init(void) { return (stream_checksum) { .hash = SHARD_CHECKSUM_SEED }; }
+
+inline internal u64
+stream_checksum_word(u64 hash, u64 word) {
+    hash ^= word*0xFF51AFD7ED558CCDULL;
+    return ((hash << 29) | (hash >> 35))*0xC4CEB9FE1A85EC53ULL;
+}
+
+internal void
+stream_checksum_update(stream_checksum *checksum, void *data, usize size) {
+    u8 *bytes = (u8 *)data;
+    checksum->total_bytes += size;
+
+    /* NOTE(abid): Top up the partial word left by the previous update first. */
+    while(size && checksum->pending_bytes) {
+        checksum->pending |= (u64)*bytes++ << (8*checksum->pending_bytes);
+        --size;
+        if(++checksum->pending_bytes == sizeof(u64)) {
+            checksum->hash = stream_checksum_word(checksum->hash, checksum->pending);
+            checksum->pending = 0;
+            checksum->pending_bytes = 0;
+        }
+    }
+    for(; size >= sizeof(u64); size -= sizeof(u64), bytes += sizeof(u64)) {
+        u64 word;
+        memcpy(&word, bytes, sizeof(u64));
+        checksum->hash = stream_checksum_word(checksum->hash, word);
+    }
+    for(; size; --size) checksum->pending |= (u64)*bytes++ << (8*checksum->pending_bytes++);
+}
+
+inline internal u64
+stream_checksum_finalize(stream_checksum *checksum) {
+    u64 hash = checksum->hash;
+    if(checksum->pending_bytes) hash = stream_checksum_word(hash, checksum->pending);
+    return rand_mix64(hash ^ checksum->total_bytes);
+}
+
+/* NOTE(abid): Checksum and size of a whole file, false if it cannot be read. */
+internal bool
+stream_checksum_file(char *filename, u64 *size_out, u64 *checksum_out) {
+    usize size = 0;
+    void *data = platform_file_map(filename, &size);
+    FILE *exists = data ? NULL : fopen(filename, "rb");
+    if(data == NULL && exists == NULL) return false;
+    if(exists) fclose(exists);
+
+    stream_checksum checksum = stream_checksum_init();
+    if(data) stream_checksum_update(&checksum, data, size);
+    *size_out = size;
+    *checksum_out = stream_checksum_finalize(&checksum);
+    if(data) platform_file_unmap(data, size);
+
+    return true;
+}
+
+/* NOTE(abid): `name.s<shard><extension>`, or `name<extension>` for an unsharded dataset
+ * (shard_count 0). */
+internal char *
+shard_filename(char *filename, u32 shard_count, u32 shard, char *extension) {
+    if(shard_count == 0) return filename_with_extension(filename, extension);
+
+    usize len = strlen(filename) + strlen(extension) + 16;
+    char *result = malloc(len);
+    snprintf(result, len, "%s.s%u%s", filename, shard, extension);
+
+    return result;
+}
+
+/* NOTE(abid): Shard s covers chunks [first(s), first(s + 1)). */
+inline internal u64
+shard_first_chunk(u64 chunk_count, u32 shard_count, u32 shard) {
+    return chunk_count*shard/shard_count;
+}
+
+internal void
+shard_manifest_write(char *filename, shard_manifest *manifest) {
+    char *manifest_filename = filename_with_extension(filename, ".manifest");
+    FILE *file = fopen(manifest_filename, "wb");
+    assert(file, "cannot open %s for writing.", manifest_filename);
+
+    fprintf(file, "%s %u pairs %llu seed %llu clusters %llu distribution %u quantize %u shards %u\n",
+            SHARD_MANIFEST_MAGIC, SHARD_MANIFEST_VERSION, manifest->number_pairs, manifest->seed,
+            manifest->num_clusters, manifest->distribution, (u32)manifest->quantize_q32, manifest->shard_count);
+    for(u32 idx = 0; idx < manifest->shard_count; ++idx) {
+        shard_entry *shard = manifest->shards + idx;
+        fprintf(file, "shard %u %llu %llu %llu %016llx %llu %016llx %llu %016llx %.17g\n", idx,
+                shard->first_pair, shard->count, shard->json_bytes, shard->json_checksum, shard->f64_bytes,
+                shard->f64_checksum, shard->pairs_bytes, shard->pairs_checksum, shard->expected_sum);
+    }
+
+    fclose(file);
+    free(manifest_filename);
+}
+
+/* NOTE(abid): False (with a message) if the manifest is missing or malformed, `shards` is
+ * malloc'd. */
+internal bool
+shard_manifest_read(char *filename, shard_manifest *manifest) {
+    *manifest = (shard_manifest) {0};
+    char *manifest_filename = filename_with_extension(filename, ".manifest");
+    FILE *file = fopen(manifest_filename, "rb");
+    char *error = file ? NULL : "missing";
+
+    char magic[32];
+    u32 version = 0, quantize = 0;
+    if(!error && (fscanf(file, "%31s %u pairs %llu seed %llu clusters %llu distribution %u quantize %u shards %u",
+                         magic, &version, &manifest->number_pairs, &manifest->seed, &manifest->num_clusters,
+                         &manifest->distribution, &quantize, &manifest->shard_count) != 8 ||
+                  strcmp(magic, SHARD_MANIFEST_MAGIC) != 0 || version != SHARD_MANIFEST_VERSION)) {
+        error = "bad header";
+    }
+    manifest->quantize_q32 = quantize != 0;
+
+    if(!error) manifest->shards = calloc(manifest->shard_count + 1, sizeof(shard_entry));
+    u64 next_pair = 0;
+    for(u32 idx = 0; !error && idx < manifest->shard_count; ++idx) {
+        shard_entry *shard = manifest->shards + idx;
+        u32 shard_idx;
+        if(fscanf(file, " shard %u %llu %llu %llu %llx %llu %llx %llu %llx %lf", &shard_idx, &shard->first_pair,
+                  &shard->count, &shard->json_bytes, &shard->json_checksum, &shard->f64_bytes, &shard->f64_checksum,
+                  &shard->pairs_bytes, &shard->pairs_checksum, &shard->expected_sum) != 10 ||
+           shard_idx != idx || shard->first_pair != next_pair) {
+            error = "bad shard line";
+        }
+        next_pair += shard->count;
+    }
+    if(!error && next_pair != manifest->number_pairs) error = "shards do not cover the dataset";
+
+    if(file) fclose(file);
+    if(error) {
+        printf("%s: %s\n", manifest_filename, error);
+        free(manifest->shards);
+        *manifest = (shard_manifest) {0};
+    }
+    free(manifest_filename);
+
+    return error == NULL;
+}
@@ -0,0 +1,57 @@
+/*  +======| File Info |===============================================================+
+    |                                                                                  |
+    |     Subdirectory:  /src                                                          |
+    |    Creation date:  10/19/2026 11:12:05 PM                                        |
+    |    Last Modified:                                                                |
+    |                                                                                  |
+    +======================================| Copyright © Sayed Abid Hashimi |==========+  */
+
+#if !defined(SHARDS_H)
+
+/* NOTE(abid): Sharded datasets. The generator can split a dataset into shards on chunk boundaries,
+ * shard s is written as `name.s<s>.json`, `.f64` and `.pairs`, each a complete dataset of its own,
+ * and `name.manifest` lists them. Chunks only depend on the seed, so a single shard can be
+ * regenerated on its own and comes out byte identical.
+ * The manifest is text, a header line with the generator settings and one line per shard:
+ *   shard <idx> <first pair> <count> <json bytes> <json checksum> <f64 bytes> <f64 checksum>
+ *         <pairs bytes> <pairs header checksum> <sum of the reference answers>
+ * Checksums are hex, the sum is printed with round-trip digits. */
+#define SHARD_MANIFEST_MAGIC "haversine-manifest"
+#define SHARD_MANIFEST_VERSION 1
+#define SHARD_CHECKSUM_SEED 0x9E3779B97F4A7C15ULL
+
+/* NOTE(abid): The lane kernels and libm agree to ~1e-13 per pair, far inside this. */
+#define SHARD_SUM_TOLERANCE 1e-9
+
+/* NOTE(abid): Byte stream checksum, the result does not depend on how the stream was split. */
+typedef struct {
+    u64 hash;
+    u64 pending;
+    u32 pending_bytes;
+    u64 total_bytes;
+} stream_checksum;
+
+typedef struct {
+    u64 first_pair;
+    u64 count;
+    u64 json_bytes;
+    u64 json_checksum;
+    u64 f64_bytes;
+    u64 f64_checksum;
+    u64 pairs_bytes;
+    u64 pairs_checksum; /* NOTE(abid): Header checksum of the .pairs file, covers its column checksums. */
+    f64 expected_sum;
+} shard_entry;
+
+typedef struct {
+    u64 number_pairs;
+    u64 seed;
+    u64 num_clusters;
+    u32 distribution;
+    bool quantize_q32;
+    u32 shard_count;
+    shard_entry *shards;
+} shard_manifest;
+
+#define SHARDS_H
+#endif
@@ -0,0 +1,211 @@
+/*  +======| File Info |===============================================================+
+    |                                                                                  |
+    |     Subdirectory:  /src                                                          |
+    |    Creation date:  10/19/2026 9:12:40 AM                                         |
+    |    Last Modified:                                                                |
+    |                                                                                  |
+    +======================================| Copyright © Sayed Abid Hashimi |==========+  */
+
+#if !defined(SIMD_H)
+
+#include <immintrin.h>
+
+/* NOTE(abid): Thin lane wrappers so the kernels are written once and compiled for whatever the
+ * target supports. AVX2 gives 4 f64 / 8 f32 lanes, otherwise we fall back to SSE2 which every
+ * x64 target has (2 f64 / 4 f32 lanes). - 19.Oct.2026 */
+#if defined(__AVX2__)
+
+#define LANE_F64_WIDTH 4
+#define LANE_F32_WIDTH 8
+typedef __m256d lane_f64;
+typedef __m256 lane_f32;
+typedef __m256i lane_bits;
+
+#define lane_f64_set1(a)        _mm256_set1_pd(a)
+#define lane_f64_zero()         _mm256_setzero_pd()
+#define lane_f64_load(ptr)      _mm256_loadu_pd(ptr)
+#define lane_f64_store(ptr, a)  _mm256_storeu_pd(ptr, a)
+#define lane_f64_add(a, b)      _mm256_add_pd(a, b)
+#define lane_f64_sub(a, b)      _mm256_sub_pd(a, b)
+#define lane_f64_mul(a, b)      _mm256_mul_pd(a, b)
+#define lane_f64_div(a, b)      _mm256_div_pd(a, b)
+#define lane_f64_sqrt(a)        _mm256_sqrt_pd(a)
+#define lane_f64_min(a, b)      _mm256_min_pd(a, b)
+#define lane_f64_max(a, b)      _mm256_max_pd(a, b)
+#define lane_f64_and(a, b)      _mm256_and_pd(a, b)
+#define lane_f64_andnot(a, b)   _mm256_andnot_pd(a, b)
+#define lane_f64_or(a, b)       _mm256_or_pd(a, b)
+#define lane_f64_xor(a, b)      _mm256_xor_pd(a, b)
+#define lane_f64_gt(a, b)       _mm256_cmp_pd(a, b, _CMP_GT_OQ)
+#define lane_f64_lt(a, b)       _mm256_cmp_pd(a, b, _CMP_LT_OQ)
+#define lane_f64_movemask(a)    _mm256_movemask_pd(a)
+#define lane_f64_as_bits(a)     _mm256_castpd_si256(a)
+#define lane_f64_from_bits(a)   _mm256_castsi256_pd(a)
+#define lane_bits_shl64(a, n)   _mm256_slli_epi64(a, n)
+#define lane_bits_shl32(a, n)   _mm256_slli_epi32(a, n)
+
+#define lane_f32_set1(a)        _mm256_set1_ps(a)
+#define lane_f32_zero()         _mm256_setzero_ps()
+#define lane_f32_load(ptr)      _mm256_loadu_ps(ptr)
+#define lane_f32_store(ptr, a)  _mm256_storeu_ps(ptr, a)
+#define lane_f32_add(a, b)      _mm256_add_ps(a, b)
+#define lane_f32_sub(a, b)      _mm256_sub_ps(a, b)
+#define lane_f32_mul(a, b)      _mm256_mul_ps(a, b)
+#define lane_f32_div(a, b)      _mm256_div_ps(a, b)
+#define lane_f32_sqrt(a)        _mm256_sqrt_ps(a)
+#define lane_f32_min(a, b)      _mm256_min_ps(a, b)
+#define lane_f32_max(a, b)      _mm256_max_ps(a, b)
+#define lane_f32_and(a, b)      _mm256_and_ps(a, b)
+#define lane_f32_andnot(a, b)   _mm256_andnot_ps(a, b)
+#define lane_f32_or(a, b)       _mm256_or_ps(a, b)
+#define lane_f32_xor(a, b)      _mm256_xor_ps(a, b)
+#define lane_f32_gt(a, b)       _mm256_cmp_ps(a, b, _CMP_GT_OQ)
+#define lane_f32_lt(a, b)       _mm256_cmp_ps(a, b, _CMP_LT_OQ)
+#define lane_f32_as_bits(a)     _mm256_castps_si256(a)
+#define lane_f32_from_bits(a)   _mm256_castsi256_ps(a)
+
+/* NOTE(abid): Widening, the f32 lane splits into two f64 lanes (low half, high half). */
+#define lane_f64_from_f32_lo(a) _mm256_cvtps_pd(_mm256_castps256_ps128(a))
+#define lane_f64_from_f32_hi(a) _mm256_cvtps_pd(_mm256_extractf128_ps(a, 1))
+
+/* NOTE(abid): i32 lanes are as wide as the f32 lanes, widened the same way. */
+typedef __m256i lane_i32;
+#define lane_i32_load(ptr)      _mm256_loadu_si256((__m256i *)(ptr))
+#define lane_f64_from_i32_lo(a) _mm256_cvtepi32_pd(_mm256_castsi256_si128(a))
+#define lane_f64_from_i32_hi(a) _mm256_cvtepi32_pd(_mm256_extracti128_si256(a, 1))
+
+/* NOTE(abid): u64 lanes are as wide as the f64 lanes. */
+#define LANE_U64_WIDTH 4
+typedef __m256i lane_u64;
+#define lane_u64_set1(a)        _mm256_set1_epi64x((long long)(a))
+#define lane_u64_load(ptr)      _mm256_loadu_si256((__m256i *)(ptr))
+#define lane_u64_store(ptr, a)  _mm256_storeu_si256((__m256i *)(ptr), a)
+#define lane_u64_add(a, b)      _mm256_add_epi64(a, b)
+#define lane_u64_xor(a, b)      _mm256_xor_si256(a, b)
+#define lane_u64_or(a, b)       _mm256_or_si256(a, b)
+#define lane_u64_shl(a, n)      _mm256_slli_epi64(a, n)
+#define lane_u64_shr(a, n)      _mm256_srli_epi64(a, n)
+#define lane_u64_as_f64(a)      _mm256_castsi256_pd(a)
+
+#define LANE_U8_WIDTH 32
+typedef __m256i lane_u8;
+#define lane_u8_set1(a)         _mm256_set1_epi8((char)(a))
+#define lane_u8_load(ptr)       _mm256_loadu_si256((__m256i *)(ptr))
+#define lane_u8_eq(a, b)        _mm256_cmpeq_epi8(a, b)
+#define lane_u8_or(a, b)        _mm256_or_si256(a, b)
+#define lane_u8_movemask(a)     ((u64)(u32)_mm256_movemask_epi8(a))
+
+#if defined(__FMA__)
+#define lane_f64_fmadd(a, b, c) _mm256_fmadd_pd(a, b, c)
+#define lane_f32_fmadd(a, b, c) _mm256_fmadd_ps(a, b, c)
+#endif
+
+internal inline f64
+lane_f64_hsum(lane_f64 a) {
+    __m128d sum = _mm_add_pd(_mm256_castpd256_pd128(a), _mm256_extractf128_pd(a, 1));
+    sum = _mm_add_sd(sum, _mm_unpackhi_pd(sum, sum));
+    return _mm_cvtsd_f64(sum);
+}
+
+#else
+
+#define LANE_F64_WIDTH 2
+#define LANE_F32_WIDTH 4
+typedef __m128d lane_f64;
+typedef __m128 lane_f32;
+typedef __m128i lane_bits;
+
+#define lane_f64_set1(a)        _mm_set1_pd(a)
+#define lane_f64_zero()         _mm_setzero_pd()
+#define lane_f64_load(ptr)      _mm_loadu_pd(ptr)
+#define lane_f64_store(ptr, a)  _mm_storeu_pd(ptr, a)
+#define lane_f64_add(a, b)      _mm_add_pd(a, b)
+#define lane_f64_sub(a, b)      _mm_sub_pd(a, b)
+#define lane_f64_mul(a, b)      _mm_mul_pd(a, b)
+#define lane_f64_div(a, b)      _mm_div_pd(a, b)
+#define lane_f64_sqrt(a)        _mm_sqrt_pd(a)
+#define lane_f64_min(a, b)      _mm_min_pd(a, b)
+#define lane_f64_max(a, b)      _mm_max_pd(a, b)
+#define lane_f64_and(a, b)      _mm_and_pd(a, b)
+#define lane_f64_andnot(a, b)   _mm_andnot_pd(a, b)
+#define lane_f64_or(a, b)       _mm_or_pd(a, b)
+#define lane_f64_xor(a, b)      _mm_xor_pd(a, b)
+#define lane_f64_gt(a, b)       _mm_cmpgt_pd(a, b)
+#define lane_f64_lt(a, b)       _mm_cmplt_pd(a, b)
+#define lane_f64_movemask(a)    _mm_movemask_pd(a)
+#define lane_f64_as_bits(a)     _mm_castpd_si128(a)
+#define lane_f64_from_bits(a)   _mm_castsi128_pd(a)
+#define lane_bits_shl64(a, n)   _mm_slli_epi64(a, n)
+#define lane_bits_shl32(a, n)   _mm_slli_epi32(a, n)
+
+#define lane_f32_set1(a)        _mm_set1_ps(a)
+#define lane_f32_zero()         _mm_setzero_ps()
+#define lane_f32_load(ptr)      _mm_loadu_ps(ptr)
+#define lane_f32_store(ptr, a)  _mm_storeu_ps(ptr, a)
+#define lane_f32_add(a, b)      _mm_add_ps(a, b)
+#define lane_f32_sub(a, b)      _mm_sub_ps(a, b)
+#define lane_f32_mul(a, b)      _mm_mul_ps(a, b)
+#define lane_f32_div(a, b)      _mm_div_ps(a, b)
+#define lane_f32_sqrt(a)        _mm_sqrt_ps(a)
+#define lane_f32_min(a, b)      _mm_min_ps(a, b)
+#define lane_f32_max(a, b)      _mm_max_ps(a, b)
+#define lane_f32_and(a, b)      _mm_and_ps(a, b)
+#define lane_f32_andnot(a, b)   _mm_andnot_ps(a, b)
+#define lane_f32_or(a, b)       _mm_or_ps(a, b)
+#define lane_f32_xor(a, b)      _mm_xor_ps(a, b)
+#define lane_f32_gt(a, b)       _mm_cmpgt_ps(a, b)
+#define lane_f32_lt(a, b)       _mm_cmplt_ps(a, b)
+#define lane_f32_as_bits(a)     _mm_castps_si128(a)
+#define lane_f32_from_bits(a)   _mm_castsi128_ps(a)
+
+#define lane_f64_from_f32_lo(a) _mm_cvtps_pd(a)
+#define lane_f64_from_f32_hi(a) _mm_cvtps_pd(_mm_movehl_ps(a, a))
+
+typedef __m128i lane_i32;
+#define lane_i32_load(ptr)      _mm_loadu_si128((__m128i *)(ptr))
+#define lane_f64_from_i32_lo(a) _mm_cvtepi32_pd(a)
+#define lane_f64_from_i32_hi(a) _mm_cvtepi32_pd(_mm_shuffle_epi32(a, _MM_SHUFFLE(1, 0, 3, 2)))
+
+#define LANE_U64_WIDTH 2
+typedef __m128i lane_u64;
+#define lane_u64_set1(a)        _mm_set1_epi64x((long long)(a))
+#define lane_u64_load(ptr)      _mm_loadu_si128((__m128i *)(ptr))
+#define lane_u64_store(ptr, a)  _mm_storeu_si128((__m128i *)(ptr), a)
+#define lane_u64_add(a, b)      _mm_add_epi64(a, b)
+#define lane_u64_xor(a, b)      _mm_xor_si128(a, b)
+#define lane_u64_or(a, b)       _mm_or_si128(a, b)
+#define lane_u64_shl(a, n)      _mm_slli_epi64(a, n)
+#define lane_u64_shr(a, n)      _mm_srli_epi64(a, n)
+#define lane_u64_as_f64(a)      _mm_castsi128_pd(a)
+
+#define LANE_U8_WIDTH 16
+typedef __m128i lane_u8;
+#define lane_u8_set1(a)         _mm_set1_epi8((char)(a))
+#define lane_u8_load(ptr)       _mm_loadu_si128((__m128i *)(ptr))
+#define lane_u8_eq(a, b)        _mm_cmpeq_epi8(a, b)
+#define lane_u8_or(a, b)        _mm_or_si128(a, b)
+#define lane_u8_movemask(a)     ((u64)(u32)_mm_movemask_epi8(a))
+
+internal inline f64
+lane_f64_hsum(lane_f64 a) {
+    return _mm_cvtsd_f64(_mm_add_sd(a, _mm_unpackhi_pd(a, a)));
+}
+
+#endif
+
+#if !defined(lane_f64_fmadd)
+#define lane_f64_fmadd(a, b, c) lane_f64_add(lane_f64_mul(a, b), c)
+#define lane_f32_fmadd(a, b, c) lane_f32_add(lane_f32_mul(a, b), c)
+#endif
+
+/* NOTE(abid): Select `a` where the mask is set, `b` otherwise. */
+#define lane_f64_select(mask, a, b) lane_f64_or(lane_f64_and(mask, a), lane_f64_andnot(mask, b))
+#define lane_f32_select(mask, a, b) lane_f32_or(lane_f32_and(mask, a), lane_f32_andnot(mask, b))
+
+#define lane_u64_rotl(a, n) lane_u64_or(lane_u64_shl(a, n), lane_u64_shr(a, 64 - (n)))
+
+#define lane_f64_abs(a) lane_f64_andnot(lane_f64_set1(-0.0), a)
+#define lane_f32_abs(a) lane_f32_andnot(lane_f32_set1(-0.0f), a)
+
+#define SIMD_H
+#endif
@@ -0,0 +1,300 @@
+/*  +======| File Info |===============================================================+
+    |                                                                                  |
+    |     Subdirectory:  /src                                                          |
+    |    Creation date:  10/19/2026 9:40:11 AM                                         |
+    |    Last Modified:                                                                |
+    |                                                                                  |
+    +======================================| Copyright © Sayed Abid Hashimi |==========+  */
+
+#include "simd.h"
+
+/* NOTE(abid): Lane-wide replacements for the libm routines `haversine` relies on. The range
+ * reduction is x = k*pi + r with r in [-pi/2, pi/2], pi split into three parts so that k*PI_A and
+ * k*PI_B are exact for any |k| we will ever see from lat/lon inputs. The polynomials are plain
+ * Taylor series truncated well below half an ulp on that interval, asin uses a Chebyshev fit of
+ * asin(sqrt(t))/sqrt(t) on t in [0, 0.25] plus the half-angle identity above 0.5. - 19.Oct.2026 */
+
+#define F64_INV_PI    0.31830988618379069
+#define F64_PI_A      3.1415926516056061
+#define F64_PI_B      1.9841871583270443e-09
+#define F64_PI_C      1.034036596358821e-18
+#define F64_HALF_PI   1.5707963267948966
+#define F64_ROUND_MAGIC 6755399441055744.0 /* NOTE(abid): 1.5*2^52, adding it rounds to integer. */
+
+#define F32_INV_PI    0.318309886f
+#define F32_PI_A      3.140625f
+#define F32_PI_B      0.000967502594f
+#define F32_PI_C      1.509957991e-07f
+#define F32_HALF_PI   1.57079637f
+#define F32_ROUND_MAGIC 12582912.0f /* NOTE(abid): 1.5*2^23 */
+
+#define lane_f64_horner_step(acc, x, c) lane_f64_fmadd(acc, x, lane_f64_set1(c))
+#define lane_f32_horner_step(acc, x, c) lane_f32_fmadd(acc, x, lane_f32_set1(c))
+
+/* NOTE(abid): Reduce x to r in [-pi/2, pi/2], returns the sign flip mask for odd k. */
+internal inline lane_f64
+lane_f64_reduce_pi(lane_f64 x, lane_f64 *sign_out) {
+    lane_f64 magic = lane_f64_set1(F64_ROUND_MAGIC);
+    lane_f64 k_biased = lane_f64_fmadd(x, lane_f64_set1(F64_INV_PI), magic);
+    lane_f64 k = lane_f64_sub(k_biased, magic);
+
+    lane_f64 r = lane_f64_fmadd(k, lane_f64_set1(-F64_PI_A), x);
+    r = lane_f64_fmadd(k, lane_f64_set1(-F64_PI_B), r);
+    r = lane_f64_fmadd(k, lane_f64_set1(-F64_PI_C), r);
+
+    /* NOTE(abid): The lowest mantissa bit of k_biased is the parity of k, move it to the sign. */
+    *sign_out = lane_f64_from_bits(lane_bits_shl64(lane_f64_as_bits(k_biased), 63));
+    return r;
+}
+
+internal inline lane_f64
+lane_f64_sin_reduced(lane_f64 r) {
+    lane_f64 r2 = lane_f64_mul(r, r);
+    lane_f64 p = lane_f64_set1(1.9572941063391263e-20);
+    p = lane_f64_horner_step(p, r2, -8.2206352466243295e-18);
+    p = lane_f64_horner_step(p, r2, 2.8114572543455206e-15);
+    p = lane_f64_horner_step(p, r2, -7.6471637318198164e-13);
+    p = lane_f64_horner_step(p, r2, 1.6059043836821613e-10);
+    p = lane_f64_horner_step(p, r2, -2.505210838544172e-08);
+    p = lane_f64_horner_step(p, r2, 2.7557319223985893e-06);
+    p = lane_f64_horner_step(p, r2, -0.00019841269841269841);
+    p = lane_f64_horner_step(p, r2, 0.0083333333333333332);
+    p = lane_f64_horner_step(p, r2, -0.16666666666666666);
+    return lane_f64_fmadd(lane_f64_mul(r, r2), p, r);
+}
+
+internal inline lane_f64
+lane_f64_cos_reduced(lane_f64 r) {
+    lane_f64 r2 = lane_f64_mul(r, r);
+    lane_f64 p = lane_f64_set1(4.1103176233121648e-19);
+    p = lane_f64_horner_step(p, r2, -1.5619206968586225e-16);
+    p = lane_f64_horner_step(p, r2, 4.7794773323873853e-14);
+    p = lane_f64_horner_step(p, r2, -1.1470745597729725e-11);
+    p = lane_f64_horner_step(p, r2, 2.08767569878681e-09);
+    p = lane_f64_horner_step(p, r2, -2.7557319223985888e-07);
+    p = lane_f64_horner_step(p, r2, 2.4801587301587302e-05);
+    p = lane_f64_horner_step(p, r2, -0.0013888888888888889);
+    p = lane_f64_horner_step(p, r2, 0.041666666666666664);
+    p = lane_f64_horner_step(p, r2, -0.5);
+    return lane_f64_fmadd(r2, p, lane_f64_set1(1.0));
+}
+
+internal inline lane_f64
+lane_f64_sin(lane_f64 x) {
+    lane_f64 sign;
+    lane_f64 r = lane_f64_reduce_pi(x, &sign);
+    return lane_f64_xor(lane_f64_sin_reduced(r), sign);
+}
+
+internal inline lane_f64
+lane_f64_cos(lane_f64 x) {
+    lane_f64 sign;
+    lane_f64 r = lane_f64_reduce_pi(x, &sign);
+    return lane_f64_xor(lane_f64_cos_reduced(r), sign);
+}
+
+/* NOTE(abid): asin(z) for z in [0, 0.5], t = z*z. */
+internal inline lane_f64
+lane_f64_asin_poly(lane_f64 z, lane_f64 t) {
+    lane_f64 p = lane_f64_set1(0.032751725115792121);
+    p = lane_f64_horner_step(p, t, -0.017273677012506521);
+    p = lane_f64_horner_step(p, t, 0.020057976808862871);
+    p = lane_f64_horner_step(p, t, 0.0063976737999489382);
+    p = lane_f64_horner_step(p, t, 0.012181181682239023);
+    p = lane_f64_horner_step(p, t, 0.013886818137001081);
+    p = lane_f64_horner_step(p, t, 0.017359126975718588);
+    p = lane_f64_horner_step(p, t, 0.022371828834373168);
+    p = lane_f64_horner_step(p, t, 0.030381954691127529);
+    p = lane_f64_horner_step(p, t, 0.044642856971481015);
+    p = lane_f64_horner_step(p, t, 0.075000000001332168);
+    p = lane_f64_horner_step(p, t, 0.1666666666666608);
+    return lane_f64_fmadd(lane_f64_mul(z, t), p, z);
+}
+
+/* NOTE(abid): Domain [-1, 1], caller is responsible for clamping. */
+internal inline lane_f64
+lane_f64_asin(lane_f64 x) {
+    lane_f64 sign_bit = lane_f64_set1(-0.0);
+    lane_f64 ax = lane_f64_andnot(sign_bit, x);
+    lane_f64 is_big = lane_f64_gt(ax, lane_f64_set1(0.5));
+
+    /* NOTE(abid): asin(x) = pi/2 - 2*asin(sqrt((1 - x)/2)) for x > 0.5. */
+    lane_f64 t_big = lane_f64_mul(lane_f64_sub(lane_f64_set1(1.0), ax), lane_f64_set1(0.5));
+    lane_f64 z = lane_f64_select(is_big, lane_f64_sqrt(t_big), ax);
+    lane_f64 t = lane_f64_select(is_big, t_big, lane_f64_mul(ax, ax));
+    lane_f64 asin_z = lane_f64_asin_poly(z, t);
+
+    lane_f64 big_result = lane_f64_fmadd(asin_z, lane_f64_set1(-2.0), lane_f64_set1(F64_HALF_PI));
+    lane_f64 result = lane_f64_select(is_big, big_result, asin_z);
+    return lane_f64_or(result, lane_f64_and(x, sign_bit));
+}
+
+/* NOTE(abid): Domain [-1, 1]. Near +-1 it goes through the half-angle identity directly instead of
+ * pi/2 - asin(x), which would cancel. */
+internal inline lane_f64
+lane_f64_acos(lane_f64 x) {
+    lane_f64 sign_bit = lane_f64_set1(-0.0);
+    lane_f64 ax = lane_f64_andnot(sign_bit, x);
+    lane_f64 is_big = lane_f64_gt(ax, lane_f64_set1(0.5));
+    lane_f64 is_negative = lane_f64_lt(x, lane_f64_zero());
+
+    lane_f64 t_big = lane_f64_mul(lane_f64_sub(lane_f64_set1(1.0), ax), lane_f64_set1(0.5));
+    lane_f64 z = lane_f64_select(is_big, lane_f64_sqrt(t_big), ax);
+    lane_f64 t = lane_f64_select(is_big, t_big, lane_f64_mul(ax, ax));
+    lane_f64 asin_z = lane_f64_asin_poly(z, t);
+
+    /* NOTE(abid): |x| <= 0.5: pi/2 - asin(x), x > 0.5: 2*asin(z), x < -0.5: pi - 2*asin(z). */
+    lane_f64 small_result = lane_f64_sub(lane_f64_set1(F64_HALF_PI), lane_f64_or(asin_z, lane_f64_and(x, sign_bit)));
+    lane_f64 twice = lane_f64_add(asin_z, asin_z);
+    lane_f64 big_result = lane_f64_select(is_negative, lane_f64_sub(lane_f64_set1(2.0*F64_HALF_PI), twice), twice);
+    return lane_f64_select(is_big, big_result, small_result);
+}
+
+/* NOTE(abid): Full quadrant atan2. The ratio is folded into [0, 1], above tan(pi/8) it is shifted
+ * with atan(t) = pi/4 + atan((t - 1)/(t + 1)), and the polynomial is a Chebyshev fit of
+ * atan(sqrt(u))/sqrt(u) on [0, tan(pi/8)^2]. */
+internal inline lane_f64
+lane_f64_atan2(lane_f64 y, lane_f64 x) {
+    lane_f64 sign_bit = lane_f64_set1(-0.0);
+    lane_f64 ay = lane_f64_andnot(sign_bit, y);
+    lane_f64 ax = lane_f64_andnot(sign_bit, x);
+    lane_f64 is_swapped = lane_f64_gt(ay, ax);
+    lane_f64 numerator = lane_f64_min(ay, ax);
+    lane_f64 denominator = lane_f64_max(lane_f64_max(ay, ax), lane_f64_set1(1e-300));
+    lane_f64 ratio = lane_f64_div(numerator, denominator);
+
+    lane_f64 is_shifted = lane_f64_gt(ratio, lane_f64_set1(0.41421356237309503));
+    lane_f64 one = lane_f64_set1(1.0);
+    lane_f64 shifted = lane_f64_div(lane_f64_sub(ratio, one), lane_f64_add(ratio, one));
+    lane_f64 z = lane_f64_select(is_shifted, shifted, ratio);
+    lane_f64 u = lane_f64_mul(z, z);
+
+    lane_f64 p = lane_f64_set1(0.020459270345906826);
+    p = lane_f64_horner_step(p, u, -0.042909206877067306);
+    p = lane_f64_horner_step(p, u, 0.056678486430389766);
+    p = lane_f64_horner_step(p, u, -0.066361619260428967);
+    p = lane_f64_horner_step(p, u, 0.07689463933259863);
+    p = lane_f64_horner_step(p, u, -0.090907364381297762);
+    p = lane_f64_horner_step(p, u, 0.1111110448811288);
+    p = lane_f64_horner_step(p, u, -0.14285714134866895);
+    p = lane_f64_horner_step(p, u, 0.1999999999819409);
+    p = lane_f64_horner_step(p, u, -0.33333333333324733);
+    p = lane_f64_horner_step(p, u, 0.99999999999999989);
+    lane_f64 result = lane_f64_mul(z, p);
+    result = lane_f64_add(result, lane_f64_and(is_shifted, lane_f64_set1(0.5*F64_HALF_PI)));
+
+    result = lane_f64_select(is_swapped, lane_f64_sub(lane_f64_set1(F64_HALF_PI), result), result);
+    result = lane_f64_select(lane_f64_lt(x, lane_f64_zero()),
+                             lane_f64_sub(lane_f64_set1(2.0*F64_HALF_PI), result), result);
+    return lane_f64_or(result, lane_f64_and(y, sign_bit));
+}
+
+/* NOTE(abid): Natural log for positive, finite, normal x. x = 2^e*m with m in [sqrt(1/2), sqrt(2)),
+ * log(m) = f - f^2/2 + s*(f^2/2 + R(s^2)) where f = m - 1, s = f/(2 + f) (fdlibm's reduction and
+ * coefficients), e*ln2 is added in two parts. The exponent is turned into a double by OR-ing it
+ * into the mantissa of 2^52, so no 64-bit integer conversion is needed. */
+internal inline lane_f64
+lane_f64_log(lane_f64 x) {
+    lane_f64 one = lane_f64_set1(1.0);
+    lane_f64 mantissa_mask = lane_f64_from_bits(lane_u64_set1(0x000FFFFFFFFFFFFFULL));
+    lane_f64 m = lane_f64_or(lane_f64_and(x, mantissa_mask), one);
+    lane_f64 exponent_bits = lane_u64_as_f64(lane_u64_or(lane_u64_shr(lane_f64_as_bits(x), 52),
+                                                         lane_u64_set1(0x4330000000000000ULL)));
+    lane_f64 e = lane_f64_sub(exponent_bits, lane_f64_set1(4503599627370496.0 + 1023.0));
+
+    lane_f64 is_big = lane_f64_gt(m, lane_f64_set1(1.4142135623730951));
+    m = lane_f64_select(is_big, lane_f64_mul(m, lane_f64_set1(0.5)), m);
+    e = lane_f64_add(e, lane_f64_and(is_big, one));
+
+    lane_f64 f = lane_f64_sub(m, one);
+    lane_f64 s = lane_f64_div(f, lane_f64_add(f, lane_f64_set1(2.0)));
+    lane_f64 z = lane_f64_mul(s, s);
+    lane_f64 r = lane_f64_set1(1.479819860511658591e-01);
+    r = lane_f64_horner_step(r, z, 1.531383769920937332e-01);
+    r = lane_f64_horner_step(r, z, 1.818357216161805012e-01);
+    r = lane_f64_horner_step(r, z, 2.222219843214978396e-01);
+    r = lane_f64_horner_step(r, z, 2.857142874366239149e-01);
+    r = lane_f64_horner_step(r, z, 3.999999999940941908e-01);
+    r = lane_f64_horner_step(r, z, 6.666666666666735130e-01);
+    r = lane_f64_mul(r, z);
+
+    lane_f64 half_f_squared = lane_f64_mul(lane_f64_set1(0.5), lane_f64_mul(f, f));
+    lane_f64 result = lane_f64_mul(s, lane_f64_add(half_f_squared, r));
+    result = lane_f64_fmadd(e, lane_f64_set1(1.90821492927058770002e-10), result);
+    result = lane_f64_add(lane_f64_sub(f, half_f_squared), result);
+    return lane_f64_fmadd(e, lane_f64_set1(6.93147180369123816490e-01), result);
+}
+
+/* NOTE(abid): f32 versions, same reductions with shorter polynomials. */
+internal inline lane_f32
+lane_f32_reduce_pi(lane_f32 x, lane_f32 *sign_out) {
+    lane_f32 magic = lane_f32_set1(F32_ROUND_MAGIC);
+    lane_f32 k_biased = lane_f32_fmadd(x, lane_f32_set1(F32_INV_PI), magic);
+    lane_f32 k = lane_f32_sub(k_biased, magic);
+
+    lane_f32 r = lane_f32_fmadd(k, lane_f32_set1(-F32_PI_A), x);
+    r = lane_f32_fmadd(k, lane_f32_set1(-F32_PI_B), r);
+    r = lane_f32_fmadd(k, lane_f32_set1(-F32_PI_C), r);
+
+    *sign_out = lane_f32_from_bits(lane_bits_shl32(lane_f32_as_bits(k_biased), 31));
+    return r;
+}
+
+internal inline lane_f32
+lane_f32_sin_reduced(lane_f32 r) {
+    lane_f32 r2 = lane_f32_mul(r, r);
+    lane_f32 p = lane_f32_set1(1.6059043836821613e-10f);
+    p = lane_f32_horner_step(p, r2, -2.505210838544172e-08f);
+    p = lane_f32_horner_step(p, r2, 2.7557319223985893e-06f);
+    p = lane_f32_horner_step(p, r2, -0.00019841269841269841f);
+    p = lane_f32_horner_step(p, r2, 0.0083333333333333332f);
+    p = lane_f32_horner_step(p, r2, -0.16666666666666666f);
+    return lane_f32_fmadd(lane_f32_mul(r, r2), p, r);
+}
+
+internal inline lane_f32
+lane_f32_cos_reduced(lane_f32 r) {
+    lane_f32 r2 = lane_f32_mul(r, r);
+    lane_f32 p = lane_f32_set1(2.08767569878681e-09f);
+    p = lane_f32_horner_step(p, r2, -2.7557319223985888e-07f);
+    p = lane_f32_horner_step(p, r2, 2.4801587301587302e-05f);
+    p = lane_f32_horner_step(p, r2, -0.0013888888888888889f);
+    p = lane_f32_horner_step(p, r2, 0.041666666666666664f);
+    p = lane_f32_horner_step(p, r2, -0.5f);
+    return lane_f32_fmadd(r2, p, lane_f32_set1(1.0f));
+}
+
+internal inline lane_f32
+lane_f32_sin(lane_f32 x) {
+    lane_f32 sign;
+    lane_f32 r = lane_f32_reduce_pi(x, &sign);
+    return lane_f32_xor(lane_f32_sin_reduced(r), sign);
+}
+
+internal inline lane_f32
+lane_f32_cos(lane_f32 x) {
+    lane_f32 sign;
+    lane_f32 r = lane_f32_reduce_pi(x, &sign);
+    return lane_f32_xor(lane_f32_cos_reduced(r), sign);
+}
+
+internal inline lane_f32
+lane_f32_asin(lane_f32 x) {
+    lane_f32 sign_bit = lane_f32_set1(-0.0f);
+    lane_f32 ax = lane_f32_andnot(sign_bit, x);
+    lane_f32 is_big = lane_f32_gt(ax, lane_f32_set1(0.5f));
+
+    lane_f32 t_big = lane_f32_mul(lane_f32_sub(lane_f32_set1(1.0f), ax), lane_f32_set1(0.5f));
+    lane_f32 z = lane_f32_select(is_big, lane_f32_sqrt(t_big), ax);
+    lane_f32 t = lane_f32_select(is_big, t_big, lane_f32_mul(ax, ax));
+
+    lane_f32 p = lane_f32_set1(0.050357681932879574f);
+    p = lane_f32_horner_step(p, t, 0.039794443254411116f);
+    p = lane_f32_horner_step(p, t, 0.075453455798853403f);
+    p = lane_f32_horner_step(p, t, 0.16665219586442528f);
+    lane_f32 asin_z = lane_f32_fmadd(lane_f32_mul(z, t), p, lane_f32_mul(z, lane_f32_set1(1.0000000726414175f)));
+
+    lane_f32 big_result = lane_f32_fmadd(asin_z, lane_f32_set1(-2.0f), lane_f32_set1(F32_HALF_PI));
+    lane_f32 result = lane_f32_select(is_big, big_result, asin_z);
+    return lane_f32_or(result, lane_f32_and(x, sign_bit));
+}
@@ -6,6 +6,7 @@
     |                                                                                  |
     +======================================| Copyright © Sayed Abid Hashimi |==========+  */
 
+#include "simd.h"
 #include "stat.h"
 
 internal inline void
@@ -14,14 +15,149 @@ stat_f64_accumulate(f64 Value, stat_f64 *Stat) {
         Stat->Max = Value;
         Stat->Min = Value;
     }
+    if(Value > Stat->Max) Stat->Max = Value;
+    if(Value < Stat->Min) Stat->Min = Value;
 
+    ++Stat->Count;
+    f64 Delta = Value - Stat->Mean;
+    Stat->Mean += Delta/(f64)Stat->Count;
+    Stat->M2 += Delta*(Value - Stat->Mean);
     Stat->Latest = Value;
-    Stat->SumSquared += Value*Value;
     Stat->Sum += Value;
-    ++Stat->Count;
 }
+
 internal inline f64
 stat_f64_mean(stat_f64 *Stat) {
     assert(Stat->Count > 0, "cannot calculate mean for count < 1");
-    return Stat->Sum / Stat->Count;
+    return Stat->Mean;
+}
+
+/* NOTE(abid): Sample variance, 0 below two values. */
+internal inline f64
+stat_f64_variance(stat_f64 *Stat) {
+    return Stat->Count > 1 ? Stat->M2/(f64)(Stat->Count - 1) : 0.0;
+}
+
+internal inline f64
+stat_f64_stddev(stat_f64 *Stat) {
+    return sqrt(stat_f64_variance(Stat));
+}
+
+/* NOTE(abid): Folds `From` into `Into` as if its values had been accumulated after `Into`'s. */
+internal inline void
+stat_f64_merge(stat_f64 *Into, stat_f64 *From) {
+    if(From->Count == 0) return;
+    if(Into->Count == 0) {
+        *Into = *From;
+        return;
+    }
+
+    if(From->Max > Into->Max) Into->Max = From->Max;
+    if(From->Min < Into->Min) Into->Min = From->Min;
+    u64 Count = Into->Count + From->Count;
+    f64 Delta = From->Mean - Into->Mean;
+    Into->Mean += Delta*(f64)From->Count/(f64)Count;
+    Into->M2 += From->M2 + Delta*Delta*(f64)Into->Count*(f64)From->Count/(f64)Count;
+    Into->Latest = From->Latest;
+    Into->Sum += From->Sum;
+    Into->Count = Count;
+}
+
+/* NOTE(abid): Same result as accumulating `Values` one by one, but in lanes: the block's sum,
+ * min and max in one pass, its M2 around the block mean in a second (the block is still in
+ * cache), then one merge. */
+internal void
+stat_f64_accumulate_bulk(f64 *Values, u64 Count, stat_f64 *Stat) {
+    if(Count == 0) return;
+
+    u64 LaneCount = Count - Count%LANE_F64_WIDTH;
+    lane_f64 Sum = lane_f64_zero();
+    lane_f64 Min = lane_f64_set1(Values[0]);
+    lane_f64 Max = Min;
+    for(u64 Idx = 0; Idx < LaneCount; Idx += LANE_F64_WIDTH) {
+        lane_f64 Value = lane_f64_load(Values + Idx);
+        Sum = lane_f64_add(Sum, Value);
+        Min = lane_f64_min(Min, Value);
+        Max = lane_f64_max(Max, Value);
+    }
+
+    stat_f64 Block = { .Count = Count, .Latest = Values[Count - 1], .Sum = lane_f64_hsum(Sum) };
+    f64 MinLanes[LANE_F64_WIDTH], MaxLanes[LANE_F64_WIDTH];
+    lane_f64_store(MinLanes, Min);
+    lane_f64_store(MaxLanes, Max);
+    Block.Min = MinLanes[0];
+    Block.Max = MaxLanes[0];
+    for(u32 Lane = 1; Lane < LANE_F64_WIDTH; ++Lane) {
+        if(MinLanes[Lane] < Block.Min) Block.Min = MinLanes[Lane];
+        if(MaxLanes[Lane] > Block.Max) Block.Max = MaxLanes[Lane];
+    }
+    for(u64 Idx = LaneCount; Idx < Count; ++Idx) {
+        Block.Sum += Values[Idx];
+        if(Values[Idx] < Block.Min) Block.Min = Values[Idx];
+        if(Values[Idx] > Block.Max) Block.Max = Values[Idx];
+    }
+    Block.Mean = Block.Sum/(f64)Count;
+
+    lane_f64 Mean = lane_f64_set1(Block.Mean);
+    lane_f64 M2 = lane_f64_zero();
+    for(u64 Idx = 0; Idx < LaneCount; Idx += LANE_F64_WIDTH) {
+        lane_f64 Delta = lane_f64_sub(lane_f64_load(Values + Idx), Mean);
+        M2 = lane_f64_add(M2, lane_f64_mul(Delta, Delta));
+    }
+    Block.M2 = lane_f64_hsum(M2);
+    for(u64 Idx = LaneCount; Idx < Count; ++Idx) Block.M2 += (Values[Idx] - Block.Mean)*(Values[Idx] - Block.Mean);
+
+    stat_f64_merge(Stat, &Block);
+}
+
+internal inline void
+stat_histogram_reset(stat_histogram *Histogram) {
+    memset(Histogram, 0, sizeof(*Histogram));
+}
+
+internal inline u32
+stat_histogram_bucket(u64 Value) {
+    if(Value < STAT_HISTOGRAM_SUB_COUNT) return (u32)Value;
+    u32 Shift = 63 - u64_leading_zeros(Value) - STAT_HISTOGRAM_SUB_BITS;
+    return (Shift + 1)*STAT_HISTOGRAM_SUB_COUNT + (u32)(Value >> Shift) - STAT_HISTOGRAM_SUB_COUNT;
+}
+
+/* NOTE(abid): Smallest value that lands in `Bucket`. */
+internal inline u64
+stat_histogram_bucket_low(u32 Bucket) {
+    if(Bucket < STAT_HISTOGRAM_SUB_COUNT) return Bucket;
+    u32 Shift = Bucket/STAT_HISTOGRAM_SUB_COUNT - 1;
+    return (u64)(Bucket%STAT_HISTOGRAM_SUB_COUNT + STAT_HISTOGRAM_SUB_COUNT) << Shift;
+}
+
+internal inline void
+stat_histogram_add(stat_histogram *Histogram, u64 Value) {
+    if(Histogram->count == 0 || Value < Histogram->min) Histogram->min = Value;
+    if(Value > Histogram->max) Histogram->max = Value;
+    ++Histogram->buckets[stat_histogram_bucket(Value)];
+    ++Histogram->count;
+}
+
+/* NOTE(abid): Value below which `Percentile`% of the values are, as the middle of its bucket
+ * clamped to the recorded min and max (exact for p0 and p100). */
+internal u64
+stat_histogram_percentile(stat_histogram *Histogram, f64 Percentile) {
+    if(Histogram->count == 0) return 0;
+    u64 Rank = (u64)ceil(Percentile/100.0*(f64)Histogram->count);
+    if(Rank == 0) Rank = 1;
+    if(Rank >= Histogram->count) return Histogram->max;
+
+    u64 Seen = 0;
+    u32 Bucket = 0;
+    for(; Bucket < STAT_HISTOGRAM_BUCKETS - 1; ++Bucket) {
+        Seen += Histogram->buckets[Bucket];
+        if(Seen >= Rank) break;
+    }
+    u64 Low = stat_histogram_bucket_low(Bucket);
+    u64 High = (Bucket + 1 < STAT_HISTOGRAM_BUCKETS) ? stat_histogram_bucket_low(Bucket + 1) - 1 : ~0ULL;
+    u64 Result = Low + (High - Low)/2;
+    if(Result < Histogram->min) Result = Histogram->min;
+    if(Result > Histogram->max) Result = Histogram->max;
+
+    return Result;
 }
@@ -8,14 +8,34 @@
 
 #if !defined(STAT_H)
 
+/* NOTE(abid): Streaming moments. `M2` is the sum of squared distances from the running mean
+ * (Welford), so the variance does not cancel catastrophically the way sum of squares does for
+ * large counts. Two partials merge exactly (Chan et al.), which is how per-chunk and per-thread
+ * stats are combined. */
 typedef struct {
     f64 Latest;
     f64 Sum;
-    f64 SumSquared;
+    f64 Mean;
+    f64 M2;
     u64 Count;
     f64 Max;
     f64 Min;
 } stat_f64;
 
+/* NOTE(abid): HDR style histogram of u64 values (cycle counts). Values below
+ * 2^STAT_HISTOGRAM_SUB_BITS have their own bucket, above that every power of two is split into
+ * 2^STAT_HISTOGRAM_SUB_BITS buckets, so a percentile is off by at most 1/2^SUB_BITS of its value
+ * (0.8% at 7 bits) over the whole u64 range. */
+#define STAT_HISTOGRAM_SUB_BITS 7
+#define STAT_HISTOGRAM_SUB_COUNT (1 << STAT_HISTOGRAM_SUB_BITS)
+#define STAT_HISTOGRAM_BUCKETS ((64 - STAT_HISTOGRAM_SUB_BITS + 1)*STAT_HISTOGRAM_SUB_COUNT)
+
+typedef struct {
+    u64 count;
+    u64 min;
+    u64 max;
+    u64 buckets[STAT_HISTOGRAM_BUCKETS];
+} stat_histogram;
+
 #define STAT_H
 #endif
@@ -21,6 +21,7 @@ typedef int8_t bool;
 typedef uint8_t u8;
 typedef int8_t i8;
 typedef int16_t i16;
+typedef struct { u64 lo; u64 hi; } u128;
 #define internal static
 #define local_persist static
 #define global_var static
@@ -28,5 +29,19 @@ typedef int16_t i16;
 #define false 0
 #define array_size(Arr) sizeof((Arr)) / sizeof((Arr)[0])
 
+/* NOTE(abid): Code between the two is compiled as written, `a*b + c` is never fused into an FMA
+ * (GCC fuses across statements once FMA is enabled). For results that must not depend on the ISA
+ * the build targets, explicit fmadd intrinsics are not affected. */
+#if defined(__clang__)
+#define FP_CONTRACT_OFF_BEGIN _Pragma("clang fp contract(off)")
+#define FP_CONTRACT_OFF_END _Pragma("clang fp contract(on)")
+#elif defined(__GNUC__)
+#define FP_CONTRACT_OFF_BEGIN _Pragma("GCC push_options") _Pragma("GCC optimize(\"fp-contract=off\")")
+#define FP_CONTRACT_OFF_END _Pragma("GCC pop_options")
+#elif defined(_MSC_VER)
+#define FP_CONTRACT_OFF_BEGIN __pragma(fp_contract(off))
+#define FP_CONTRACT_OFF_END
+#endif
+
 #define TYPES_H
 #endif
@@ -10,12 +10,18 @@
 
 #ifdef PLT_WIN
 #include <windows.h>
+#include <intrin.h>
 #include <sys/types.h>
 #include <sys/stat.h>
 #elif PLT_LINUX
 #include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
 #include <unistd.h>
 #include <string.h>
+#include <pthread.h>
+#include <sched.h>
+#include <semaphore.h>
 #endif
 
 /* NOTE(abid): Byte Macros */
@@ -49,7 +55,7 @@ square(f64 a) {
 
 inline internal f64 
 radians_from_degrees(f64 degrees) {
-    f64 result = 0.01745329251994329577f * degrees;
+    f64 result = 0.01745329251994329577 * degrees;
     return result;
 }
 
@@ -60,7 +66,6 @@ platform_file_64bit_get_size(char *filename) {
     _stat64(filename, &file_stat);
 
 #elif PLT_LINUX
-    assert(0, "NotImplemented.");
     struct stat file_stat;
     stat(filename, &file_stat);
 #endif
@@ -87,7 +92,7 @@ platform_ram_get_size() {
     return mem_stat.ullTotalPhys;
 #elif PLT_LINUX
     long pages = sysconf(_SC_PHYS_PAGES);
-    return pages * platform_get_page_size();
+    return pages * platform_page_get_size();
 #endif
 }
 
@@ -166,6 +171,526 @@ platform_free(void *ptr, usize size) {
     return result;
 }
 
+/* NOTE(abid): Read-only mapping of a whole file, NULL if it cannot be opened or is empty. */
+internal void *
+platform_file_map(char *filename, usize *size_out) {
+    void *result = NULL;
+    *size_out = 0;
+#ifdef PLT_WIN
+    HANDLE file = CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL, NULL);
+    if(file == INVALID_HANDLE_VALUE) return NULL;
+    LARGE_INTEGER file_size;
+    GetFileSizeEx(file, &file_size);
+    HANDLE mapping = file_size.QuadPart ? CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL) : NULL;
+    CloseHandle(file);
+    if(mapping == NULL) return NULL;
+
+    result = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    CloseHandle(mapping);
+    if(result) *size_out = file_size.QuadPart;
+#elif PLT_LINUX
+    i32 file = open(filename, O_RDONLY);
+    if(file < 0) return NULL;
+    struct stat file_stat;
+    if(fstat(file, &file_stat) == 0 && file_stat.st_size > 0) {
+        result = mmap(NULL, file_stat.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+        if(result == MAP_FAILED) result = NULL;
+        else *size_out = file_stat.st_size;
+    }
+    close(file);
+#endif
+
+    return result;
+}
+
+inline internal void
+platform_file_unmap(void *ptr, usize size) {
+#ifdef PLT_WIN
+    UnmapViewOfFile(ptr);
+#elif PLT_LINUX
+    munmap(ptr, size);
+#endif
+}
+
+/* NOTE(abid): `filename` should be without extension, the result is malloc'd. */
+internal char *
+filename_with_extension(char *filename, char *extension) {
+    usize filename_len = strlen(filename);
+    usize extension_len = strlen(extension);
+    char *result = malloc(filename_len + extension_len + 1);
+    memcpy(result, filename, filename_len);
+    memcpy(result + filename_len, extension, extension_len + 1);
+
+    return result;
+}
+
+/* NOTE(abid): Output files. `unbuffered` bypasses the page cache (O_DIRECT / NO_BUFFERING), which
+ * requires sector aligned buffers, sizes and offsets. Not every file system supports it (tmpfs
+ * does not), in that case the file is opened buffered and `unbuffered_out` is false. The file is
+ * created or truncated, and opened read/write so it can also be mapped. */
+#ifdef PLT_WIN
+typedef HANDLE platform_file;
+#define PLATFORM_FILE_INVALID INVALID_HANDLE_VALUE
+#elif PLT_LINUX
+typedef i32 platform_file;
+#define PLATFORM_FILE_INVALID -1
+#endif
+
+internal platform_file
+platform_file_open_write(char *filename, bool unbuffered, bool *unbuffered_out) {
+    platform_file result = PLATFORM_FILE_INVALID;
+#ifdef PLT_WIN
+    DWORD access = GENERIC_READ | GENERIC_WRITE;
+    if(unbuffered) {
+        result = CreateFileA(filename, access, 0, NULL, CREATE_ALWAYS,
+                             FILE_ATTRIBUTE_NORMAL | FILE_FLAG_NO_BUFFERING | FILE_FLAG_WRITE_THROUGH, NULL);
+    }
+    if(result == PLATFORM_FILE_INVALID) {
+        unbuffered = false;
+        result = CreateFileA(filename, access, 0, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+    }
+#elif PLT_LINUX
+    if(unbuffered) result = open(filename, O_RDWR | O_CREAT | O_TRUNC | O_DIRECT, 0644);
+    if(result == PLATFORM_FILE_INVALID) {
+        unbuffered = false;
+        result = open(filename, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    }
+#endif
+    if(unbuffered_out) *unbuffered_out = unbuffered;
+
+    return result;
+}
+
+internal bool
+platform_file_write_at(platform_file file, void *data, usize size, u64 offset) {
+#ifdef PLT_WIN
+    u8 *src = (u8 *)data;
+    while(size) {
+        DWORD chunk = (size > gigabyte(1)) ? (DWORD)gigabyte(1) : (DWORD)size;
+        OVERLAPPED overlapped = { .Offset = (DWORD)offset, .OffsetHigh = (DWORD)(offset >> 32) };
+        DWORD written = 0;
+        if(!WriteFile(file, src, chunk, &written, &overlapped) || written == 0) return false;
+        src += written;
+        size -= written;
+        offset += written;
+    }
+#elif PLT_LINUX
+    u8 *src = (u8 *)data;
+    while(size) {
+        ssize_t written = pwrite(file, src, size, offset);
+        if(written <= 0) return false;
+        src += written;
+        size -= written;
+        offset += written;
+    }
+#endif
+
+    return true;
+}
+
+internal bool
+platform_file_set_size(platform_file file, u64 size) {
+#ifdef PLT_WIN
+    FILE_END_OF_FILE_INFO end_of_file = { .EndOfFile.QuadPart = (LONGLONG)size };
+    return SetFileInformationByHandle(file, FileEndOfFileInfo, &end_of_file, sizeof(end_of_file)) != 0;
+#elif PLT_LINUX
+    return ftruncate(file, size) == 0;
+#endif
+}
+
+/* NOTE(abid): Writable mapping of [offset, offset + size), the file has to be at least that large
+ * and `offset` a multiple of the allocation granularity (64KB on Win32). Unmap with
+ * `platform_file_unmap`. */
+internal void *
+platform_file_map_range(platform_file file, u64 offset, usize size) {
+    void *result = NULL;
+#ifdef PLT_WIN
+    u64 end = offset + size;
+    HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READWRITE, (DWORD)(end >> 32), (DWORD)end, NULL);
+    if(mapping == NULL) return NULL;
+    result = MapViewOfFile(mapping, FILE_MAP_WRITE, (DWORD)(offset >> 32), (DWORD)offset, size);
+    CloseHandle(mapping);
+#elif PLT_LINUX
+    result = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, file, offset);
+    if(result == MAP_FAILED) result = NULL;
+#endif
+
+    return result;
+}
+
+inline internal void
+platform_file_close(platform_file file) {
+#ifdef PLT_WIN
+    CloseHandle(file);
+#elif PLT_LINUX
+    close(file);
+#endif
+}
+
+/* NOTE(abid): Input files, `unbuffered` as for `platform_file_open_write` except that there is
+ * no fallback, PLATFORM_FILE_INVALID when the file cannot be opened that way. */
+internal platform_file
+platform_file_open_read(char *filename, bool unbuffered) {
+    platform_file result = PLATFORM_FILE_INVALID;
+#ifdef PLT_WIN
+    DWORD flags = FILE_ATTRIBUTE_NORMAL | (unbuffered ? FILE_FLAG_NO_BUFFERING : FILE_FLAG_SEQUENTIAL_SCAN);
+    result = CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, flags, NULL);
+#elif PLT_LINUX
+    result = open(filename, O_RDONLY | (unbuffered ? O_DIRECT : 0));
+#endif
+
+    return result;
+}
+
+/* NOTE(abid): Reads until `size` bytes or the end of the file, returns how many were read. */
+internal usize
+platform_file_read_at(platform_file file, void *data, usize size, u64 offset) {
+    u8 *dest = (u8 *)data;
+    usize total = 0;
+#ifdef PLT_WIN
+    while(total < size) {
+        usize left = size - total;
+        DWORD chunk = (left > gigabyte(1)) ? (DWORD)gigabyte(1) : (DWORD)left;
+        OVERLAPPED overlapped = { .Offset = (DWORD)offset, .OffsetHigh = (DWORD)(offset >> 32) };
+        DWORD read = 0;
+        if(!ReadFile(file, dest + total, chunk, &read, &overlapped) || read == 0) break;
+        total += read;
+        offset += read;
+    }
+#elif PLT_LINUX
+    while(total < size) {
+        ssize_t read = pread(file, dest + total, size - total, offset);
+        if(read <= 0) break;
+        total += read;
+        offset += read;
+    }
+#endif
+
+    return total;
+}
+
+/* NOTE(abid): Read-only mapping of the first `size` bytes of an open file, `populate` faults
+ * the pages in (MAP_POPULATE / PrefetchVirtualMemory) before returning. */
+internal void *
+platform_file_map_read(platform_file file, usize size, bool populate) {
+    void *result = NULL;
+#ifdef PLT_WIN
+    HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    if(mapping == NULL) return NULL;
+    result = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, size);
+    CloseHandle(mapping);
+    if(result && populate) {
+        WIN32_MEMORY_RANGE_ENTRY range = { .VirtualAddress = result, .NumberOfBytes = size };
+        PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+    }
+#elif PLT_LINUX
+    result = mmap(NULL, size, PROT_READ, MAP_PRIVATE | (populate ? MAP_POPULATE : 0), file, 0);
+    if(result == MAP_FAILED) result = NULL;
+#endif
+
+    return result;
+}
+
+/* NOTE(abid): Evicts the file from the page cache (written back first, only clean pages can
+ * go), false where there is no way to do that for a single file (Win32). */
+internal bool
+platform_file_drop_cache(char *filename) {
+#ifdef PLT_WIN
+    (void)filename;
+    return false;
+#elif PLT_LINUX
+    i32 file = open(filename, O_RDONLY);
+    if(file < 0) return false;
+    fdatasync(file);
+    bool result = posix_fadvise(file, 0, 0, POSIX_FADV_DONTNEED) == 0;
+    close(file);
+
+    return result;
+#endif
+}
+
+/* NOTE(abid): Share of the file's pages in the page cache (mincore), -1 when unknown. */
+internal f64
+platform_file_cached_fraction(char *filename) {
+    f64 result = -1.0;
+#ifdef PLT_LINUX
+    i32 file = open(filename, O_RDONLY);
+    if(file < 0) return result;
+    struct stat file_stat;
+    if(fstat(file, &file_stat) == 0 && file_stat.st_size > 0) {
+        usize page_size = platform_page_get_size();
+        usize page_count = (file_stat.st_size + page_size - 1)/page_size;
+        void *mapped = mmap(NULL, file_stat.st_size, PROT_NONE, MAP_SHARED, file, 0);
+        u8 *resident = malloc(page_count);
+        if(mapped != MAP_FAILED && mincore(mapped, file_stat.st_size, resident) == 0) {
+            usize resident_count = 0;
+            for(usize page = 0; page < page_count; ++page) resident_count += resident[page] & 1;
+            result = (f64)resident_count/(f64)page_count;
+        }
+        if(mapped != MAP_FAILED) munmap(mapped, file_stat.st_size);
+        free(resident);
+    }
+    close(file);
+#else
+    (void)filename;
+#endif
+
+    return result;
+}
+
+/* NOTE(abid): Counting semaphore. */
+#ifdef PLT_WIN
+typedef HANDLE platform_semaphore;
+#elif PLT_LINUX
+typedef sem_t platform_semaphore;
+#endif
+
+internal void
+platform_semaphore_init(platform_semaphore *semaphore, u32 initial_count) {
+#ifdef PLT_WIN
+    *semaphore = CreateSemaphoreA(NULL, initial_count, 0x7FFFFFFF, NULL);
+    assert(*semaphore != NULL, "could not create semaphore.");
+#elif PLT_LINUX
+    i32 error = sem_init(semaphore, 0, initial_count);
+    assert(error == 0, "could not create semaphore.");
+#endif
+}
+
+inline internal void
+platform_semaphore_wait(platform_semaphore *semaphore) {
+#ifdef PLT_WIN
+    WaitForSingleObject(*semaphore, INFINITE);
+#elif PLT_LINUX
+    while(sem_wait(semaphore) != 0) {}
+#endif
+}
+
+inline internal void
+platform_semaphore_signal(platform_semaphore *semaphore) {
+#ifdef PLT_WIN
+    ReleaseSemaphore(*semaphore, 1, NULL);
+#elif PLT_LINUX
+    sem_post(semaphore);
+#endif
+}
+
+inline internal void
+platform_semaphore_destroy(platform_semaphore *semaphore) {
+#ifdef PLT_WIN
+    CloseHandle(*semaphore);
+#elif PLT_LINUX
+    sem_destroy(semaphore);
+#endif
+}
+
+/* NOTE(abid): Thread routines. Thread procs are declared with `THREAD_PROC(name)` and end with
+ * `return 0;`, which is valid for both the Win32 and the pthread signature. */
+#ifdef PLT_WIN
+typedef HANDLE platform_thread;
+typedef LPTHREAD_START_ROUTINE platform_thread_proc;
+#define THREAD_PROC(name) DWORD WINAPI name(LPVOID param)
+#elif PLT_LINUX
+typedef pthread_t platform_thread;
+typedef void *(*platform_thread_proc)(void *);
+#define THREAD_PROC(name) void *name(void *param)
+#endif
+
+#ifdef PLT_WIN
+#define thread_local_var __declspec(thread)
+#elif PLT_LINUX
+#define thread_local_var __thread
+#endif
+
+internal platform_thread
+platform_thread_create(platform_thread_proc proc, void *param) {
+    platform_thread result;
+#ifdef PLT_WIN
+    result = CreateThread(NULL, 0, proc, param, 0, NULL);
+    assert(result != NULL, "could not create thread.");
+#elif PLT_LINUX
+    i32 error = pthread_create(&result, NULL, proc, param);
+    assert(error == 0, "could not create thread (%d).", error);
+#endif
+
+    return result;
+}
+
+internal void
+platform_thread_join(platform_thread thread) {
+#ifdef PLT_WIN
+    WaitForSingleObject(thread, INFINITE);
+    CloseHandle(thread);
+#elif PLT_LINUX
+    pthread_join(thread, NULL);
+#endif
+}
+
+/* NOTE(abid): Per thread value with a callback, `proc(value)` runs when a thread that set a
+ * non-NULL value exits. The main thread ends the process instead, it never gets the call. */
+#ifdef PLT_WIN
+typedef DWORD platform_thread_exit_key;
+#elif PLT_LINUX
+typedef pthread_key_t platform_thread_exit_key;
+#endif
+typedef void platform_thread_exit_proc(void *value);
+
+inline internal platform_thread_exit_key
+platform_thread_exit_key_create(platform_thread_exit_proc *proc) {
+    platform_thread_exit_key result;
+#ifdef PLT_WIN
+    result = FlsAlloc((PFLS_CALLBACK_FUNCTION)proc);
+    assert(result != FLS_OUT_OF_INDEXES, "could not create a thread exit key.");
+#elif PLT_LINUX
+    i32 error = pthread_key_create(&result, proc);
+    assert(error == 0, "could not create a thread exit key (%d).", error);
+#endif
+
+    return result;
+}
+
+inline internal void
+platform_thread_exit_set(platform_thread_exit_key key, void *value) {
+#ifdef PLT_WIN
+    FlsSetValue(key, value);
+#elif PLT_LINUX
+    pthread_setspecific(key, value);
+#endif
+}
+
+/* NOTE(abid): Keeps the calling thread on one logical core, false if the core does not exist. */
+internal bool
+platform_thread_pin_to_core(u32 core) {
+#ifdef PLT_WIN
+    if(core >= 64) return false;
+    return SetThreadAffinityMask(GetCurrentThread(), (DWORD_PTR)1 << core) != 0;
+#elif PLT_LINUX
+    if(core >= CPU_SETSIZE) return false;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(core, &set);
+    return sched_setaffinity(0, sizeof(set), &set) == 0;
+#endif
+}
+
+inline internal void
+platform_thread_yield() {
+#ifdef PLT_WIN
+    SwitchToThread();
+#elif PLT_LINUX
+    sched_yield();
+#endif
+}
+
+internal u32
+platform_cpu_count() {
+#ifdef PLT_WIN
+    SYSTEM_INFO sys_info = {0};
+    GetSystemInfo(&sys_info);
+    return sys_info.dwNumberOfProcessors;
+#elif PLT_LINUX
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+    return (count > 0) ? (u32)count : 1;
+#endif
+}
+
+/* NOTE(abid): Host name, "unknown" if the OS does not say. */
+internal void
+platform_machine_name(char *name, u32 size) {
+#ifdef PLT_WIN
+    DWORD length = size;
+    if(!GetComputerNameA(name, &length)) snprintf(name, size, "unknown");
+#elif PLT_LINUX
+    if(gethostname(name, size) != 0) snprintf(name, size, "unknown");
+    name[size - 1] = 0;
+#endif
+}
+
+/* NOTE(abid): Returns the value before the add. */
+inline internal u64
+platform_atomic_add_u64(volatile u64 *value, u64 addend) {
+#ifdef PLT_WIN
+    return (u64)InterlockedExchangeAdd64((volatile LONG64 *)value, (LONG64)addend);
+#elif PLT_LINUX
+    return __atomic_fetch_add(value, addend, __ATOMIC_SEQ_CST);
+#endif
+}
+
+inline internal u64
+platform_atomic_load_u64(volatile u64 *value) {
+#ifdef PLT_WIN
+    return *value; /* NOTE(abid): MSVC volatile reads have acquire semantics. */
+#elif PLT_LINUX
+    return __atomic_load_n(value, __ATOMIC_ACQUIRE);
+#endif
+}
+
+/* NOTE(abid): Stores `desired` if `*value` still is `expected`, true if it did. */
+inline internal bool
+platform_atomic_compare_exchange_u64(volatile u64 *value, u64 expected, u64 desired) {
+#ifdef PLT_WIN
+    return (u64)InterlockedCompareExchange64((volatile LONG64 *)value, (LONG64)desired, (LONG64)expected) == expected;
+#elif PLT_LINUX
+    return __atomic_compare_exchange_n(value, &expected, desired, false, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+#endif
+}
+
+/* NOTE(abid): 64x64 -> 128 bit multiply. */
+inline internal u128
+u128_mul_u64(u64 a, u64 b) {
+    u128 result;
+#ifdef PLT_WIN
+    result.lo = _umul128(a, b, &result.hi);
+#elif PLT_LINUX
+    unsigned __int128 product = (unsigned __int128)a*b;
+    result.lo = (u64)product;
+    result.hi = (u64)(product >> 64);
+#endif
+
+    return result;
+}
+
+inline internal u128
+u128_add_u64(u128 a, u64 b) {
+    u128 result = { .lo = a.lo + b, .hi = a.hi };
+    result.hi += (result.lo < b);
+
+    return result;
+}
+
+/* NOTE(abid): Index of the lowest set bit, `value` must not be zero. */
+inline internal u32
+u64_trailing_zeros(u64 value) {
+#ifdef PLT_WIN
+    unsigned long result;
+    _BitScanForward64(&result, value);
+    return (u32)result;
+#elif PLT_LINUX
+    return (u32)__builtin_ctzll(value);
+#endif
+}
+
+/* NOTE(abid): Zero bits above the highest set bit, `value` must not be zero. */
+inline internal u32
+u64_leading_zeros(u64 value) {
+#ifdef PLT_WIN
+    unsigned long result;
+    _BitScanReverse64(&result, value);
+    return 63 - (u32)result;
+#elif PLT_LINUX
+    return (u32)__builtin_clzll(value);
+#endif
+}
+
+inline internal u32
+u64_popcount(u64 value) {
+#ifdef PLT_WIN
+    return (u32)__popcnt64(value);
+#elif PLT_LINUX
+    return (u32)__builtin_popcountll(value);
+#endif
+}
+
 inline internal temp_memory
 mem_temp_begin(mem_arena *arena) {
     temp_memory result = {0};
@@ -227,9 +752,10 @@ arena_create(usize bytes_to_allocate, usize bytes_to_reserve) {
     return arena;
 }
 
+/* NOTE(abid): Releases the whole reservation, not only the committed part. */
 inline internal bool
 arena_free(mem_arena *arena) { 
-    return platform_free(arena->ptr, arena->size) && platform_free(arena, sizeof(arena));
+    return platform_free(arena->ptr, arena->max_size) && platform_free(arena, sizeof(mem_arena));
 }
 
 #define push_struct(type, arena) (type *)push_size(sizeof(type), arena)
@@ -252,5 +778,17 @@ push_size(usize size, mem_arena *arena) {
     return result;
 }
 
+/* NOTE(abid): Same as `push_size` but the returned pointer sits on `alignment` (power of two). */
+#define push_array_aligned(type, count, alignment, arena) \
+    (type *)push_size_aligned((count)*sizeof(type), alignment, arena)
+internal void *
+push_size_aligned(usize size, usize alignment, mem_arena *arena) {
+    usize alignment_mask = alignment - 1;
+    usize misalignment = (usize)((u8 *)arena->ptr + arena->used) & alignment_mask;
+    if(misalignment) push_size(alignment - misalignment, arena);
+
+    return push_size(size, arena);
+}
+
 #define arena_current(Arena) (void *)((u8 *)(Arena)->ptr + (Arena)->used)
 #define arena_advance(Arena, Number, Type) (Arena)->used += sizeof(Type)*(Number)